@@ -0,0 +1,273 @@
+#include "animation.h"
+#include <algorithm>
+
+plg::TrackID plg::AnimationClip::AddTrack(SceneNodeID node, TransformChannel channel) {
+	Track track;
+	track.node = node;
+	track.channel = channel;
+	track.keyOffset = (uint32_t)m_KeyTimes.size();
+	track.keyCount = 0;
+	track.cursor = 0;
+	track.revision = 0;
+	m_Tracks.push_back(track);
+	m_Revision++;
+	return (TrackID)(m_Tracks.size() - 1);
+}
+
+void plg::AnimationClip::RemoveTrack(TrackID track) {
+	Track& removed = m_Tracks[track];
+	size_t begin = removed.keyOffset;
+	size_t end = begin + removed.keyCount;
+	m_KeyTimes.erase(m_KeyTimes.begin() + begin, m_KeyTimes.begin() + end);
+	m_KeyValues.erase(m_KeyValues.begin() + begin, m_KeyValues.begin() + end);
+	m_KeyModes.erase(m_KeyModes.begin() + begin, m_KeyModes.begin() + end);
+	m_KeyCurves.erase(m_KeyCurves.begin() + begin, m_KeyCurves.begin() + end);
+	ShiftKeyOffsets(track + 1, -(int32_t)removed.keyCount);
+	removed.keyCount = 0;
+	removed.cursor = 0;
+	removed.node = SceneGraph::NULL_NODE;
+	Touch(track);
+}
+
+size_t plg::AnimationClip::SetKey(TrackID track, float time, float value, Interpolation mode) {
+	Track& target = m_Tracks[track];
+	auto begin = m_KeyTimes.begin() + target.keyOffset;
+	auto end = begin + target.keyCount;
+	auto position = std::lower_bound(begin, end, time);
+	size_t key = (size_t)(position - begin);
+	size_t index = target.keyOffset + key;
+	if (position != end && *position == time) {
+		m_KeyValues[index] = value;
+		m_KeyModes[index] = mode;
+		Touch(track);
+		return key;
+	}
+	m_KeyTimes.insert(m_KeyTimes.begin() + index, time);
+	m_KeyValues.insert(m_KeyValues.begin() + index, value);
+	m_KeyModes.insert(m_KeyModes.begin() + index, mode);
+	m_KeyCurves.insert(m_KeyCurves.begin() + index, 0);
+	target.keyCount++;
+	target.cursor = 0;
+	ShiftKeyOffsets(track + 1, 1);
+	Touch(track);
+	return key;
+}
+
+void plg::AnimationClip::RemoveKey(TrackID track, size_t key) {
+	Track& target = m_Tracks[track];
+	if (key >= target.keyCount) {
+		Log("Warning! Key index is out of range!", true);
+		return;
+	}
+	size_t index = target.keyOffset + key;
+	m_KeyTimes.erase(m_KeyTimes.begin() + index);
+	m_KeyValues.erase(m_KeyValues.begin() + index);
+	m_KeyModes.erase(m_KeyModes.begin() + index);
+	m_KeyCurves.erase(m_KeyCurves.begin() + index);
+	target.keyCount--;
+	target.cursor = 0;
+	ShiftKeyOffsets(track + 1, -1);
+	Touch(track);
+}
+
+void plg::AnimationClip::MoveKey(TrackID track, size_t key, float time) {
+	Track& target = m_Tracks[track];
+	if (key >= target.keyCount) {
+		Log("Warning! Key index is out of range!", true);
+		return;
+	}
+	size_t index = target.keyOffset + key;
+	float value = m_KeyValues[index];
+	Interpolation mode = m_KeyModes[index];
+	uint16_t curve = m_KeyCurves[index];
+	RemoveKey(track, key);
+	size_t moved = SetKey(track, time, value, mode);
+	m_KeyCurves[m_Tracks[track].keyOffset + moved] = curve;
+}
+
+int32_t plg::AnimationClip::AddEasingCurve(const EasingCurve& curve) {
+	if (m_EasingCurves.size() >= UINT16_MAX) {
+		Log("Warning! Easing curve limit reached!", true);
+		return -1;
+	}
+	m_EasingCurves.push_back(curve);
+	return (int32_t)(m_EasingCurves.size() - 1);
+}
+
+void plg::AnimationClip::SetEasingCurve(int32_t curve, const EasingCurve& value) {
+	if (curve < 0 || (size_t)curve >= m_EasingCurves.size()) {
+		Log("Warning! Easing curve index is out of range!", true);
+		return;
+	}
+	m_EasingCurves[curve] = value;
+	for (size_t track = 0; track < m_Tracks.size(); track++) {
+		const Track& target = m_Tracks[track];
+		for (size_t index = target.keyOffset; index < target.keyOffset + target.keyCount; index++) {
+			if (m_KeyModes[index] == Interpolation::BEZIER && m_KeyCurves[index] == (uint16_t)curve) {
+				Touch((TrackID)track);
+				break;
+			}
+		}
+	}
+}
+
+void plg::AnimationClip::SetKeyEasing(TrackID track, size_t key, int32_t curve) {
+	Track& target = m_Tracks[track];
+	if (key >= target.keyCount || curve < 0 || (size_t)curve >= m_EasingCurves.size()) {
+		Log("Warning! Key or easing curve index is out of range!", true);
+		return;
+	}
+	size_t index = target.keyOffset + key;
+	m_KeyModes[index] = Interpolation::BEZIER;
+	m_KeyCurves[index] = (uint16_t)curve;
+	Touch(track);
+}
+
+float plg::AnimationClip::GetDuration() const {
+	float duration = 0.0f;
+	for (const Track& track : m_Tracks) {
+		if (track.keyCount > 0) {
+			duration = std::max(duration, m_KeyTimes[track.keyOffset + track.keyCount - 1]);
+		}
+	}
+	return duration;
+}
+
+size_t plg::AnimationClip::FindSegment(Track& track, float time) const {
+	const float* times = m_KeyTimes.data() + track.keyOffset;
+	size_t last = track.keyCount - 1;
+	size_t cursor = track.cursor;
+	// Playback usually stays in the same segment or steps into the next one.
+	if (times[cursor] <= time) {
+		if (cursor == last || time < times[cursor + 1]) {
+			return cursor;
+		}
+		if (cursor + 1 == last || time < times[cursor + 2]) {
+			track.cursor = (uint32_t)(cursor + 1);
+			return cursor + 1;
+		}
+	}
+	if (time < times[0]) {
+		track.cursor = 0;
+		return 0;
+	}
+	size_t segment = (size_t)(std::upper_bound(times, times + track.keyCount, time) - times) - 1;
+	track.cursor = (uint32_t)segment;
+	return segment;
+}
+
+bool plg::AnimationClip::Locate(Track& track, float time, size_t* index, float* t, float* value) {
+	if (track.keyCount == 0) {
+		*value = 0.0f;
+		return false;
+	}
+	const float* times = m_KeyTimes.data() + track.keyOffset;
+	size_t segment = FindSegment(track, time);
+	*index = track.keyOffset + segment;
+	if (segment == track.keyCount - 1 || time <= times[segment] || m_KeyModes[*index] == Interpolation::STEP) {
+		*value = m_KeyValues[*index];
+		return false;
+	}
+	*t = (time - times[segment]) / (times[segment + 1] - times[segment]);
+	return true;
+}
+
+bool plg::AnimationClip::IsEased(size_t index) const {
+	// A BEZIER key whose curve is missing eases linearly.
+	return m_KeyModes[index] == Interpolation::BEZIER && m_KeyCurves[index] < m_EasingCurves.size();
+}
+
+float plg::AnimationClip::Evaluate(TrackID track, float time) {
+	size_t index;
+	float t, value;
+	if (!Locate(m_Tracks[track], time, &index, &t, &value)) {
+		return value;
+	}
+	if (IsEased(index)) {
+		t = m_EasingCurves[m_KeyCurves[index]].Evaluate(t);
+	}
+	return m_KeyValues[index] + (m_KeyValues[index + 1] - m_KeyValues[index]) * t;
+}
+
+void plg::AnimationClip::Evaluate(float time, float* values) {
+	// Linear and step tracks are finished right away; eased segments are gathered and
+	// grouped by curve so every curve runs one batched evaluation.
+	m_EaseJobs.clear();
+	for (size_t track = 0; track < m_Tracks.size(); track++) {
+		size_t index;
+		float t;
+		if (!Locate(m_Tracks[track], time, &index, &t, &values[track])) {
+			continue;
+		}
+		if (IsEased(index)) {
+			m_EaseJobs.push_back({ m_KeyCurves[index], (uint32_t)track, (uint32_t)index, t });
+			continue;
+		}
+		values[track] = m_KeyValues[index] + (m_KeyValues[index + 1] - m_KeyValues[index]) * t;
+	}
+	if (m_EaseJobs.empty()) {
+		return;
+	}
+	std::sort(m_EaseJobs.begin(), m_EaseJobs.end(), [](const EaseJob& first, const EaseJob& second) { return first.curve < second.curve; });
+	m_EaseInputs.resize(m_EaseJobs.size());
+	m_EaseOutputs.resize(m_EaseJobs.size());
+	for (size_t job = 0; job < m_EaseJobs.size(); job++) {
+		m_EaseInputs[job] = m_EaseJobs[job].t;
+	}
+	for (size_t begin = 0, end = 0; begin < m_EaseJobs.size(); begin = end) {
+		while (end < m_EaseJobs.size() && m_EaseJobs[end].curve == m_EaseJobs[begin].curve) {
+			end++;
+		}
+		m_EasingCurves[m_EaseJobs[begin].curve].Evaluate(m_EaseInputs.data() + begin, m_EaseOutputs.data() + begin, end - begin);
+	}
+	for (size_t job = 0; job < m_EaseJobs.size(); job++) {
+		uint32_t index = m_EaseJobs[job].index;
+		values[m_EaseJobs[job].track] = m_KeyValues[index] + (m_KeyValues[index + 1] - m_KeyValues[index]) * m_EaseOutputs[job];
+	}
+}
+
+void plg::AnimationClip::Sample(float time, SceneGraph* graph) {
+	m_SampleBuffer.resize(m_Tracks.size());
+	Evaluate(time, m_SampleBuffer.data());
+	Apply(m_SampleBuffer.data(), graph);
+}
+
+void plg::AnimationClip::Apply(const float* values, SceneGraph* graph) {
+	for (size_t track = 0; track < m_Tracks.size(); track++) {
+		const Track& target = m_Tracks[track];
+		if (target.keyCount == 0 || !graph->IsValid(target.node)) {
+			continue;
+		}
+		Transform2D* local = graph->GetLocalTransformPtr(target.node);
+		float value = values[track];
+		switch (target.channel) {
+		case TransformChannel::POSITION_X:
+			local->position.x = value;
+			break;
+		case TransformChannel::POSITION_Y:
+			local->position.y = value;
+			break;
+		case TransformChannel::ROTATION:
+			local->rotation = value;
+			break;
+		case TransformChannel::SCALE_X:
+			local->scale.x = value;
+			break;
+		case TransformChannel::SCALE_Y:
+			local->scale.y = value;
+			break;
+		}
+		graph->MarkDirty(target.node);
+	}
+}
+
+void plg::AnimationClip::Touch(TrackID track) {
+	m_Tracks[track].revision++;
+	m_Revision++;
+}
+
+void plg::AnimationClip::ShiftKeyOffsets(TrackID firstTrack, int32_t amount) {
+	for (size_t track = (size_t)firstTrack; track < m_Tracks.size(); track++) {
+		m_Tracks[track].keyOffset = (uint32_t)((int32_t)m_Tracks[track].keyOffset + amount);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+#include "scene_graph.h"
+#include "easing.h"
+#include <vector>
+
+namespace plg {
+	using TrackID = int32_t;
+
+	enum class Interpolation : uint8_t {
+		STEP, LINEAR, BEZIER
+	};
+
+	enum class TransformChannel : uint8_t {
+		POSITION_X, POSITION_Y, ROTATION, SCALE_X, SCALE_Y
+	};
+
+	// Keyframe tracks of a clip. The keys of every track live in shared time, value and
+	// interpolation arrays, each track owning one sorted contiguous range. Every track
+	// remembers the segment it was last sampled in, so playing forward costs O(1) per
+	// track and seeking falls back to a binary search.
+	class AnimationClip {
+	public:
+		static constexpr TrackID NULL_TRACK = -1;
+
+		AnimationClip() { }
+
+		TrackID AddTrack(SceneNodeID node, TransformChannel channel);
+		void RemoveTrack(TrackID track);
+		size_t SetKey(TrackID track, float time, float value, Interpolation mode = Interpolation::LINEAR);
+		void RemoveKey(TrackID track, size_t key);
+		void MoveKey(TrackID track, size_t key, float time);
+		// Easing curves are shared by keys; a BEZIER key eases towards the next key along its curve.
+		int32_t AddEasingCurve(const EasingCurve& curve);
+		void SetEasingCurve(int32_t curve, const EasingCurve& value);
+		const EasingCurve& GetEasingCurve(int32_t curve) const { return m_EasingCurves[curve]; }
+		void SetKeyEasing(TrackID track, size_t key, int32_t curve);
+
+		size_t GetTrackCount() const { return m_Tracks.size(); }
+		size_t GetKeyCount(TrackID track) const { return m_Tracks[track].keyCount; }
+		float GetKeyTime(TrackID track, size_t key) const { return m_KeyTimes[m_Tracks[track].keyOffset + key]; }
+		float GetKeyValue(TrackID track, size_t key) const { return m_KeyValues[m_Tracks[track].keyOffset + key]; }
+		SceneNodeID GetTrackNode(TrackID track) const { return m_Tracks[track].node; }
+		TransformChannel GetTrackChannel(TrackID track) const { return m_Tracks[track].channel; }
+		float GetDuration() const;
+		// Revisions grow whenever keys change, letting caches detect stale samples per track.
+		uint32_t GetRevision() const { return m_Revision; }
+		uint32_t GetTrackRevision(TrackID track) const { return m_Tracks[track].revision; }
+
+		float Evaluate(TrackID track, float time);
+		void Evaluate(float time, float* values);
+		void Sample(float time, SceneGraph* graph);
+		void Apply(const float* values, SceneGraph* graph);
+
+	private:
+		struct Track {
+			SceneNodeID node;
+			TransformChannel channel;
+			uint32_t keyOffset;
+			uint32_t keyCount;
+			uint32_t cursor;
+			uint32_t revision;
+		};
+
+		struct EaseJob {
+			uint16_t curve;
+			uint32_t track;
+			uint32_t index;
+			float t;
+		};
+
+		size_t FindSegment(Track& track, float time) const;
+		// True with the first key of the segment and how far into it time is when the value
+		// lies between two keys, otherwise false with the value itself.
+		bool Locate(Track& track, float time, size_t* index, float* t, float* value);
+		bool IsEased(size_t index) const;
+		void Touch(TrackID track);
+		void ShiftKeyOffsets(TrackID firstTrack, int32_t amount);
+
+		std::vector<Track> m_Tracks;
+		std::vector<float> m_KeyTimes;
+		std::vector<float> m_KeyValues;
+		std::vector<Interpolation> m_KeyModes;
+		std::vector<uint16_t> m_KeyCurves;
+		std::vector<EasingCurve> m_EasingCurves;
+		std::vector<float> m_SampleBuffer;
+		std::vector<EaseJob> m_EaseJobs;
+		std::vector<float> m_EaseInputs;
+		std::vector<float> m_EaseOutputs;
+		uint32_t m_Revision = 0;
+	};
+}
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <chrono>
 
 #define DEBUG_LEVEL 1
+#define RUN_BENCHMARKS 0
 
 template<typename T>
 void Log(T message, bool endState = false) {
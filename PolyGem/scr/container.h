@@ -1,16 +1,207 @@
 #pragma once
 #include "benchmark.h"
+#include "thread_pool.h"
+#include <atomic>
 #include <bit>
+#include <cstddef>
+#include <cstdint>
 #include <cstring>
+#include <iterator>
+#include <new>
 
 namespace container {
 	static uint64_t universalOne = 1;
 
+	struct AllocationStats {
+		size_t allocations = 0;
+		size_t deallocations = 0;
+		size_t bytesAllocated = 0;
+	};
+
+	// Polymorphic source of raw memory for List and Node. Every resource keeps
+	// its own counters so callers can verify how many allocations a code path makes.
+	class MemoryResource {
+	public:
+		MemoryResource() { }
+		MemoryResource(const MemoryResource&) = delete;
+		MemoryResource& operator=(const MemoryResource&) = delete;
+		virtual ~MemoryResource() { }
+
+		virtual void* Allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) = 0;
+		virtual void Deallocate(void* ptr, size_t bytes, size_t alignment = alignof(std::max_align_t)) = 0;
+
+		template<typename T>
+		T* AllocateArray(size_t count) {
+			return (T*)Allocate(count * sizeof(T), alignof(T));
+		}
+
+		AllocationStats GetStats() const {
+			return { m_Allocations.load(std::memory_order_relaxed), m_Deallocations.load(std::memory_order_relaxed), m_BytesAllocated.load(std::memory_order_relaxed) };
+		}
+
+		void ResetStats() {
+			m_Allocations.store(0, std::memory_order_relaxed);
+			m_Deallocations.store(0, std::memory_order_relaxed);
+			m_BytesAllocated.store(0, std::memory_order_relaxed);
+		}
+
+	protected:
+		void CountAllocation(size_t bytes) {
+			m_Allocations.fetch_add(1, std::memory_order_relaxed);
+			m_BytesAllocated.fetch_add(bytes, std::memory_order_relaxed);
+		}
+
+		void CountDeallocation() {
+			m_Deallocations.fetch_add(1, std::memory_order_relaxed);
+		}
+
+	private:
+		std::atomic<size_t> m_Allocations = 0;
+		std::atomic<size_t> m_Deallocations = 0;
+		std::atomic<size_t> m_BytesAllocated = 0;
+	};
+
+	class HeapResource : public MemoryResource {
+	public:
+		void* Allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) override {
+			CountAllocation(bytes);
+			if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+				return ::operator new(bytes, std::align_val_t(alignment));
+			}
+			return ::operator new(bytes);
+		}
+
+		void Deallocate(void* ptr, size_t bytes, size_t alignment = alignof(std::max_align_t)) override {
+			if (ptr == nullptr) {
+				return;
+			}
+			CountDeallocation();
+			if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+				::operator delete(ptr, bytes, std::align_val_t(alignment));
+				return;
+			}
+			::operator delete(ptr, bytes);
+		}
+	};
+
+	// Bump allocator for short-lived data. Deallocate is a no-op, memory is
+	// reclaimed all at once by Reset(). When a frame overflows the current block the
+	// arena chains a new one and coalesces them on the next Reset(), so a steady
+	// workload settles into a single block and zero upstream allocations.
+	class LinearArena : public MemoryResource {
+	public:
+		LinearArena(size_t blockSize = 1 << 16, MemoryResource* upstream = nullptr)
+			: m_BlockSize(blockSize), m_Upstream(upstream) { }
+		~LinearArena() { Release(); }
+
+		void* Allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) override {
+			CountAllocation(bytes);
+			if (m_Head != nullptr) {
+				size_t offset = AlignedOffset(alignment);
+				if (offset + bytes <= m_Head->size) {
+					m_Offset = offset + bytes;
+					m_Used += bytes;
+					return m_Head->GetData() + offset;
+				}
+			}
+			size_t blockSize = (bytes + alignment > m_BlockSize) ? bytes + alignment : m_BlockSize;
+			PushBlock(blockSize);
+			size_t offset = AlignedOffset(alignment);
+			m_Offset = offset + bytes;
+			m_Used += bytes;
+			return m_Head->GetData() + offset;
+		}
+
+		void Deallocate(void* ptr, size_t /*bytes*/, size_t /*alignment*/ = alignof(std::max_align_t)) override {
+			if (ptr != nullptr) {
+				CountDeallocation();
+			}
+		}
+
+		void Reset() {
+			if (m_Head != nullptr && m_Head->next != nullptr) {
+				size_t totalSize = m_Capacity;
+				Release();
+				PushBlock(totalSize);
+			}
+			m_Offset = 0;
+			m_Used = 0;
+		}
+
+		void Release() {
+			while (m_Head != nullptr) {
+				Block* next = m_Head->next;
+				GetUpstream()->Deallocate(m_Head, sizeof(Block) + m_Head->size, alignof(std::max_align_t));
+				m_Head = next;
+			}
+			m_Capacity = 0;
+			m_Offset = 0;
+			m_Used = 0;
+		}
+
+		size_t GetUsed() const { return m_Used; }
+		size_t GetCapacity() const { return m_Capacity; }
+
+	private:
+		struct alignas(std::max_align_t) Block {
+			Block* next;
+			size_t size;
+
+			uint8_t* GetData() { return (uint8_t*)(this + 1); }
+		};
+
+		MemoryResource* GetUpstream();
+
+		// The next offset in the head block whose address is aligned; blocks are only
+		// aligned to max_align_t, so aligning the offset alone is not enough.
+		size_t AlignedOffset(size_t alignment) {
+			uintptr_t address = (uintptr_t)(m_Head->GetData() + m_Offset);
+			return m_Offset + (size_t)(((address + alignment - 1) & ~(uintptr_t)(alignment - 1)) - address);
+		}
+
+		void PushBlock(size_t size) {
+			Block* block = (Block*)GetUpstream()->Allocate(sizeof(Block) + size, alignof(std::max_align_t));
+			block->next = m_Head;
+			block->size = size;
+			m_Head = block;
+			m_Capacity += size;
+			m_Offset = 0;
+		}
+
+		Block* m_Head = nullptr;
+		size_t m_BlockSize;
+		size_t m_Offset = 0;
+		size_t m_Used = 0;
+		size_t m_Capacity = 0;
+		MemoryResource* m_Upstream;
+	};
+
+	// Default resource backing every List and Node, its counters equal the number of
+	// global operator new calls made by the containers.
+	inline HeapResource heapResource;
+	// Scratch memory for the render path, reset once at the start of every frame.
+	inline LinearArena frameArena(1 << 20);
+
+	inline MemoryResource* GetDefaultResource() { return &heapResource; }
+
+	// Types whose objects may be copied and relocated with memcpy. Defaults to the
+	// trivially copyable types, specialize it to opt in types that are not.
+	template<typename T>
+	struct IsBitwiseCopyable : std::bool_constant<std::is_trivially_copyable_v<T>> { };
+
+	template<typename T>
+	inline constexpr bool IsBitwiseCopyable_v = IsBitwiseCopyable<T>::value;
+
+	inline MemoryResource* LinearArena::GetUpstream() {
+		return (m_Upstream != nullptr) ? m_Upstream : GetDefaultResource();
+	}
+
 	template<typename T_obj, typename T_func>
 	class Node {
 	public:
 		T_obj data;
 		Node* link = NULL;
+		MemoryResource* resource = NULL;
 
 		~Node() {
 			Log(data);
@@ -20,13 +211,14 @@ namespace container {
 			Log("Node deleted!");
 		}
 
-		static void insertNode(Node** head, T_obj data) {
+		static void insertNode(Node** head, T_obj data, MemoryResource* memoryResource = GetDefaultResource()) {
 			if (head == NULL) {
 				Log("Error: Current Node is passed as NULL!");
 				return;
 			}
 			else {
-				Node* next = new Node;
+				Node* next = new(memoryResource->Allocate(sizeof(Node), alignof(Node))) Node;
+				next->resource = memoryResource;
 				next->data = data;
 				next->link = (*head);
 				(*head) = next;
@@ -44,7 +236,7 @@ namespace container {
 			}
 			else {
 				(*prev)->link = (*curr)->link;
-				delete (*curr);
+				releaseNode(*curr);
 			}
 		}
 
@@ -74,7 +266,16 @@ namespace container {
 				deleteNode(&prev, &ptr);
 				ptr = ptrNew;
 			}
-			delete prev;
+			releaseNode(prev);
+		}
+
+		static void releaseNode(Node* node) {
+			if (node == NULL) {
+				return;
+			}
+			MemoryResource* memoryResource = (node->resource != NULL) ? node->resource : GetDefaultResource();
+			node->~Node();
+			memoryResource->Deallocate(node, sizeof(Node), alignof(Node));
 		}
 	};
 
@@ -84,79 +285,69 @@ namespace container {
 		using ObjectType = typename List::ObjectType;
 		using PointerType = ObjectType*;
 		using ReferenceType = ObjectType&;
-		const PointerType end_ptr;
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = ObjectType;
+		using difference_type = std::ptrdiff_t;
+		using pointer = PointerType;
+		using reference = ReferenceType;
+		PointerType end_ptr = nullptr;
 
 	private:
-		PointerType obj_ptr;
-		PointerType begin_ptr;
-		uint64_t* m_EmptySlots;
-		size_t m_EmptySlotCapacity;
-		
-		bool CheckEmptySlotIndex(size_t index) {
-			size_t emptySlotBlock = index >> 6;
-			size_t emptySlotIndex = index & 0x3F;
-			return (m_EmptySlots[emptySlotBlock] & (universalOne << emptySlotIndex)) == 0;
-		}
+		PointerType obj_ptr = nullptr;
+		PointerType begin_ptr = nullptr;
+		const uint64_t* m_EmptySlots = nullptr;
+		size_t m_EmptySlotCapacity = 0;
 
-		uint64_t GetFilledSlotIndex(size_t index) {
+		// Moves obj_ptr to the first filled slot at or after index, or to end_ptr.
+		void SeekFilledSlot(size_t index) {
 			size_t emptySlotBlock = index >> 6;
-			size_t slotIndex = index & 0x3F;
-			uint64_t filledSlotIndex = std::countr_zero((m_EmptySlots[emptySlotBlock] >> slotIndex));
-			return filledSlotIndex;
+			if (emptySlotBlock < m_EmptySlotCapacity) {
+				uint64_t filledSlots = m_EmptySlots[emptySlotBlock] >> (index & 0x3F);
+				if (filledSlots != 0) {
+					obj_ptr = begin_ptr + index + std::countr_zero(filledSlots);
+					return;
+				}
+				while (++emptySlotBlock < m_EmptySlotCapacity) {
+					if (m_EmptySlots[emptySlotBlock] != 0) {
+						obj_ptr = begin_ptr + (emptySlotBlock << 6) + std::countr_zero(m_EmptySlots[emptySlotBlock]);
+						return;
+					}
+				}
+			}
+			obj_ptr = end_ptr;
 		}
 
 	public:
+		ListIterator() { }
 
-		ListIterator(PointerType ptr, const PointerType end, uint64_t* _emptySlots, size_t capacity) : obj_ptr(ptr), end_ptr(end), m_EmptySlots(_emptySlots), m_EmptySlotCapacity(capacity) {
-			begin_ptr = obj_ptr;
-			size_t emptySlotBlock = 0;
-			size_t slotIndex = 0;
-			uint64_t filledSlotIndex = std::countr_zero((m_EmptySlots[emptySlotBlock] >> slotIndex));
-
-			while (emptySlotBlock < m_EmptySlotCapacity && filledSlotIndex == 64) {
-				emptySlotBlock++;
-				filledSlotIndex = std::countr_zero(m_EmptySlots[emptySlotBlock]);
-			}
-			obj_ptr += (emptySlotBlock << 6) + filledSlotIndex;
+		ListIterator(PointerType ptr, const PointerType end, const uint64_t* _emptySlots, size_t capacity)
+			: end_ptr(end), obj_ptr(ptr), begin_ptr(ptr), m_EmptySlots(_emptySlots), m_EmptySlotCapacity(capacity) {
+			SeekFilledSlot(0);
 		}
 
-		ListIterator(const ListIterator& other) 
-			: obj_ptr(other.obj_ptr), begin_ptr(other.begin_ptr), end_ptr(other.end_ptr),
-			m_EmptySlots(other.m_EmptySlots), m_EmptySlotCapacity(other.m_EmptySlotCapacity) { }
-
-		ListIterator& operator=(const ListIterator& other) {
-			if (this != *other) {
-				obj_ptr = other.obj_ptr;
-				begin_ptr = other.begin_ptr;
-				end_ptr = other.end_ptr;
-				m_EmptySlots = other.m_EmptySlots;
-				m_EmptySlotCapacity = other.m_EmptySlotCapacity;
-			}
-			return *this;
+		static ListIterator MakeEnd(PointerType ptr, const PointerType end, const uint64_t* _emptySlots, size_t capacity) {
+			ListIterator iterator;
+			iterator.end_ptr = end;
+			iterator.obj_ptr = end;
+			iterator.begin_ptr = ptr;
+			iterator.m_EmptySlots = _emptySlots;
+			iterator.m_EmptySlotCapacity = capacity;
+			return iterator;
 		}
 
-		const PointerType GetBegin() {
+		ListIterator(const ListIterator& other) = default;
+		ListIterator& operator=(const ListIterator& other) = default;
+
+		const PointerType GetBegin() const {
 			return begin_ptr;
 		}
 
-		size_t GetIndex() {
+		size_t GetIndex() const {
 			return (size_t)(obj_ptr - begin_ptr);
 		}
 
 		ListIterator& operator++() {
-			obj_ptr++;
-			size_t index = (size_t)(obj_ptr - begin_ptr);
-			size_t emptySlotBlock = index >> 6;
-			size_t slotIndex = index & 0x3F;
-			uint64_t filledSlotIndex = std::countr_zero((m_EmptySlots[emptySlotBlock] >> slotIndex));
-
-			while (emptySlotBlock < m_EmptySlotCapacity && filledSlotIndex == 64) {
-				emptySlotBlock++;
-				obj_ptr = begin_ptr + (emptySlotBlock << 6);
-				filledSlotIndex = std::countr_zero(m_EmptySlots[emptySlotBlock]);
-			}
-			obj_ptr += filledSlotIndex;
-
+			SeekFilledSlot(GetIndex() + 1);
 			return *this;
 		}
 
@@ -166,33 +357,21 @@ namespace container {
 			return iterator;
 		}
 
-		ListIterator& operator+(int inc) {
+		ListIterator operator+(int inc) const {
 			ListIterator newIter = *this;
-			newIter.obj_ptr += inc;
-			size_t index = (size_t)(newIter.obj_ptr - newIter.begin_ptr);
-			size_t emptySlotBlock = index >> 6;
-			size_t slotIndex = index & 0x3F;
-			uint64_t filledSlotIndex = std::countr_zero((newIter.m_EmptySlots[emptySlotBlock] >> slotIndex));
-
-			while (emptySlotBlock < newIter.m_EmptySlotCapacity && filledSlotIndex == 64) {
-				emptySlotBlock++;
-				newIter.obj_ptr = newIter.begin_ptr + (emptySlotBlock << 6);
-				filledSlotIndex = std::countr_zero(newIter.m_EmptySlots[emptySlotBlock]);
-			}
-			newIter.obj_ptr += filledSlotIndex;
-
+			newIter.SeekFilledSlot(GetIndex() + inc);
 			return newIter;
 		}
 
-		ReferenceType operator[](const size_t index) {
+		ReferenceType operator[](const size_t index) const {
 			return *(obj_ptr + index);
 		}
 
-		PointerType operator->() {
+		PointerType operator->() const {
 			return obj_ptr;
 		}
 
-		ReferenceType operator*() {
+		ReferenceType operator*() const {
 			return *obj_ptr;
 		}
 
@@ -241,42 +420,95 @@ namespace container {
 		size_t m_Capacity;
 		size_t m_EmptySlotCapacity;
 		uint64_t* m_EmptySlots;
+		// Every bitmap word before this one is full, so slot searches start here.
+		size_t m_FirstOpenBlock = 0;
+		MemoryResource* m_Resource;
+
+		T_obj* AllocateObjects(size_t count) {
+			return m_Resource->AllocateArray<T_obj>(count);
+		}
+
+		void DeallocateObjects(T_obj* objects, size_t count) {
+			m_Resource->Deallocate(objects, count * sizeof(T_obj), alignof(T_obj));
+		}
+
+		uint64_t* AllocateEmptySlots(size_t count) {
+			return m_Resource->AllocateArray<uint64_t>(count);
+		}
+
+		void DeallocateEmptySlots(uint64_t* emptySlots, size_t count) {
+			m_Resource->Deallocate(emptySlots, count * sizeof(uint64_t), alignof(uint64_t));
+		}
 
 		void ReallocateMemory() {
 			size_t newCapacity = (size_t)((float)m_Capacity * 1.5f);
+			ReallocateMemory((newCapacity > m_Capacity) ? newCapacity : m_Capacity + 1);
+		}
+
+		void ReallocateMemory(size_t newCapacity) {
+			size_t occupiedEnd = GetOccupiedEnd();
 			if ((m_EmptySlotCapacity << 6) < newCapacity) {
 				size_t newEmptySlotCapacity = (newCapacity >> 6) + 1;
-				uint64_t* newEmptySlots = new uint64_t[newEmptySlotCapacity];
+				uint64_t* newEmptySlots = AllocateEmptySlots(newEmptySlotCapacity);
 				for (uint64_t slot = 0; slot < m_EmptySlotCapacity; slot++) {
 					newEmptySlots[slot] = m_EmptySlots[slot];
 				}
 				for (size_t slot = m_EmptySlotCapacity; slot < newEmptySlotCapacity; slot++) {
 					newEmptySlots[slot] = 0;
 				}
-				delete[] m_EmptySlots;
+				DeallocateEmptySlots(m_EmptySlots, m_EmptySlotCapacity);
 				m_EmptySlots = newEmptySlots;
 				m_EmptySlotCapacity = newEmptySlotCapacity;
 			}
-			T_obj* newObjects = (T_obj*)::operator new(newCapacity * sizeof(T_obj));
-			for (size_t index = 0; index < m_Capacity; index++) {
-				new(&newObjects[index]) T_obj(std::move(m_Objects[index]));
+			T_obj* newObjects = AllocateObjects(newCapacity);
+			if constexpr (IsBitwiseCopyable_v<T_obj>) {
+				std::memcpy((void*)newObjects, (const void*)m_Objects, occupiedEnd * sizeof(T_obj));
 			}
-			for (size_t index = 0; index < m_Capacity; index++) {
-				m_Objects[index].~T_obj();
+			else {
+				for (size_t index = 0; index < occupiedEnd; index++) {
+					if (!CheckEmptySlotIndex(index)) {
+						new(&newObjects[index]) T_obj(std::move(m_Objects[index]));
+						m_Objects[index].~T_obj();
+					}
+				}
 			}
-			::operator delete(m_Objects, m_Capacity * sizeof(T_obj));
+			DeallocateObjects(m_Objects, m_Capacity);
 			m_Objects = newObjects;
 			m_Capacity = newCapacity;
 		}
 
+		void SetFilledSlotRange(size_t first, size_t count) {
+			size_t index = first;
+			size_t last = first + count;
+			while (index < last) {
+				size_t emptySlotBlock = index >> 6;
+				size_t slotIndex = index & 0x3F;
+				size_t slotCount = ((64 - slotIndex) < (last - index)) ? (64 - slotIndex) : (last - index);
+				uint64_t mask = (slotCount == 64) ? ~(uint64_t)0 : (((universalOne << slotCount) - 1) << slotIndex);
+				m_EmptySlots[emptySlotBlock] |= mask;
+				index += slotCount;
+			}
+		}
+
+		void ReleaseMemory() {
+			Clear();
+			DeallocateObjects(m_Objects, m_Capacity);
+			DeallocateEmptySlots(m_EmptySlots, m_EmptySlotCapacity);
+			m_Objects = nullptr;
+			m_EmptySlots = nullptr;
+			m_Capacity = 0;
+			m_EmptySlotCapacity = 0;
+		}
+
 		size_t GetEmptySlotIndex() {
-			size_t emptySlotBlock = 0;
+			size_t emptySlotBlock = m_FirstOpenBlock;
 			uint64_t emptySlotIndex = std::countr_zero(~(m_EmptySlots[emptySlotBlock]));
 			while (emptySlotBlock < m_EmptySlotCapacity && emptySlotIndex == 64) {
 				emptySlotBlock++;
 				emptySlotIndex = std::countr_zero(~(m_EmptySlots[emptySlotBlock]));
 			}
 			m_EmptySlots[emptySlotBlock] ^= universalOne << emptySlotIndex;
+			m_FirstOpenBlock = emptySlotBlock;
 			return (emptySlotBlock << 6) + emptySlotIndex;
 		}
 
@@ -290,25 +522,54 @@ namespace container {
 			size_t emptySlotBlock = index >> 6;
 			size_t emptySlotIndex = index & 0x3F;
 			m_EmptySlots[emptySlotBlock] ^= universalOne << emptySlotIndex;
+			if (emptySlotBlock < m_FirstOpenBlock) {
+				m_FirstOpenBlock = emptySlotBlock;
+			}
+		}
+
+		// One past the highest occupied slot, bitwise copies stop here.
+		size_t GetOccupiedEnd() const {
+			size_t emptySlotBlock = m_EmptySlotCapacity;
+			while (emptySlotBlock > 0) {
+				emptySlotBlock--;
+				if (m_EmptySlots[emptySlotBlock] != 0) {
+					size_t occupiedEnd = (emptySlotBlock << 6) + 64 - std::countl_zero(m_EmptySlots[emptySlotBlock]);
+					return (occupiedEnd < m_Capacity) ? occupiedEnd : m_Capacity;
+				}
+			}
+			return 0;
+		}
+
+		void CopyObjects(const List& other) {
+			if constexpr (IsBitwiseCopyable_v<T_obj>) {
+				std::memcpy((void*)m_Objects, (const void*)other.m_Objects, other.GetOccupiedEnd() * sizeof(T_obj));
+			}
+			else {
+				for (size_t index = 0; index < other.m_Capacity; index++) {
+					if (!other.CheckEmptySlotIndex(index)) {
+						new(&m_Objects[index]) T_obj(other.m_Objects[index]);
+					}
+				}
+			}
 		}
 
 	public:
 
-		List(size_t MS = 2) {
+		List(size_t MS = 2, MemoryResource* resource = GetDefaultResource()) : m_Resource(resource) {
 			m_Capacity = MS;
-			m_Objects = (T_obj*)::operator new(m_Capacity * sizeof(T_obj));
+			m_Objects = AllocateObjects(m_Capacity);
 			m_EmptySlotCapacity = 1 + (m_Capacity >> 6);
-			m_EmptySlots = new uint64_t[m_EmptySlotCapacity];
+			m_EmptySlots = AllocateEmptySlots(m_EmptySlotCapacity);
 			for (size_t i = 0; i < m_EmptySlotCapacity; i++) {
 				m_EmptySlots[i] = 0;
 			}
 		}
 
-		List(std::initializer_list<T_obj> objs) {
+		List(std::initializer_list<T_obj> objs, MemoryResource* resource = GetDefaultResource()) : m_Resource(resource) {
 			m_Capacity = (objs.size() > 2) ? objs.size() : 2;
-			m_Objects = (T_obj*)::operator new(m_Capacity * sizeof(T_obj));
+			m_Objects = AllocateObjects(m_Capacity);
 			m_EmptySlotCapacity = 1 + (m_Capacity >> 6);
-			m_EmptySlots = new uint64_t[m_EmptySlotCapacity];
+			m_EmptySlots = AllocateEmptySlots(m_EmptySlotCapacity);
 			for (size_t i = 0; i < m_EmptySlotCapacity; i++) {
 				m_EmptySlots[i] = 0;
 			}
@@ -317,53 +578,65 @@ namespace container {
 			}
 		}
 
-		List(const List& other) : m_Capacity(other.m_Capacity), m_EmptySlotCapacity(other.m_EmptySlotCapacity), m_ObjectCount(other.m_ObjectCount) {
-			m_EmptySlots = new uint64_t[m_EmptySlotCapacity];
+		List(const List& other, MemoryResource* resource = GetDefaultResource())
+			: m_Capacity(other.m_Capacity), m_EmptySlotCapacity(other.m_EmptySlotCapacity), m_ObjectCount(other.m_ObjectCount), m_FirstOpenBlock(other.m_FirstOpenBlock), m_Resource(resource) {
+			m_EmptySlots = AllocateEmptySlots(m_EmptySlotCapacity);
 			std::memcpy(m_EmptySlots, other.m_EmptySlots, m_EmptySlotCapacity * sizeof(uint64_t));
-			m_Objects = (T_obj*)::operator new(m_Capacity * sizeof(T_obj));
-			for (size_t index = 0; index < m_Capacity; index++) {
-				if (!other.CheckEmptySlotIndex(index)) {
-					new(&m_Objects[index]) T_obj(other.m_Objects[index]);
-				}
-			}
+			m_Objects = AllocateObjects(m_Capacity);
+			CopyObjects(other);
 			Log("List Copied!\n");
 		}
 
 		List& operator=(const List& other) {
 			if (this != &other) {
-				m_Capacity = other.m_Capacity;
-				m_EmptySlotCapacity = other.m_EmptySlotCapacity;
-				m_ObjectCount = other.m_ObjectCount;
-				m_EmptySlots = new uint64_t[m_EmptySlotCapacity];
-				std::memcpy(m_EmptySlots, other.m_EmptySlots, m_EmptySlotCapacity * sizeof(uint64_t));
-				m_Objects = (T_obj*)::operator new(m_Capacity * sizeof(T_obj));
-				for (size_t index = 0; index < m_Capacity; index++) {
-					if (!other.CheckEmptySlotIndex(index)) {
-						new(&m_Objects[index]) T_obj(other.m_Objects[index]);
-					}
+				Clear();
+				if (m_Capacity < other.m_Capacity) {
+					DeallocateObjects(m_Objects, m_Capacity);
+					m_Capacity = other.m_Capacity;
+					m_Objects = AllocateObjects(m_Capacity);
+				}
+				if (m_EmptySlotCapacity < other.m_EmptySlotCapacity) {
+					DeallocateEmptySlots(m_EmptySlots, m_EmptySlotCapacity);
+					m_EmptySlotCapacity = other.m_EmptySlotCapacity;
+					m_EmptySlots = AllocateEmptySlots(m_EmptySlotCapacity);
 				}
+				std::memcpy(m_EmptySlots, other.m_EmptySlots, other.m_EmptySlotCapacity * sizeof(uint64_t));
+				for (size_t i = other.m_EmptySlotCapacity; i < m_EmptySlotCapacity; i++) {
+					m_EmptySlots[i] = 0;
+				}
+				CopyObjects(other);
+				m_ObjectCount = other.m_ObjectCount;
+				m_FirstOpenBlock = other.m_FirstOpenBlock;
 			}
 			Log("List Copied!\n");
 			return *this;
 		}
 
-		List(List&& other) noexcept : m_Capacity(other.m_Capacity), m_EmptySlotCapacity(other.m_EmptySlotCapacity), m_ObjectCount(other.m_ObjectCount) {
+		List(List&& other) noexcept
+			: m_Capacity(other.m_Capacity), m_EmptySlotCapacity(other.m_EmptySlotCapacity), m_ObjectCount(other.m_ObjectCount), m_FirstOpenBlock(other.m_FirstOpenBlock), m_Resource(other.m_Resource) {
 			m_Objects = other.m_Objects;
 			other.m_Objects = nullptr;
 			m_EmptySlots = other.m_EmptySlots;
 			other.m_EmptySlots = nullptr;
 			other.m_Capacity = 0;
 			other.m_EmptySlotCapacity = 0;
+			other.m_ObjectCount = 0;
+			other.m_FirstOpenBlock = 0;
 			Log("List Moved!\n");
 		}
 
 		List& operator=(List&& other) noexcept {
 			if (this != &other) {
+				ReleaseMemory();
+				m_Resource = other.m_Resource;
 				m_Capacity = other.m_Capacity;
 				other.m_Capacity = 0;
 				m_EmptySlotCapacity = other.m_EmptySlotCapacity;
 				other.m_EmptySlotCapacity = 0;
 				m_ObjectCount = other.m_ObjectCount;
+				other.m_ObjectCount = 0;
+				m_FirstOpenBlock = other.m_FirstOpenBlock;
+				other.m_FirstOpenBlock = 0;
 				m_Objects = other.m_Objects;
 				other.m_Objects = nullptr;
 				m_EmptySlots = other.m_EmptySlots;
@@ -374,12 +647,12 @@ namespace container {
 		}
 
 		~List() {
-			Clear();
-			::operator delete(m_Objects, m_Capacity * sizeof(T_obj));
-			delete[] m_EmptySlots;
+			ReleaseMemory();
 			//Log("List destroyed!");
 		}
 
+		MemoryResource* GetResource() const { return m_Resource; }
+
 		T_obj& operator[](const size_t index) {
 			if (index < m_Capacity && !CheckEmptySlotIndex(index)) {
 				return m_Objects[index];
@@ -389,8 +662,39 @@ namespace container {
 			throw std::exception();
 		}
 
+		// Grows the list so it holds at least capacity objects without reallocating.
+		void Reserve(size_t capacity) {
+			if (capacity > m_Capacity) {
+				ReallocateMemory(capacity);
+			}
+		}
+
+		// Copies count objects into consecutive slots after the last occupied one and
+		// returns the first slot. Holes left by Remove are not reused, so the new objects
+		// always occupy [first, first + count).
+		size_t AppendRange(const T_obj* objects, size_t count) {
+			size_t first = GetOccupiedEnd();
+			if (count == 0) {
+				return first;
+			}
+			if (first + count > m_Capacity) {
+				ReallocateMemory(first + count);
+			}
+			if constexpr (IsBitwiseCopyable_v<T_obj>) {
+				std::memcpy((void*)(m_Objects + first), (const void*)objects, count * sizeof(T_obj));
+			}
+			else {
+				for (size_t index = 0; index < count; index++) {
+					new(&m_Objects[first + index]) T_obj(objects[index]);
+				}
+			}
+			SetFilledSlotRange(first, count);
+			m_ObjectCount += count;
+			return first;
+		}
+
 		size_t Append(T_obj& object) {
-			if (m_ObjectCount == m_Capacity && m_ObjectCount != 0) {
+			if (m_ObjectCount == m_Capacity) {
 				ReallocateMemory();
 			}
 			size_t trueEmptySlotIndex = GetEmptySlotIndex();
@@ -400,7 +704,7 @@ namespace container {
 		}
 
 		size_t Append(T_obj&& object) {
-			if (m_ObjectCount == m_Capacity && m_ObjectCount != 0) {
+			if (m_ObjectCount == m_Capacity) {
 				ReallocateMemory();
 			}
 			size_t trueEmptySlotIndex = GetEmptySlotIndex();
@@ -411,7 +715,7 @@ namespace container {
 
 		template<typename...Args>
 		size_t EmplaceBack(Args&&... args) {
-			if (m_ObjectCount == m_Capacity && m_ObjectCount != 0) {
+			if (m_ObjectCount == m_Capacity) {
 				ReallocateMemory();
 			}
 			size_t trueEmptySlotIndex = GetEmptySlotIndex();
@@ -468,14 +772,16 @@ namespace container {
 		}
 
 		void Clear() {
-			for (size_t index = 0; index < m_Capacity; index++) {
-				if (!CheckEmptySlotIndex(index)) {
-					if constexpr (std::is_pointer_v<T_obj>) {
-						delete m_Objects[index];
-						m_Objects[index] = nullptr;
-					}
-					else {
-						m_Objects[index].~T_obj();
+			if constexpr (std::is_pointer_v<T_obj> || !std::is_trivially_destructible_v<T_obj>) {
+				for (size_t index = 0; index < m_Capacity; index++) {
+					if (!CheckEmptySlotIndex(index)) {
+						if constexpr (std::is_pointer_v<T_obj>) {
+							delete m_Objects[index];
+							m_Objects[index] = nullptr;
+						}
+						else {
+							m_Objects[index].~T_obj();
+						}
 					}
 				}
 			}
@@ -483,6 +789,7 @@ namespace container {
 				m_EmptySlots[i] = 0;
 			}
 			m_ObjectCount = 0;
+			m_FirstOpenBlock = 0;
 		}
 
 		const size_t GetSize() {
@@ -493,6 +800,11 @@ namespace container {
 			return m_Capacity;
 		}
 
+		// Slot storage, GetCapacity() objects long. Empty slots hold unspecified values.
+		T_obj* GetData() {
+			return m_Objects;
+		}
+
 		Iterator Begin() {
 			return Iterator(m_Objects, End(), m_EmptySlots, m_EmptySlotCapacity);
 		}
@@ -500,5 +812,272 @@ namespace container {
 		Iterator::PointerType End() {
 			return (m_Objects + m_Capacity);
 		}
+
+		Iterator begin() { return Begin(); }
+		Iterator end() { return Iterator::MakeEnd(m_Objects, End(), m_EmptySlots, m_EmptySlotCapacity); }
+
+		// Calls func(object, index) for every filled slot, walking the bitmap a word at a time.
+		template<typename T_func>
+		void ForEach(T_func&& func) {
+			ForEachInBlocks(0, m_EmptySlotCapacity, func);
+		}
+
+		// Same as ForEach but splits the bitmap into runs of blockGrain 64-slot words and
+		// spreads them over the shared thread pool. func must be safe to call concurrently
+		// for different slots, and the list must not be resized while it runs.
+		template<typename T_func>
+		void ParallelForEach(T_func&& func, size_t blockGrain = 4) {
+			GetThreadPool().ParallelFor(m_EmptySlotCapacity, blockGrain, [this, &func](size_t blockBegin, size_t blockEnd) {
+				ForEachInBlocks(blockBegin, blockEnd, func);
+			});
+		}
+
+		template<typename T_func>
+		void ForEachInBlocks(size_t blockBegin, size_t blockEnd, T_func& func) {
+			for (size_t emptySlotBlock = blockBegin; emptySlotBlock < blockEnd; emptySlotBlock++) {
+				uint64_t filledSlots = m_EmptySlots[emptySlotBlock];
+				while (filledSlots != 0) {
+					size_t index = (emptySlotBlock << 6) + std::countr_zero(filledSlots);
+					func(m_Objects[index], index);
+					filledSlots &= filledSlots - 1;
+				}
+			}
+		}
+	};
+	// Sparse set counterpart of List. Live objects are packed in a dense array so
+	// iteration is a plain contiguous loop, while the slot returned by Append stays
+	// valid until its object is removed. Removal moves the last object into the hole,
+	// so dense order is not stable, only slots are.
+	template<typename T_obj>
+	class DenseList {
+	public:
+		using ObjectType = T_obj;
+		using Iterator = T_obj*;
+		static constexpr int32_t NULL_SLOT = -1;
+
+	private:
+		T_obj* m_Objects;
+		int32_t* m_DenseToSlot;
+		int32_t* m_SlotToDense;
+		int32_t* m_FreeSlots;
+		size_t m_ObjectCount = 0;
+		size_t m_SlotCount = 0;
+		size_t m_FreeSlotCount = 0;
+		size_t m_Capacity;
+		MemoryResource* m_Resource;
+
+		void AllocateMemory(size_t capacity) {
+			m_Capacity = capacity;
+			m_Objects = m_Resource->AllocateArray<T_obj>(m_Capacity);
+			m_DenseToSlot = m_Resource->AllocateArray<int32_t>(m_Capacity);
+			m_SlotToDense = m_Resource->AllocateArray<int32_t>(m_Capacity);
+			m_FreeSlots = m_Resource->AllocateArray<int32_t>(m_Capacity);
+		}
+
+		void ReleaseMemory() {
+			Clear();
+			m_Resource->Deallocate(m_Objects, m_Capacity * sizeof(T_obj), alignof(T_obj));
+			m_Resource->Deallocate(m_DenseToSlot, m_Capacity * sizeof(int32_t), alignof(int32_t));
+			m_Resource->Deallocate(m_SlotToDense, m_Capacity * sizeof(int32_t), alignof(int32_t));
+			m_Resource->Deallocate(m_FreeSlots, m_Capacity * sizeof(int32_t), alignof(int32_t));
+			m_Objects = nullptr;
+			m_DenseToSlot = nullptr;
+			m_SlotToDense = nullptr;
+			m_FreeSlots = nullptr;
+			m_Capacity = 0;
+		}
+
+		void ReallocateMemory(size_t newCapacity) {
+			T_obj* objects = m_Objects;
+			int32_t* denseToSlot = m_DenseToSlot;
+			int32_t* slotToDense = m_SlotToDense;
+			int32_t* freeSlots = m_FreeSlots;
+			size_t capacity = m_Capacity;
+			AllocateMemory(newCapacity);
+			if constexpr (IsBitwiseCopyable_v<T_obj>) {
+				std::memcpy((void*)m_Objects, (const void*)objects, m_ObjectCount * sizeof(T_obj));
+			}
+			else {
+				for (size_t index = 0; index < m_ObjectCount; index++) {
+					new(&m_Objects[index]) T_obj(std::move(objects[index]));
+					objects[index].~T_obj();
+				}
+			}
+			std::memcpy(m_DenseToSlot, denseToSlot, m_ObjectCount * sizeof(int32_t));
+			std::memcpy(m_SlotToDense, slotToDense, m_SlotCount * sizeof(int32_t));
+			std::memcpy(m_FreeSlots, freeSlots, m_FreeSlotCount * sizeof(int32_t));
+			m_Resource->Deallocate(objects, capacity * sizeof(T_obj), alignof(T_obj));
+			m_Resource->Deallocate(denseToSlot, capacity * sizeof(int32_t), alignof(int32_t));
+			m_Resource->Deallocate(slotToDense, capacity * sizeof(int32_t), alignof(int32_t));
+			m_Resource->Deallocate(freeSlots, capacity * sizeof(int32_t), alignof(int32_t));
+		}
+
+		int32_t AcquireSlot() {
+			if (m_ObjectCount == m_Capacity) {
+				size_t newCapacity = (size_t)((float)m_Capacity * 1.5f);
+				ReallocateMemory((newCapacity > m_Capacity) ? newCapacity : m_Capacity + 1);
+			}
+			int32_t slot = (m_FreeSlotCount > 0) ? m_FreeSlots[--m_FreeSlotCount] : (int32_t)m_SlotCount++;
+			m_SlotToDense[slot] = (int32_t)m_ObjectCount;
+			m_DenseToSlot[m_ObjectCount] = slot;
+			return slot;
+		}
+
+	public:
+		DenseList(size_t MS = 2, MemoryResource* resource = GetDefaultResource()) : m_Resource(resource) {
+			AllocateMemory((MS > 0) ? MS : 1);
+		}
+
+		DenseList(const DenseList& other, MemoryResource* resource = GetDefaultResource())
+			: m_ObjectCount(other.m_ObjectCount), m_SlotCount(other.m_SlotCount), m_FreeSlotCount(other.m_FreeSlotCount), m_Resource(resource) {
+			AllocateMemory(other.m_Capacity);
+			if constexpr (IsBitwiseCopyable_v<T_obj>) {
+				std::memcpy((void*)m_Objects, (const void*)other.m_Objects, m_ObjectCount * sizeof(T_obj));
+			}
+			else {
+				for (size_t index = 0; index < m_ObjectCount; index++) {
+					new(&m_Objects[index]) T_obj(other.m_Objects[index]);
+				}
+			}
+			std::memcpy(m_DenseToSlot, other.m_DenseToSlot, m_ObjectCount * sizeof(int32_t));
+			std::memcpy(m_SlotToDense, other.m_SlotToDense, m_SlotCount * sizeof(int32_t));
+			std::memcpy(m_FreeSlots, other.m_FreeSlots, m_FreeSlotCount * sizeof(int32_t));
+		}
+
+		DenseList& operator=(const DenseList& other) {
+			if (this != &other) {
+				DenseList copy(other, m_Resource);
+				*this = std::move(copy);
+			}
+			return *this;
+		}
+
+		DenseList(DenseList&& other) noexcept
+			: m_Objects(other.m_Objects), m_DenseToSlot(other.m_DenseToSlot), m_SlotToDense(other.m_SlotToDense), m_FreeSlots(other.m_FreeSlots),
+			m_ObjectCount(other.m_ObjectCount), m_SlotCount(other.m_SlotCount), m_FreeSlotCount(other.m_FreeSlotCount), m_Capacity(other.m_Capacity), m_Resource(other.m_Resource) {
+			other.m_Objects = nullptr;
+			other.m_DenseToSlot = nullptr;
+			other.m_SlotToDense = nullptr;
+			other.m_FreeSlots = nullptr;
+			other.m_ObjectCount = 0;
+			other.m_SlotCount = 0;
+			other.m_FreeSlotCount = 0;
+			other.m_Capacity = 0;
+		}
+
+		DenseList& operator=(DenseList&& other) noexcept {
+			if (this != &other) {
+				ReleaseMemory();
+				m_Objects = other.m_Objects;
+				m_DenseToSlot = other.m_DenseToSlot;
+				m_SlotToDense = other.m_SlotToDense;
+				m_FreeSlots = other.m_FreeSlots;
+				m_ObjectCount = other.m_ObjectCount;
+				m_SlotCount = other.m_SlotCount;
+				m_FreeSlotCount = other.m_FreeSlotCount;
+				m_Capacity = other.m_Capacity;
+				m_Resource = other.m_Resource;
+				other.m_Objects = nullptr;
+				other.m_DenseToSlot = nullptr;
+				other.m_SlotToDense = nullptr;
+				other.m_FreeSlots = nullptr;
+				other.m_ObjectCount = 0;
+				other.m_SlotCount = 0;
+				other.m_FreeSlotCount = 0;
+				other.m_Capacity = 0;
+			}
+			return *this;
+		}
+
+		~DenseList() {
+			ReleaseMemory();
+		}
+
+		T_obj& operator[](const int32_t slot) {
+			if (Contains(slot)) {
+				return m_Objects[m_SlotToDense[slot]];
+			}
+			Log("Error! Slot is out of range!", true);
+			Log(this);
+			throw std::exception();
+		}
+
+		int32_t Append(const T_obj& object) {
+			int32_t slot = AcquireSlot();
+			new(&m_Objects[m_ObjectCount]) T_obj(object);
+			m_ObjectCount += 1;
+			return slot;
+		}
+
+		int32_t Append(T_obj&& object) {
+			int32_t slot = AcquireSlot();
+			new(&m_Objects[m_ObjectCount]) T_obj(std::move(object));
+			m_ObjectCount += 1;
+			return slot;
+		}
+
+		template<typename...Args>
+		int32_t EmplaceBack(Args&&... args) {
+			int32_t slot = AcquireSlot();
+			new(&m_Objects[m_ObjectCount]) T_obj(std::forward<Args>(args)...);
+			m_ObjectCount += 1;
+			return slot;
+		}
+
+		void Remove(const int32_t slot) {
+			if (!Contains(slot)) {
+				Log("Warning! Slot outsite of the accessible memory! ID:", true);
+				Log(this);
+				return;
+			}
+			size_t denseIndex = (size_t)m_SlotToDense[slot];
+			size_t lastIndex = m_ObjectCount - 1;
+			if constexpr (std::is_pointer_v<T_obj>) {
+				delete m_Objects[denseIndex];
+			}
+			if (denseIndex != lastIndex) {
+				m_Objects[denseIndex] = std::move(m_Objects[lastIndex]);
+				m_DenseToSlot[denseIndex] = m_DenseToSlot[lastIndex];
+				m_SlotToDense[m_DenseToSlot[denseIndex]] = (int32_t)denseIndex;
+			}
+			m_Objects[lastIndex].~T_obj();
+			m_SlotToDense[slot] = NULL_SLOT;
+			m_FreeSlots[m_FreeSlotCount++] = slot;
+			m_ObjectCount -= 1;
+		}
+
+		bool Contains(const int32_t slot) const {
+			return slot >= 0 && (size_t)slot < m_SlotCount && m_SlotToDense[slot] != NULL_SLOT;
+		}
+
+		void Reserve(size_t capacity) {
+			if (capacity > m_Capacity) {
+				ReallocateMemory(capacity);
+			}
+		}
+
+		void Clear() {
+			if constexpr (std::is_pointer_v<T_obj> || !std::is_trivially_destructible_v<T_obj>) {
+				for (size_t index = 0; index < m_ObjectCount; index++) {
+					if constexpr (std::is_pointer_v<T_obj>) {
+						delete m_Objects[index];
+					}
+					else {
+						m_Objects[index].~T_obj();
+					}
+				}
+			}
+			m_ObjectCount = 0;
+			m_SlotCount = 0;
+			m_FreeSlotCount = 0;
+		}
+
+		int32_t GetSlot(size_t denseIndex) const { return m_DenseToSlot[denseIndex]; }
+		size_t GetDenseIndex(int32_t slot) const { return (size_t)m_SlotToDense[slot]; }
+		T_obj* GetData() { return m_Objects; }
+		size_t GetSize() const { return m_ObjectCount; }
+		size_t GetCapacity() const { return m_Capacity; }
+		Iterator Begin() { return m_Objects; }
+		Iterator End() { return m_Objects + m_ObjectCount; }
 	};
 }
\ No newline at end of file
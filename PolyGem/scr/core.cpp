@@ -1,6 +1,13 @@
 #include "core_scene.h"
 #include "core_functions.h"
+#include "triangulator.h"
+#include "mesh_lod.h"
+#include "material.h"
+#include <algorithm>
+#include <atomic>
+#include <numeric>
 #include <unordered_map>
+#include <unordered_set>
 
 #define float_max std::numeric_limits<float>::max()
 #define GRID_SIZE 64
@@ -22,22 +29,6 @@ static plg::Vec2 s_GetCircleCenter(plg::Vec2 left, plg::Vec2 middle, plg::Vec2 r
 	return segment_start_1;
 }
 
-static bool s_InsideCircumCircle(plg::Vec2 vert1, plg::Vec2 vert2, plg::Vec2 vert3, plg::Vec2 other) {
-	plg::Vec2 line_1 = (vert2 - vert1).RotateByVec(plg::Vec2(0.0f, 1.0f));
-	plg::Vec2 line_2 = (vert3 - vert2).RotateByVec(plg::Vec2(0.0f, 1.0f));
-	plg::Vec2 segment_start_1 = (vert1 + vert2) * 0.5;
-	plg::Vec2 segment_end_1 = segment_start_1 + line_1;
-	plg::Vec2 segment_start_2 = (vert2 + vert3) * 0.5;
-	plg::Vec2 segment_end_2 = segment_start_2 + line_2;
-
-	float t1 = ((segment_start_2.y - segment_end_2.y) * (segment_start_1.x - segment_start_2.x) +
-		(segment_end_2.x - segment_start_2.x) * (segment_start_1.y - segment_start_2.y)) /
-		((segment_end_2.x - segment_start_2.x) * (segment_start_1.y - segment_end_1.y) -
-			(segment_start_1.x - segment_end_1.x) * (segment_end_2.y - segment_start_2.y));
-	segment_start_1.AddScaledVec(line_1, t1);
-	return segment_start_1.GetDistancetoSquared(other) < segment_start_1.GetDistancetoSquared(vert1);
-}
-
 static bool s_InsideTriangle(plg::Vec2 vert1, plg::Vec2 vert2, plg::Vec2 vert3, plg::Vec2 other) {
 	plg::Vec2 normal1 = (vert1 - vert2).RotateByVec(plg::Vec2(0.0f, 1.0f));
 	plg::Vec2 normal2 = (vert2 - vert3).RotateByVec(plg::Vec2(0.0f, 1.0f));
@@ -82,6 +73,36 @@ static bool s_CollideFace(plg::Face face, container::List<plg::Vertex>* vertices
 	return s_InsideTriangle(vert1, vert2, vert3, mousePos);
 }
 
+// Twice the signed area of abc; positive when the corners run the way faces are stored.
+static double s_Orient(plg::Vec2 a, plg::Vec2 b, plg::Vec2 c) {
+	return ((double)b.x - a.x) * ((double)c.y - a.y) - ((double)b.y - a.y) * ((double)c.x - a.x);
+}
+
+// Positive when d lies inside the circumcircle of abc, for abc with a positive s_Orient.
+static double s_InCircle(plg::Vec2 a, plg::Vec2 b, plg::Vec2 c, plg::Vec2 d) {
+	double adx = (double)a.x - d.x, ady = (double)a.y - d.y;
+	double bdx = (double)b.x - d.x, bdy = (double)b.y - d.y;
+	double cdx = (double)c.x - d.x, cdy = (double)c.y - d.y;
+	double ad = adx * adx + ady * ady, bd = bdx * bdx + bdy * bdy, cd = cdx * cdx + cdy * cdy;
+	return adx * (bdy * cd - bd * cdy) - ady * (bdx * cd - bd * cdx) + ad * (bdx * cdy - bdy * cdx);
+}
+
+static int32_t s_FaceVertex(const plg::Face& face, int32_t corner) {
+	return (corner == 0) ? face.m_Vert1 : (corner == 1) ? face.m_Vert2 : face.m_Vert3;
+}
+
+static int32_t s_FaceCorner(const plg::Face& face, int32_t vertex) {
+	return (face.m_Vert1 == vertex) ? 0 : (face.m_Vert2 == vertex) ? 1 : (face.m_Vert3 == vertex) ? 2 : -1;
+}
+
+static uint64_t s_SideKey(int32_t start, int32_t end) {
+	return ((uint64_t)(uint32_t)start << 32) | (uint32_t)end;
+}
+
+static uint64_t s_EdgeKey(int32_t start, int32_t end) {
+	return (start < end) ? s_SideKey(start, end) : s_SideKey(end, start);
+}
+
 void plg::Vec2::Normalize() {
 	if (x == 0.0f && y == 0.0f) { return; }
 	float l = sqrtf(SquareMagnitude());
@@ -154,103 +175,108 @@ void plg::Vec2::ConjugateWith(Vec2& vec) {
 	vec.y = tempY;
 }
 
-plg::Edge& plg::Edge::operator=(const Edge& other) {
-	if (this != &other) {
-		m_Start = other.m_Start;
-		m_End = other.m_End;
+plg::Affine2D plg::Affine2D::FromTRS(const Vec2& position, float rotation, const Vec2& scale) {
+	float cosR = std::cos(rotation);
+	float sinR = std::sin(rotation);
+	return Affine2D(cosR * scale.x, sinR * scale.x, -sinR * scale.y, cosR * scale.y, position.x, position.y);
+}
+
+plg::Affine2D plg::Affine2D::Inverse() const {
+	float det = a * d - b * c;
+	if (det == 0.0f) {
+		return Affine2D();
 	}
-	return *this;
+	float invDet = 1.0f / det;
+	float ia = d * invDet, ib = -b * invDet, ic = -c * invDet, id = a * invDet;
+	return Affine2D(ia, ib, ic, id, -(ia * tx + ic * ty), -(ib * tx + id * ty));
 }
 
-plg::Edge& plg::Edge::operator=(Edge&& other) noexcept {
-	if (this != &other) {
-		m_Start = other.m_Start;
-		m_End = other.m_End;
+plg::Mesh::Mesh(std::initializer_list<plg::Vertex> vertices)
+	: Mesh(std::span<const Vertex>(vertices.begin(), vertices.size())) { }
+
+plg::Mesh::Mesh(std::span<const Vertex> vertices, std::span<const Edge> edges, std::span<const Face> faces, bool triangulate)
+	: m_Vertices(vertices.size()), m_Edges(edges.size() > vertices.size() ? edges.size() : vertices.size()), m_Faces(faces.size()) {
+	m_Vertices.AppendRange(vertices.data(), vertices.size());
+	m_Edges.AppendRange(edges.data(), edges.size());
+	m_Faces.AppendRange(faces.data(), faces.size());
+	if (faces.empty() && triangulate && m_Vertices.GetSize() > 2) {
+		Triangulate();
 	}
-	return *this;
 }
 
-plg::Mesh::Mesh(std::initializer_list<plg::Vertex> vertices) : m_Vertices(vertices), m_Edges(vertices.size()) {
-	Vec2 topLeft(INFINITY, INFINITY), bottomRight(-INFINITY, -INFINITY);
-	size_t T_cap = m_Vertices.GetSize() + 3;
-	Vec2* vertexMesh = new Vec2[T_cap];
-	for (size_t i = 0; i < m_Vertices.GetCapacity(); i++) {
-		if (m_Vertices[i].x < topLeft.x)
-			topLeft.x = m_Vertices[i].x;
-		else if (m_Vertices[i].x > bottomRight.x)
-			bottomRight.x = m_Vertices[i].x;
-		if (m_Vertices[i].y < topLeft.y)
-			topLeft.y = m_Vertices[i].y;
-		else if (m_Vertices[i].y > bottomRight.y)
-			bottomRight.y = m_Vertices[i].y;
-		vertexMesh[i] = m_Vertices[i];
-	}
-	float dx = bottomRight.x - topLeft.x;
-	float dy = bottomRight.y - topLeft.y;
-	float dmax = (dx > dy) ? dx : dy;
-	float xmid = (bottomRight.x + topLeft.x) * 0.5f;
-	float ymid = (bottomRight.y + topLeft.y) * 0.5f;
-
-	//Add big triangle
-	vertexMesh[T_cap - 3] = Vec2(xmid - 20 * dmax, ymid + 20 * dmax);
-	vertexMesh[T_cap - 2] = Vec2(xmid, ymid - 20 * dmax);
-	vertexMesh[T_cap - 1] = Vec2(xmid + 20 * dmax, ymid + 20 * dmax);
-	container::List<Face> faces(m_Vertices.GetSize());
-	faces.Append(Face(T_cap - 3, T_cap - 2, T_cap - 1));
-	container::List<Edge> edgeBuffer(12);
-
-	for (size_t vertex = 0; vertex < T_cap - 3; vertex++) {
-		for (auto face = faces.Begin(); face < face.end_ptr; face++) {
-			if (s_InsideCircumCircle(vertexMesh[face->m_Vert1], vertexMesh[face->m_Vert2], vertexMesh[face->m_Vert3], vertexMesh[vertex])) {
-				edgeBuffer.Append(Edge(face->m_Vert1, face->m_Vert2));
-				edgeBuffer.Append(Edge(face->m_Vert2, face->m_Vert3));
-				edgeBuffer.Append(Edge(face->m_Vert3, face->m_Vert1));
-				faces.Remove(face);
-			}
-		}
-		for (auto edge1 = edgeBuffer.Begin(); edge1 < edge1.end_ptr; edge1++) {
-			bool isBadEdge = false;
-			for (auto edge2 = edge1 + 1; edge2 < edge2.end_ptr; edge2++) {
-				if (*edge1 == *edge2) {
-					edgeBuffer.Remove(edge2);
-					isBadEdge = true;
-				}
-			}
-			if (isBadEdge) {
-				edgeBuffer.Remove(edge1);
-			}
-		}
-		for (auto edge = edgeBuffer.Begin(); edge < edge.end_ptr; edge++) {
-			faces.Append(Face(edge->m_Start, edge->m_End, vertex));
+uint32_t plg::Mesh::NewRevision() {
+	// Counted over all meshes, from 1 so a revision of 0 never matches.
+	static std::atomic<uint32_t> s_Revision = 0;
+	return ++s_Revision;
+}
+
+void plg::Mesh::Triangulate() {
+	m_Revision = NewRevision();
+	// Live vertices are packed for the triangulator; slots maps a packed index back to its slot.
+	std::vector<Vec2> points;
+	std::vector<int32_t> slots;
+	std::vector<int32_t> packed(m_Vertices.GetCapacity(), -1);
+	points.reserve(m_Vertices.GetSize());
+	slots.reserve(m_Vertices.GetSize());
+	m_Vertices.ForEach([&](Vertex& vertex, size_t index) {
+		packed[index] = (int32_t)points.size();
+		points.push_back(vertex);
+		slots.push_back((int32_t)index);
+	});
+	// Edges already in the mesh are kept as constraints.
+	std::vector<Edge> segments;
+	std::unordered_set<uint64_t> edgeKeys(m_Edges.GetSize() + points.size() * 3);
+	segments.reserve(m_Edges.GetSize());
+	for (auto edge = m_Edges.Begin(); edge < edge.end_ptr; edge++) {
+		if (edge->m_Start >= 0 && edge->m_End >= 0 && (size_t)edge->m_Start < packed.size() && (size_t)edge->m_End < packed.size() && packed[edge->m_Start] != -1 && packed[edge->m_End] != -1) {
+			segments.push_back(Edge(packed[edge->m_Start], packed[edge->m_End]));
+			edgeKeys.insert(s_EdgeKey((int32_t)edge->m_Start, (int32_t)edge->m_End));
 		}
-		edgeBuffer.Clear();
 	}
-	for (auto face = faces.Begin(); face < face.end_ptr; face++) {
-		if (!(T_cap - 1 == face->m_Vert1 || T_cap - 1 == face->m_Vert2 || T_cap - 1 == face->m_Vert3 ||
-			T_cap - 2 == face->m_Vert1 || T_cap - 2 == face->m_Vert2 || T_cap - 2 == face->m_Vert3 ||
-			T_cap - 3 == face->m_Vert1 || T_cap - 3 == face->m_Vert2 || T_cap - 3 == face->m_Vert3)) {
-			m_Faces.Append(*face);
-			
-			Edge edge1(face->m_Vert1, face->m_Vert2), edge2(face->m_Vert2, face->m_Vert3), edge3(face->m_Vert3, face->m_Vert1);
-			m_Edges.Append(edge1);
-			m_Edges.Append(edge2);
-			m_Edges.Append(edge3);
+	Triangulator triangulator;
+	triangulator.Triangulate(points, segments);
+	if (triangulator.GetSkippedSegmentCount() > 0) {
+		Log("Warning! Crossing mesh edges were left out of the triangulation!", true);
+	}
+	std::span<const uint32_t> triangles = triangulator.GetTriangles();
+	for (size_t triangle = 0; triangle < triangles.size(); triangle += 3) {
+		int32_t corners[3] = { slots[triangles[triangle]], slots[triangles[triangle + 1]], slots[triangles[triangle + 2]] };
+		m_Faces.Append(Face(corners[0], corners[1], corners[2]));
+		for (int32_t corner = 0; corner < 3; corner++) {
+			int32_t start = corners[corner], end = corners[(corner + 1) % 3];
+			if (edgeKeys.insert(s_EdgeKey(start, end)).second) {
+				m_Edges.Append(Edge(start, end));
+			}
 		}
 	}
-	delete[] vertexMesh;
+	m_TopologyDirty = true;
 }
 
 plg::Mesh::Mesh(const Mesh& other)
-	: m_Vertices(other.m_Vertices), m_Edges(other.m_Edges), m_Faces(other.m_Faces) { }
+	: m_Vertices(other.m_Vertices), m_Edges(other.m_Edges), m_Faces(other.m_Faces), m_UVs(other.m_UVs), m_FaceMaterials(other.m_FaceMaterials), m_FaceTwins(other.m_FaceTwins), m_FaceEdges(other.m_FaceEdges),
+	m_VertexFaces(other.m_VertexFaces), m_LastFace(other.m_LastFace), m_LooseEdgeCount(other.m_LooseEdgeCount), m_TopologyDirty(other.m_TopologyDirty) { }
 
 plg::Mesh::Mesh(Mesh&& other) noexcept
-	: m_Vertices(std::move(other.m_Vertices)), m_Edges(std::move(other.m_Edges)), m_Faces(std::move(other.m_Faces)) { }
+	: m_Vertices(std::move(other.m_Vertices)), m_Edges(std::move(other.m_Edges)), m_Faces(std::move(other.m_Faces)), m_UVs(std::move(other.m_UVs)), m_FaceMaterials(std::move(other.m_FaceMaterials)), m_FaceTwins(std::move(other.m_FaceTwins)),
+	m_FaceEdges(std::move(other.m_FaceEdges)), m_VertexFaces(std::move(other.m_VertexFaces)), m_LastFace(other.m_LastFace), m_LooseEdgeCount(other.m_LooseEdgeCount),
+	m_TopologyDirty(other.m_TopologyDirty) { }
 
 plg::Mesh& plg::Mesh::operator=(const Mesh& other) {
 	if (this != &other) {
 		m_Vertices = other.m_Vertices;
 		m_Edges = other.m_Edges;
 		m_Faces = other.m_Faces;
+		m_UVs = other.m_UVs;
+		m_FaceMaterials = other.m_FaceMaterials;
+		m_FaceTwins = other.m_FaceTwins;
+		m_FaceEdges = other.m_FaceEdges;
+		m_VertexFaces = other.m_VertexFaces;
+		m_LastFace = other.m_LastFace;
+		m_LooseEdgeCount = other.m_LooseEdgeCount;
+		m_TopologyDirty = other.m_TopologyDirty;
+		m_Revision = NewRevision();
+		m_DeformedVertices = {};
+		m_LOD = nullptr;
 	}
 	return *this;
 }
@@ -260,20 +286,1177 @@ plg::Mesh& plg::Mesh::operator=(Mesh&& other) noexcept {
 		m_Vertices = std::move(other.m_Vertices);
 		m_Edges = std::move(other.m_Edges);
 		m_Faces = std::move(other.m_Faces);
+		m_UVs = std::move(other.m_UVs);
+		m_FaceMaterials = std::move(other.m_FaceMaterials);
+		m_FaceTwins = std::move(other.m_FaceTwins);
+		m_FaceEdges = std::move(other.m_FaceEdges);
+		m_VertexFaces = std::move(other.m_VertexFaces);
+		m_LastFace = other.m_LastFace;
+		m_LooseEdgeCount = other.m_LooseEdgeCount;
+		m_TopologyDirty = other.m_TopologyDirty;
+		m_Revision = NewRevision();
+		m_DeformedVertices = {};
+		m_LOD = nullptr;
 	}
 	return *this;
 }
 
 int32_t plg::Mesh::AddVertex(plg::Vertex object) {
+	m_Revision = NewRevision();
 	return m_Vertices.Append(object);
 }
 
 int32_t plg::Mesh::AddEdge(plg::Edge object) {
+	m_Revision = NewRevision();
+	m_LooseEdgeCount++;
 	return m_Edges.Append(object);
 }
 
 int32_t plg::Mesh::AddFace(plg::Face object) {
-	return 0;
+	m_Revision = NewRevision();
+	m_TopologyDirty = true;
+	return m_Faces.Append(object);
+}
+
+void plg::Mesh::Reserve(size_t vertexCount, size_t edgeCount, size_t faceCount) {
+	m_Vertices.Reserve(vertexCount);
+	m_Edges.Reserve(edgeCount);
+	m_Faces.Reserve(faceCount);
+}
+
+int32_t plg::Mesh::AppendVertices(std::span<const Vertex> vertices) {
+	m_Revision = NewRevision();
+	return (int32_t)m_Vertices.AppendRange(vertices.data(), vertices.size());
+}
+
+int32_t plg::Mesh::AppendEdges(std::span<const Edge> edges, int32_t vertexOffset) {
+	size_t first = m_Edges.AppendRange(edges.data(), edges.size());
+	m_Revision = NewRevision();
+	m_TopologyDirty = true;
+	if (vertexOffset != 0) {
+		for (size_t index = first; index < first + edges.size(); index++) {
+			m_Edges[index].m_Start += vertexOffset;
+			m_Edges[index].m_End += vertexOffset;
+		}
+	}
+	return (int32_t)first;
+}
+
+int32_t plg::Mesh::AppendFaces(std::span<const Face> faces, int32_t vertexOffset) {
+	size_t first = m_Faces.AppendRange(faces.data(), faces.size());
+	m_Revision = NewRevision();
+	m_TopologyDirty = true;
+	if (vertexOffset != 0) {
+		for (size_t index = first; index < first + faces.size(); index++) {
+			m_Faces[index].m_Vert1 += vertexOffset;
+			m_Faces[index].m_Vert2 += vertexOffset;
+			m_Faces[index].m_Vert3 += vertexOffset;
+		}
+	}
+	return (int32_t)first;
+}
+
+int32_t plg::Mesh::InsertVertex(Vertex object) {
+	if (m_TopologyDirty) {
+		BuildTopology();
+	}
+	if (m_Faces.GetSize() == 0) {
+		// Nothing to walk yet; the first triangle comes from a full pass.
+		int32_t vertex = AddVertex(object);
+		if (m_Vertices.GetSize() > 2) {
+			Triangulate();
+			BuildTopology();
+		}
+		return vertex;
+	}
+	int32_t face, side;
+	Location location = LocateFace(object, &face, &side);
+	if (face == -1) {
+		Log("Warning! Could not place the vertex in the triangulation!", true);
+		return AddVertex(object);
+	}
+	if (location == Location::VERTEX) {
+		return s_FaceVertex(m_Faces[face], side);
+	}
+	int32_t vertex = (int32_t)m_Vertices.Append(object);
+	m_Revision = NewRevision();
+	if ((size_t)vertex >= m_VertexFaces.size()) {
+		m_VertexFaces.resize(m_Vertices.GetCapacity(), -1);
+	}
+	m_LegalizeStack.clear();
+	if (location == Location::INSIDE) {
+		SplitFace(face, vertex);
+	}
+	else if (location == Location::EDGE) {
+		SplitEdge(face, side, vertex);
+	}
+	else {
+		ExtendHull(face, side, vertex);
+	}
+	Legalize();
+	return vertex;
+}
+
+bool plg::Mesh::RemoveVertex(int32_t vertex) {
+	if (vertex < 0 || (size_t)vertex >= m_Vertices.GetCapacity() || m_Vertices.IsEmptySlot(vertex)) {
+		Log("Warning! Vertex to remove does not exist!", true);
+		return false;
+	}
+	m_Revision = NewRevision();
+	if (m_TopologyDirty) {
+		BuildTopology();
+	}
+	if ((size_t)vertex < m_VertexFaces.size() && m_VertexFaces[vertex] != -1) {
+		m_LegalizeStack.clear();
+		RemoveStar(vertex, m_VertexFaces[vertex]);
+		Legalize();
+		m_VertexFaces[vertex] = -1;
+	}
+	// Edges drawn by hand are not part of any face, so only they need a scan.
+	if (m_LooseEdgeCount > 0) {
+		for (auto edge = m_Edges.Begin(); edge < edge.end_ptr; edge++) {
+			if (edge->m_Start == vertex || edge->m_End == vertex) {
+				m_Edges.Remove(edge);
+				m_LooseEdgeCount--;
+			}
+		}
+	}
+	m_Vertices.Remove(vertex);
+	return true;
+}
+
+template<typename T_obj>
+static std::vector<int32_t> s_SortedSlots(container::List<T_obj>& list, std::span<const int32_t> slots) {
+	std::vector<int32_t> sorted;
+	sorted.reserve(slots.size());
+	for (int32_t slot : slots) {
+		if (slot >= 0 && (size_t)slot < list.GetCapacity() && !list.IsEmptySlot(slot)) {
+			sorted.push_back(slot);
+		}
+	}
+	std::sort(sorted.begin(), sorted.end());
+	sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+	return sorted;
+}
+
+static int32_t s_SortedIndex(const std::vector<int32_t>& sorted, int32_t value) {
+	auto found = std::lower_bound(sorted.begin(), sorted.end(), value);
+	return (found != sorted.end() && *found == value) ? (int32_t)(found - sorted.begin()) : -1;
+}
+
+int32_t plg::Mesh::ExtrudeEdges(std::span<const int32_t> edges, float distance) {
+	if (m_TopologyDirty) {
+		BuildTopology();
+	}
+	std::vector<int32_t> selected = s_SortedSlots(m_Edges, edges);
+	// Edges with faces on both sides have nowhere to go; a wall there would overlap a face.
+	selected.erase(std::remove_if(selected.begin(), selected.end(), [&](int32_t edge) {
+		int32_t forward, backward;
+		FindEdgeSides(m_Edges[edge].m_Start, m_Edges[edge].m_End, &forward, &backward);
+		return forward != -1 && backward != -1;
+	}), selected.end());
+	if (selected.empty()) {
+		return -1;
+	}
+	std::vector<int32_t> sources;
+	sources.reserve(selected.size() * 2);
+	for (int32_t edge : selected) {
+		sources.push_back(m_Edges[edge].m_Start);
+		sources.push_back(m_Edges[edge].m_End);
+	}
+	std::sort(sources.begin(), sources.end());
+	sources.erase(std::unique(sources.begin(), sources.end()), sources.end());
+
+	// Each copy moves along the mean of its edge normals, lengthened so the new edges run
+	// parallel to the old ones at the full distance.
+	std::vector<Vec2> normals(sources.size());
+	std::vector<int32_t> normalCounts(sources.size(), 0);
+	for (int32_t edge : selected) {
+		int32_t start = m_Edges[edge].m_Start, end = m_Edges[edge].m_End;
+		int32_t forward, backward;
+		FindEdgeSides(start, end, &forward, &backward);
+		float dx = m_Vertices[end].x - m_Vertices[start].x;
+		float dy = m_Vertices[end].y - m_Vertices[start].y;
+		float length = sqrtf(dx * dx + dy * dy);
+		if (length == 0.0f) {
+			continue;
+		}
+		// Faces lie to the left of their sides, so an edge with a face only along it points right.
+		float side = (forward != -1 && backward == -1) ? -1.0f : 1.0f;
+		Vec2 normal(-dy * side / length, dx * side / length);
+		for (int32_t vertex : { start, end }) {
+			int32_t index = s_SortedIndex(sources, vertex);
+			normals[index].x += normal.x;
+			normals[index].y += normal.y;
+			normalCounts[index]++;
+		}
+	}
+	std::vector<Vertex> copies(sources.size());
+	for (size_t index = 0; index < sources.size(); index++) {
+		Vec2 mean = (normalCounts[index] > 0) ? Vec2(normals[index].x / normalCounts[index], normals[index].y / normalCounts[index]) : Vec2();
+		float scale = (normalCounts[index] > 0) ? distance / std::max(mean.SquareMagnitude(), 0.25f) : 0.0f;
+		copies[index] = Vertex(m_Vertices[sources[index]].x + mean.x * scale, m_Vertices[sources[index]].y + mean.y * scale);
+	}
+	int32_t first = AppendVertices(copies);
+
+	std::vector<Edge> newEdges;
+	newEdges.reserve(selected.size() + sources.size());
+	std::vector<Face> newFaces;
+	newFaces.reserve(selected.size() * 2);
+	std::vector<int32_t> parents;
+	parents.reserve(selected.size() * 2);
+	for (int32_t edge : selected) {
+		int32_t start = m_Edges[edge].m_Start, end = m_Edges[edge].m_End;
+		int32_t startCopy = first + s_SortedIndex(sources, start), endCopy = first + s_SortedIndex(sources, end);
+		newEdges.push_back(Edge(startCopy, endCopy));
+		newEdges.push_back(Edge(start, endCopy));
+		newFaces.push_back(Face(start, end, endCopy));
+		newFaces.push_back(Face(start, endCopy, startCopy));
+		// The wall is painted like the face it grows from.
+		int32_t forward, backward;
+		FindEdgeSides(start, end, &forward, &backward);
+		int32_t parent = (forward != -1) ? forward / 3 : (backward != -1) ? backward / 3 : -1;
+		parents.insert(parents.end(), { parent, parent });
+	}
+	for (size_t index = 0; index < sources.size(); index++) {
+		newEdges.push_back(Edge(sources[index], first + index));
+	}
+	for (Face& face : newFaces) {
+		if (s_Orient(m_Vertices[face.m_Vert1], m_Vertices[face.m_Vert2], m_Vertices[face.m_Vert3]) < 0.0) {
+			std::swap(face.m_Vert2, face.m_Vert3);
+		}
+	}
+	// The walls only meet each other and the faces along the selected edges, so only those
+	// sides are relinked; a loose edge stops being loose once a wall runs along it.
+	std::vector<int32_t> neighbours;
+	neighbours.reserve(selected.size());
+	for (int32_t edge : selected) {
+		int32_t forward, backward;
+		FindEdgeSides(m_Edges[edge].m_Start, m_Edges[edge].m_End, &forward, &backward);
+		neighbours.push_back((forward != -1) ? forward : backward);
+		if (forward == -1 && backward == -1) {
+			m_LooseEdgeCount--;
+		}
+	}
+	int32_t firstEdge = AppendEdges(newEdges);
+	int32_t firstFace = AppendFaces(newFaces);
+	for (size_t face = 0; face < parents.size(); face++) {
+		InheritMaterial(firstFace + (int32_t)face, parents[face]);
+	}
+	std::vector<int32_t> stitched(newFaces.size()), candidates(selected);
+	std::iota(stitched.begin(), stitched.end(), firstFace);
+	candidates.resize(selected.size() + newEdges.size());
+	std::iota(candidates.begin() + selected.size(), candidates.end(), firstEdge);
+	StitchFaces(stitched, neighbours, candidates);
+	return first;
+}
+
+int32_t plg::Mesh::ExtrudeFaces(std::span<const int32_t> faces, Vec2 offset) {
+	if (m_TopologyDirty) {
+		BuildTopology();
+	}
+	std::vector<int32_t> selected = s_SortedSlots(m_Faces, faces);
+	if (selected.empty()) {
+		return -1;
+	}
+	// The outline is every side whose twin is missing or belongs to a face left behind.
+	std::vector<int32_t> outline, moved, copied;
+	moved.reserve(selected.size() * 3);
+	for (int32_t face : selected) {
+		for (int32_t corner = 0; corner < 3; corner++) {
+			int32_t twin = m_FaceTwins[face * 3 + corner];
+			moved.push_back(s_FaceVertex(m_Faces[face], corner));
+			if (twin == -1 || s_SortedIndex(selected, twin / 3) == -1) {
+				outline.push_back(face * 3 + corner);
+				copied.push_back(s_FaceVertex(m_Faces[face], corner));
+				copied.push_back(s_FaceVertex(m_Faces[face], (corner + 1) % 3));
+			}
+		}
+	}
+	std::sort(moved.begin(), moved.end());
+	moved.erase(std::unique(moved.begin(), moved.end()), moved.end());
+	std::sort(copied.begin(), copied.end());
+	copied.erase(std::unique(copied.begin(), copied.end()), copied.end());
+
+	std::vector<Vertex> copies(copied.size());
+	for (size_t index = 0; index < copied.size(); index++) {
+		copies[index] = Vertex(m_Vertices[copied[index]].x + offset.x, m_Vertices[copied[index]].y + offset.y);
+	}
+	int32_t first = AppendVertices(copies);
+	auto copyOf = [&](int32_t vertex) {
+		int32_t index = s_SortedIndex(copied, vertex);
+		return (index == -1) ? vertex : first + index;
+	};
+	for (int32_t vertex : moved) {
+		if (s_SortedIndex(copied, vertex) == -1) {
+			m_Vertices[vertex].x += offset.x;
+			m_Vertices[vertex].y += offset.y;
+		}
+	}
+
+	// Outline edges stay with the faces outside and get a copy for the lifted ones; the
+	// wall between the two is split along a diagonal.
+	std::vector<Edge> newEdges;
+	newEdges.reserve(outline.size() * 2 + copied.size());
+	std::vector<Face> newFaces;
+	newFaces.reserve(outline.size() * 2);
+	std::vector<int32_t> parents;
+	parents.reserve(outline.size() * 2);
+	for (int32_t side : outline) {
+		parents.insert(parents.end(), { side / 3, side / 3 });
+		int32_t start = s_FaceVertex(m_Faces[side / 3], side % 3), end = s_FaceVertex(m_Faces[side / 3], (side % 3 + 1) % 3);
+		newEdges.push_back(Edge(copyOf(start), copyOf(end)));
+		newEdges.push_back(Edge(start, copyOf(end)));
+		newFaces.push_back(Face(start, end, copyOf(end)));
+		newFaces.push_back(Face(start, copyOf(end), copyOf(start)));
+	}
+	for (size_t index = 0; index < copied.size(); index++) {
+		newEdges.push_back(Edge(copied[index], first + index));
+	}
+	// Faces outside only meet the lifted ones across the outline, and the lifted faces keep
+	// their edges, so just these sides are relinked below.
+	std::vector<int32_t> neighbours, candidates;
+	neighbours.reserve(outline.size());
+	candidates.reserve(selected.size() * 3 + newEdges.size());
+	for (int32_t side : outline) {
+		neighbours.push_back(m_FaceTwins[side]);
+	}
+	for (int32_t face : selected) {
+		candidates.insert(candidates.end(), &m_FaceEdges[face * 3], &m_FaceEdges[face * 3] + 3);
+	}
+	// Edges inside the selection only border lifted faces, so they follow them.
+	for (int32_t face : selected) {
+		for (int32_t corner = 0; corner < 3; corner++) {
+			int32_t twin = m_FaceTwins[face * 3 + corner];
+			int32_t edge = m_FaceEdges[face * 3 + corner];
+			if (edge != -1 && twin != -1 && s_SortedIndex(selected, twin / 3) != -1) {
+				m_Edges[edge].m_Start = copyOf(m_Edges[edge].m_Start);
+				m_Edges[edge].m_End = copyOf(m_Edges[edge].m_End);
+			}
+		}
+	}
+	for (int32_t face : selected) {
+		Face& lifted = m_Faces[face];
+		lifted = Face(copyOf(lifted.m_Vert1), copyOf(lifted.m_Vert2), copyOf(lifted.m_Vert3));
+	}
+	for (Face& face : newFaces) {
+		if (s_Orient(m_Vertices[face.m_Vert1], m_Vertices[face.m_Vert2], m_Vertices[face.m_Vert3]) < 0.0) {
+			std::swap(face.m_Vert2, face.m_Vert3);
+		}
+	}
+	int32_t firstEdge = AppendEdges(newEdges);
+	int32_t firstFace = AppendFaces(newFaces);
+	for (size_t face = 0; face < parents.size(); face++) {
+		InheritMaterial(firstFace + (int32_t)face, parents[face]);
+	}
+	std::vector<int32_t> stitched(selected);
+	stitched.resize(selected.size() + newFaces.size());
+	std::iota(stitched.begin() + selected.size(), stitched.end(), firstFace);
+	candidates.resize(candidates.size() + newEdges.size());
+	std::iota(candidates.end() - newEdges.size(), candidates.end(), firstEdge);
+	StitchFaces(stitched, neighbours, candidates);
+	return first;
+}
+
+size_t plg::Mesh::BevelEdges(std::span<const int32_t> edges, float width) {
+	if (m_TopologyDirty) {
+		BuildTopology();
+	}
+	std::vector<int32_t> selected = s_SortedSlots(m_Edges, edges);
+	if (selected.empty() || !(width > 0.0f)) {
+		return 0;
+	}
+	// Selected edges on the hull as the sides running along it, keyed by start and by end.
+	std::vector<std::pair<int32_t, int32_t>> leaving, entering;
+	for (int32_t edge : selected) {
+		int32_t forward, backward;
+		FindEdgeSides(m_Edges[edge].m_Start, m_Edges[edge].m_End, &forward, &backward);
+		if ((forward == -1) == (backward == -1)) {
+			continue;
+		}
+		int32_t side = (forward != -1) ? forward : backward;
+		leaving.push_back({ s_FaceVertex(m_Faces[side / 3], side % 3), side });
+		entering.push_back({ s_FaceVertex(m_Faces[side / 3], (side % 3 + 1) % 3), side });
+	}
+	std::sort(leaving.begin(), leaving.end());
+	std::sort(entering.begin(), entering.end());
+
+	struct BevelCorner {
+		int32_t vertex, in, out;
+		Vec2 cutIn, cutOut, middle;
+		bool alive;
+	};
+	std::vector<BevelCorner> corners;
+	auto cut = [&](int32_t vertex, int32_t other) {
+		Vec2 from = m_Vertices[vertex], to = m_Vertices[other];
+		float length = from.GetDistanceTo(to);
+		float t = (length > 0.0f) ? std::min(width, 0.45f * length) / length : 0.0f;
+		return Vec2(from.x + (to.x - from.x) * t, from.y + (to.y - from.y) * t);
+	};
+	for (size_t index = 0; index < entering.size(); index++) {
+		int32_t vertex = entering[index].first;
+		bool single = (index == 0 || entering[index - 1].first != vertex) && (index + 1 == entering.size() || entering[index + 1].first != vertex);
+		auto out = std::lower_bound(leaving.begin(), leaving.end(), std::make_pair(vertex, INT32_MIN));
+		if (!single || out == leaving.end() || out->first != vertex || (out + 1 != leaving.end() && (out + 1)->first == vertex)) {
+			continue;
+		}
+		int32_t in = entering[index].second;
+		// An ear has both sides in one face, which has no room for two cuts.
+		if (in / 3 == out->second / 3) {
+			continue;
+		}
+		Vec2 cutIn = cut(vertex, s_FaceVertex(m_Faces[in / 3], in % 3));
+		Vec2 cutOut = cut(vertex, s_FaceVertex(m_Faces[out->second / 3], (out->second % 3 + 1) % 3));
+		Vec2 middle((cutIn.x + cutOut.x) * 0.5f, (cutIn.y + cutOut.y) * 0.5f);
+		corners.push_back(BevelCorner{ vertex, in, out->second, cutIn, cutOut, middle, true });
+	}
+
+	// Corners come out sorted by vertex. A face may hold one cut side, and every face
+	// around a corner has to keep its winding once the corner moves to the middle of its cut.
+	auto findCorner = [&](int32_t vertex) -> BevelCorner* {
+		auto found = std::lower_bound(corners.begin(), corners.end(), vertex, [](const BevelCorner& corner, int32_t value) { return corner.vertex < value; });
+		return (found != corners.end() && found->vertex == vertex && found->alive) ? &*found : nullptr;
+	};
+	auto position = [&](int32_t vertex) {
+		BevelCorner* corner = findCorner(vertex);
+		return (corner != nullptr) ? corner->middle : m_Vertices[vertex];
+	};
+	std::vector<std::pair<int32_t, int32_t>> cutSides;
+	std::vector<int32_t> crowded;
+	auto chainOf = [&](int32_t side, Vec2* points, int32_t* vertices, int32_t* cutCorners) {
+		const Face& face = m_Faces[side / 3];
+		int32_t start = s_FaceVertex(face, side % 3), end = s_FaceVertex(face, (side % 3 + 1) % 3);
+		int32_t count = 0;
+		points[count] = position(start);
+		vertices[count++] = start;
+		BevelCorner* startCorner = findCorner(start);
+		if (startCorner != nullptr && startCorner->out == side) {
+			cutCorners[count] = (int32_t)(startCorner - corners.data());
+			points[count] = startCorner->cutOut;
+			vertices[count++] = -1;
+		}
+		BevelCorner* endCorner = findCorner(end);
+		if (endCorner != nullptr && endCorner->in == side) {
+			cutCorners[count] = (int32_t)(endCorner - corners.data());
+			points[count] = endCorner->cutIn;
+			vertices[count++] = -2;
+		}
+		points[count] = position(end);
+		vertices[count++] = end;
+		return count;
+	};
+	auto faceHolds = [&](int32_t face) {
+		auto found = std::lower_bound(cutSides.begin(), cutSides.end(), std::make_pair(face, INT32_MIN));
+		const Face& target = m_Faces[face];
+		if (found == cutSides.end() || found->first != face) {
+			return s_Orient(position(target.m_Vert1), position(target.m_Vert2), position(target.m_Vert3)) > 0.0;
+		}
+		Vec2 points[4];
+		int32_t vertices[4], cutCorners[4];
+		int32_t count = chainOf(found->second, points, vertices, cutCorners);
+		Vec2 apex = position(s_FaceVertex(target, (found->second % 3 + 2) % 3));
+		for (int32_t point = 0; point + 1 < count; point++) {
+			if (s_Orient(points[point], points[point + 1], apex) <= 0.0) {
+				return false;
+			}
+		}
+		return true;
+	};
+	for (bool changed = true; changed;) {
+		changed = false;
+		cutSides.clear();
+		for (const BevelCorner& corner : corners) {
+			if (corner.alive) {
+				cutSides.push_back({ corner.in / 3, corner.in });
+				cutSides.push_back({ corner.out / 3, corner.out });
+			}
+		}
+		std::sort(cutSides.begin(), cutSides.end());
+		cutSides.erase(std::unique(cutSides.begin(), cutSides.end()), cutSides.end());
+		crowded.clear();
+		for (size_t index = 1; index < cutSides.size(); index++) {
+			if (cutSides[index].first == cutSides[index - 1].first) {
+				crowded.push_back(cutSides[index].first);
+			}
+		}
+		if (!crowded.empty()) {
+			for (BevelCorner& corner : corners) {
+				if (corner.alive && (s_SortedIndex(crowded, corner.in / 3) != -1 || s_SortedIndex(crowded, corner.out / 3) != -1)) {
+					corner.alive = false;
+				}
+			}
+			changed = true;
+			continue;
+		}
+		for (BevelCorner& corner : corners) {
+			if (!corner.alive) {
+				continue;
+			}
+			bool holds = true;
+			VisitFan(corner.vertex, [&](int32_t face, int32_t) {
+				holds = holds && faceHolds(face);
+			});
+			if (!holds) {
+				corner.alive = false;
+				changed = true;
+			}
+		}
+	}
+
+	std::vector<Vertex> cutPoints;
+	std::vector<int32_t> cutIndices(corners.size(), -1);
+	for (size_t index = 0; index < corners.size(); index++) {
+		if (corners[index].alive) {
+			cutIndices[index] = (int32_t)cutPoints.size();
+			cutPoints.push_back(corners[index].cutIn);
+			cutPoints.push_back(corners[index].cutOut);
+		}
+	}
+	if (cutPoints.empty()) {
+		return 0;
+	}
+	int32_t first = AppendVertices(cutPoints);
+	// Only the cut faces and their fans change, so their sides and the sides facing them
+	// from untouched faces are all that get relinked afterwards.
+	std::vector<int32_t> stitched, neighbours, candidates;
+	stitched.reserve(cutSides.size() + cutPoints.size());
+	for (const std::pair<int32_t, int32_t>& cutSide : cutSides) {
+		stitched.push_back(cutSide.first);
+	}
+	for (int32_t face : stitched) {
+		for (int32_t corner = 0; corner < 3; corner++) {
+			int32_t twin = m_FaceTwins[face * 3 + corner];
+			if (twin != -1 && s_SortedIndex(stitched, twin / 3) == -1) {
+				neighbours.push_back(twin);
+			}
+			candidates.push_back(m_FaceEdges[face * 3 + corner]);
+		}
+	}
+	// Each cut side becomes a fan from the opposite corner of its face, the face itself
+	// keeping the first triangle and the side's edge the first segment.
+	std::vector<Edge> newEdges;
+	newEdges.reserve(cutPoints.size() * 2);
+	std::vector<Face> newFaces;
+	newFaces.reserve(cutPoints.size());
+	std::vector<int32_t> parents;
+	parents.reserve(cutPoints.size());
+	for (const std::pair<int32_t, int32_t>& cutSide : cutSides) {
+		int32_t side = cutSide.second;
+		Vec2 points[4];
+		int32_t vertices[4], cutCorners[4];
+		int32_t count = chainOf(side, points, vertices, cutCorners);
+		for (int32_t point = 1; point + 1 < count; point++) {
+			vertices[point] = first + cutIndices[cutCorners[point]] + ((vertices[point] == -1) ? 1 : 0);
+		}
+		int32_t apex = s_FaceVertex(m_Faces[side / 3], (side % 3 + 2) % 3);
+		int32_t edge = m_FaceEdges[side];
+		m_Faces[side / 3] = Face(vertices[0], vertices[1], apex);
+		m_Edges[edge] = Edge(vertices[0], vertices[1]);
+		for (int32_t point = 1; point + 1 < count; point++) {
+			newFaces.push_back(Face(vertices[point], vertices[point + 1], apex));
+			parents.push_back(side / 3);
+			newEdges.push_back(Edge(vertices[point], vertices[point + 1]));
+			newEdges.push_back(Edge(vertices[point], apex));
+		}
+	}
+	size_t bevelled = 0;
+	for (const BevelCorner& corner : corners) {
+		if (corner.alive) {
+			m_Vertices[corner.vertex] = corner.middle;
+			bevelled++;
+		}
+	}
+	int32_t firstEdge = AppendEdges(newEdges);
+	int32_t firstFace = AppendFaces(newFaces);
+	for (size_t face = 0; face < parents.size(); face++) {
+		InheritMaterial(firstFace + (int32_t)face, parents[face]);
+	}
+	stitched.resize(stitched.size() + newFaces.size());
+	std::iota(stitched.end() - newFaces.size(), stitched.end(), firstFace);
+	candidates.resize(candidates.size() + newEdges.size());
+	std::iota(candidates.end() - newEdges.size(), candidates.end(), firstEdge);
+	StitchFaces(stitched, neighbours, candidates);
+	return bevelled;
+}
+
+template<typename T_func>
+void plg::Mesh::VisitFan(int32_t vertex, T_func&& func) {
+	if (vertex < 0 || (size_t)vertex >= m_VertexFaces.size() || m_VertexFaces[vertex] == -1) {
+		return;
+	}
+	// Turns one way through the sides coming into the vertex, then the other way from the
+	// start when the fan opens onto the hull.
+	int32_t start = m_VertexFaces[vertex];
+	size_t limit = m_Faces.GetSize();
+	int32_t current = start;
+	for (size_t step = 0; step < limit; step++) {
+		int32_t corner = s_FaceCorner(m_Faces[current], vertex);
+		func(current, corner);
+		int32_t twin = m_FaceTwins[current * 3 + (corner + 2) % 3];
+		if (twin == -1) {
+			break;
+		}
+		current = twin / 3;
+		if (current == start) {
+			return;
+		}
+	}
+	current = start;
+	for (size_t step = 0; step < limit; step++) {
+		int32_t twin = m_FaceTwins[current * 3 + s_FaceCorner(m_Faces[current], vertex)];
+		if (twin == -1) {
+			return;
+		}
+		current = twin / 3;
+		func(current, s_FaceCorner(m_Faces[current], vertex));
+	}
+}
+
+void plg::Mesh::FindEdgeSides(int32_t start, int32_t end, int32_t* forward, int32_t* backward) {
+	*forward = -1;
+	*backward = -1;
+	VisitFan(start, [&](int32_t face, int32_t corner) {
+		if (s_FaceVertex(m_Faces[face], (corner + 1) % 3) == end) {
+			*forward = face * 3 + corner;
+		}
+		if (s_FaceVertex(m_Faces[face], (corner + 2) % 3) == end) {
+			*backward = face * 3 + (corner + 2) % 3;
+		}
+	});
+}
+
+void plg::Mesh::BuildTopology() {
+	size_t faceSlots = m_Faces.GetCapacity();
+	m_FaceTwins.assign(faceSlots * 3, -1);
+	m_FaceEdges.assign(faceSlots * 3, -1);
+	m_VertexFaces.assign(m_Vertices.GetCapacity(), -1);
+	m_LastFace = -1;
+	std::unordered_map<uint64_t, int32_t> sides(m_Faces.GetSize() * 3);
+	for (auto face = m_Faces.Begin(); face < face.end_ptr; face++) {
+		int32_t slot = (int32_t)face.GetIndex();
+		if (s_Orient(m_Vertices[face->m_Vert1], m_Vertices[face->m_Vert2], m_Vertices[face->m_Vert3]) < 0.0) {
+			std::swap(face->m_Vert2, face->m_Vert3);
+		}
+		for (int32_t corner = 0; corner < 3; corner++) {
+			int32_t start = s_FaceVertex(*face, corner), end = s_FaceVertex(*face, (corner + 1) % 3);
+			m_VertexFaces[start] = slot;
+			auto twin = sides.find(s_SideKey(end, start));
+			if (twin != sides.end()) {
+				m_FaceTwins[slot * 3 + corner] = twin->second;
+				m_FaceTwins[twin->second] = slot * 3 + corner;
+			}
+			sides[s_SideKey(start, end)] = slot * 3 + corner;
+		}
+		m_LastFace = slot;
+	}
+	// Every side gets exactly one edge; the duplicates a full triangulation leaves are dropped.
+	std::unordered_map<uint64_t, int32_t> edges(m_Edges.GetSize());
+	for (auto edge = m_Edges.Begin(); edge < edge.end_ptr; edge++) {
+		if (!edges.emplace(s_EdgeKey(edge->m_Start, edge->m_End), (int32_t)edge.GetIndex()).second) {
+			m_Edges.Remove(edge);
+		}
+	}
+	size_t sideEdges = 0;
+	for (auto face = m_Faces.Begin(); face < face.end_ptr; face++) {
+		int32_t slot = (int32_t)face.GetIndex();
+		for (int32_t corner = 0; corner < 3; corner++) {
+			if (m_FaceEdges[slot * 3 + corner] != -1) {
+				continue;
+			}
+			int32_t start = s_FaceVertex(*face, corner), end = s_FaceVertex(*face, (corner + 1) % 3);
+			auto found = edges.find(s_EdgeKey(start, end));
+			int32_t edge = (found != edges.end()) ? found->second : (int32_t)m_Edges.Append(Edge(start, end));
+			m_FaceEdges[slot * 3 + corner] = edge;
+			if (m_FaceTwins[slot * 3 + corner] != -1) {
+				m_FaceEdges[m_FaceTwins[slot * 3 + corner]] = edge;
+			}
+			sideEdges++;
+		}
+	}
+	m_LooseEdgeCount = m_Edges.GetSize() - sideEdges;
+	m_TopologyDirty = false;
+}
+
+plg::Mesh::FaceSides plg::Mesh::ReadFace(int32_t face, int32_t side) {
+	FaceSides sides;
+	const Face& target = m_Faces[face];
+	for (int32_t offset = 0; offset < 3; offset++) {
+		int32_t corner = (side + offset) % 3;
+		sides.vertex[offset] = s_FaceVertex(target, corner);
+		sides.twin[offset] = m_FaceTwins[face * 3 + corner];
+		sides.edge[offset] = m_FaceEdges[face * 3 + corner];
+	}
+	return sides;
+}
+
+int32_t plg::Mesh::NewFace(int32_t vert1, int32_t vert2, int32_t vert3) {
+	int32_t face = (int32_t)m_Faces.Append(Face(vert1, vert2, vert3));
+	if ((size_t)face * 3 + 3 > m_FaceTwins.size()) {
+		m_FaceTwins.resize(m_Faces.GetCapacity() * 3, -1);
+		m_FaceEdges.resize(m_Faces.GetCapacity() * 3, -1);
+	}
+	return face;
+}
+
+void plg::Mesh::InheritMaterial(int32_t face, int32_t parent) {
+	if (m_FaceMaterials.empty()) {
+		return;
+	}
+	if (m_FaceMaterials.size() < m_Faces.GetCapacity()) {
+		m_FaceMaterials.resize(m_Faces.GetCapacity(), MaterialLibrary::DEFAULT_MATERIAL);
+	}
+	m_FaceMaterials[face] = (parent != -1) ? GetFaceMaterial(parent) : MaterialLibrary::DEFAULT_MATERIAL;
+}
+
+void plg::Mesh::SetSide(int32_t face, int32_t corner, int32_t twin, int32_t edge) {
+	m_FaceTwins[face * 3 + corner] = twin;
+	m_FaceEdges[face * 3 + corner] = edge;
+	if (twin != -1) {
+		m_FaceTwins[twin] = face * 3 + corner;
+		m_FaceEdges[twin] = edge;
+	}
+}
+
+void plg::Mesh::StitchFaces(std::span<const int32_t> faces, std::span<const int32_t> neighbours, std::span<const int32_t> edges) {
+	if (m_FaceTwins.size() < m_Faces.GetCapacity() * 3) {
+		m_FaceTwins.resize(m_Faces.GetCapacity() * 3, -1);
+		m_FaceEdges.resize(m_Faces.GetCapacity() * 3, -1);
+	}
+	if (m_VertexFaces.size() < m_Vertices.GetCapacity()) {
+		m_VertexFaces.resize(m_Vertices.GetCapacity(), -1);
+	}
+	std::unordered_map<uint64_t, int32_t> sides((faces.size() * 3 + neighbours.size()) * 2);
+	std::unordered_map<uint64_t, int32_t> edgeSlots((edges.size() + neighbours.size()) * 2);
+	for (int32_t side : neighbours) {
+		if (side == -1) {
+			continue;
+		}
+		const Face& face = m_Faces[side / 3];
+		int32_t start = s_FaceVertex(face, side % 3), end = s_FaceVertex(face, (side % 3 + 1) % 3);
+		m_FaceTwins[side] = -1;
+		sides[s_SideKey(start, end)] = side;
+		edgeSlots.emplace(s_EdgeKey(start, end), m_FaceEdges[side]);
+	}
+	for (int32_t face : faces) {
+		for (int32_t corner = 0; corner < 3; corner++) {
+			int32_t start = s_FaceVertex(m_Faces[face], corner), end = s_FaceVertex(m_Faces[face], (corner + 1) % 3);
+			m_FaceTwins[face * 3 + corner] = -1;
+			m_FaceEdges[face * 3 + corner] = -1;
+			m_VertexFaces[start] = face;
+			sides[s_SideKey(start, end)] = face * 3 + corner;
+		}
+	}
+	for (int32_t edge : edges) {
+		if (edge != -1) {
+			edgeSlots.emplace(s_EdgeKey(m_Edges[edge].m_Start, m_Edges[edge].m_End), edge);
+		}
+	}
+	for (int32_t face : faces) {
+		for (int32_t corner = 0; corner < 3; corner++) {
+			if (m_FaceEdges[face * 3 + corner] != -1) {
+				continue;
+			}
+			int32_t start = s_FaceVertex(m_Faces[face], corner), end = s_FaceVertex(m_Faces[face], (corner + 1) % 3);
+			auto twin = sides.find(s_SideKey(end, start));
+			auto found = edgeSlots.find(s_EdgeKey(start, end));
+			int32_t edge = (found != edgeSlots.end()) ? found->second : (int32_t)m_Edges.Append(Edge(start, end));
+			SetSide(face, corner, (twin != sides.end()) ? twin->second : -1, edge);
+		}
+	}
+	m_LastFace = faces.empty() ? m_LastFace : faces.back();
+	m_TopologyDirty = false;
+}
+
+plg::Mesh::Location plg::Mesh::ClassifyPoint(int32_t face, Vec2 point, int32_t firstSide, int32_t* side) {
+	const Face& target = m_Faces[face];
+	Vec2 corners[3] = { m_Vertices[target.m_Vert1], m_Vertices[target.m_Vert2], m_Vertices[target.m_Vert3] };
+	int32_t onSide = -1;
+	for (int32_t offset = 0; offset < 3; offset++) {
+		int32_t corner = (firstSide + offset) % 3;
+		double orient = s_Orient(corners[corner], corners[(corner + 1) % 3], point);
+		if (orient < 0.0) {
+			*side = corner;
+			return Location::OUTSIDE;
+		}
+		if (orient == 0.0) {
+			onSide = corner;
+		}
+	}
+	if (onSide == -1) {
+		return Location::INSIDE;
+	}
+	for (int32_t corner = 0; corner < 3; corner++) {
+		if (corners[corner].x == point.x && corners[corner].y == point.y) {
+			*side = corner;
+			return Location::VERTEX;
+		}
+	}
+	*side = onSide;
+	return Location::EDGE;
+}
+
+plg::Mesh::Location plg::Mesh::LocateFace(Vec2 point, int32_t* face, int32_t* side) {
+	int32_t current = m_LastFace;
+	if (current < 0 || (size_t)current >= m_Faces.GetCapacity() || m_Faces.IsEmptySlot(current)) {
+		current = (int32_t)m_Faces.Begin().GetIndex();
+	}
+	// Leaving through a different side first on every step keeps the walk from circling
+	// on meshes that were dragged out of Delaunay shape.
+	size_t limit = m_Faces.GetSize() + 8;
+	for (size_t step = 0; step < limit; step++) {
+		Location location = ClassifyPoint(current, point, (int32_t)(step % 3), side);
+		if (location != Location::OUTSIDE) {
+			*face = current;
+			return location;
+		}
+		int32_t twin = m_FaceTwins[current * 3 + *side];
+		if (twin == -1) {
+			*face = current;
+			return location;
+		}
+		current = twin / 3;
+	}
+	// The walk got lost on a tangled mesh; fall back to testing every face.
+	int32_t hullFace = -1, hullSide = -1;
+	for (auto target = m_Faces.Begin(); target < target.end_ptr; target++) {
+		int32_t slot = (int32_t)target.GetIndex();
+		Location location = ClassifyPoint(slot, point, 0, side);
+		if (location != Location::OUTSIDE) {
+			*face = slot;
+			return location;
+		}
+		for (int32_t corner = 0; corner < 3 && hullFace == -1; corner++) {
+			if (m_FaceTwins[slot * 3 + corner] == -1 &&
+				s_Orient(m_Vertices[s_FaceVertex(*target, corner)], m_Vertices[s_FaceVertex(*target, (corner + 1) % 3)], point) < 0.0) {
+				hullFace = slot;
+				hullSide = corner;
+			}
+		}
+	}
+	*face = hullFace;
+	*side = hullSide;
+	return Location::OUTSIDE;
+}
+
+void plg::Mesh::SplitFace(int32_t face, int32_t vertex) {
+	FaceSides old = ReadFace(face, 0);
+	int32_t vertA = old.vertex[0], vertB = old.vertex[1], vertC = old.vertex[2];
+	int32_t edgeA = (int32_t)m_Edges.Append(Edge(vertex, vertA));
+	int32_t edgeB = (int32_t)m_Edges.Append(Edge(vertex, vertB));
+	int32_t edgeC = (int32_t)m_Edges.Append(Edge(vertex, vertC));
+	m_Faces[face] = Face(vertA, vertB, vertex);
+	int32_t second = NewFace(vertB, vertC, vertex);
+	int32_t third = NewFace(vertC, vertA, vertex);
+	InheritMaterial(second, face);
+	InheritMaterial(third, face);
+	SetSide(face, 0, old.twin[0], old.edge[0]);
+	SetSide(second, 0, old.twin[1], old.edge[1]);
+	SetSide(third, 0, old.twin[2], old.edge[2]);
+	SetSide(second, 2, face * 3 + 1, edgeB);
+	SetSide(third, 2, second * 3 + 1, edgeC);
+	SetSide(face, 2, third * 3 + 1, edgeA);
+	m_VertexFaces[vertA] = face;
+	m_VertexFaces[vertB] = face;
+	m_VertexFaces[vertC] = second;
+	m_VertexFaces[vertex] = face;
+	m_LegalizeStack.push_back(face * 3);
+	m_LegalizeStack.push_back(second * 3);
+	m_LegalizeStack.push_back(third * 3);
+	m_LastFace = face;
+}
+
+void plg::Mesh::SplitEdge(int32_t face, int32_t side, int32_t vertex) {
+	FaceSides near = ReadFace(face, side);
+	int32_t vertA = near.vertex[0], vertB = near.vertex[1], vertC = near.vertex[2];
+	int32_t edgeC = (int32_t)m_Edges.Append(Edge(vertex, vertC));
+	int32_t edgeB = (int32_t)m_Edges.Append(Edge(vertex, vertB));
+	m_Edges[near.edge[0]] = Edge(vertA, vertex);
+	int32_t twin = near.twin[0];
+	FaceSides far;
+	if (twin != -1) {
+		far = ReadFace(twin / 3, twin % 3);
+	}
+	m_Faces[face] = Face(vertA, vertex, vertC);
+	int32_t second = NewFace(vertex, vertB, vertC);
+	InheritMaterial(second, face);
+	SetSide(face, 2, near.twin[2], near.edge[2]);
+	SetSide(second, 1, near.twin[1], near.edge[1]);
+	SetSide(second, 2, face * 3 + 1, edgeC);
+	m_VertexFaces[vertA] = face;
+	m_VertexFaces[vertB] = second;
+	m_VertexFaces[vertC] = face;
+	m_VertexFaces[vertex] = face;
+	m_LegalizeStack.push_back(face * 3 + 2);
+	m_LegalizeStack.push_back(second * 3 + 1);
+	m_LastFace = face;
+	if (twin == -1) {
+		SetSide(face, 0, -1, near.edge[0]);
+		SetSide(second, 0, -1, edgeB);
+		return;
+	}
+	// The face across the edge is split the same way and the four halves are stitched.
+	int32_t third = twin / 3, vertD = far.vertex[2];
+	int32_t edgeD = (int32_t)m_Edges.Append(Edge(vertex, vertD));
+	m_Faces[third] = Face(vertB, vertex, vertD);
+	int32_t fourth = NewFace(vertex, vertA, vertD);
+	InheritMaterial(fourth, third);
+	SetSide(third, 0, second * 3, edgeB);
+	SetSide(third, 2, far.twin[2], far.edge[2]);
+	SetSide(fourth, 0, face * 3, near.edge[0]);
+	SetSide(fourth, 1, far.twin[1], far.edge[1]);
+	SetSide(fourth, 2, third * 3 + 1, edgeD);
+	m_VertexFaces[vertD] = third;
+	m_LegalizeStack.push_back(third * 3 + 2);
+	m_LegalizeStack.push_back(fourth * 3 + 1);
+}
+
+void plg::Mesh::ExtendHull(int32_t face, int32_t side, int32_t vertex) {
+	// Collects the run of hull sides the point can see, walking both ways from the first.
+	int32_t first = face * 3 + side, last = first;
+	for (;;) {
+		int32_t corner = (first % 3 + 2) % 3, target = first / 3;
+		while (m_FaceTwins[target * 3 + corner] != -1) {
+			int32_t twin = m_FaceTwins[target * 3 + corner];
+			target = twin / 3;
+			corner = (twin % 3 + 2) % 3;
+		}
+		int32_t previous = target * 3 + corner;
+		if (previous == last || s_Orient(m_Vertices[s_FaceVertex(m_Faces[target], corner)], m_Vertices[s_FaceVertex(m_Faces[target], (corner + 1) % 3)], m_Vertices[vertex]) >= 0.0) {
+			break;
+		}
+		first = previous;
+	}
+	m_LegalizeStack.push_back(first);
+	int32_t hull = first;
+	for (;;) {
+		int32_t corner = (hull % 3 + 1) % 3, target = hull / 3;
+		while (m_FaceTwins[target * 3 + corner] != -1) {
+			int32_t twin = m_FaceTwins[target * 3 + corner];
+			target = twin / 3;
+			corner = (twin % 3 + 1) % 3;
+		}
+		int32_t next = target * 3 + corner;
+		if (next == first || s_Orient(m_Vertices[s_FaceVertex(m_Faces[target], corner)], m_Vertices[s_FaceVertex(m_Faces[target], (corner + 1) % 3)], m_Vertices[vertex]) >= 0.0) {
+			break;
+		}
+		m_LegalizeStack.push_back(next);
+		hull = next;
+	}
+	// One new face per visible side, fanned from the point and chained to each other.
+	size_t sideCount = m_LegalizeStack.size();
+	int32_t previousFace = -1;
+	int32_t previousEdge = -1;
+	for (size_t index = 0; index < sideCount; index++) {
+		int32_t hullSide = m_LegalizeStack[index];
+		const Face& target = m_Faces[hullSide / 3];
+		int32_t start = s_FaceVertex(target, hullSide % 3), end = s_FaceVertex(target, (hullSide % 3 + 1) % 3);
+		if (previousEdge == -1) {
+			previousEdge = (int32_t)m_Edges.Append(Edge(start, vertex));
+		}
+		int32_t nextEdge = (int32_t)m_Edges.Append(Edge(vertex, end));
+		int32_t added = NewFace(end, start, vertex);
+		SetSide(added, 0, hullSide, m_FaceEdges[hullSide]);
+		SetSide(added, 1, (previousFace != -1) ? previousFace * 3 + 2 : -1, previousEdge);
+		SetSide(added, 2, -1, nextEdge);
+		m_LegalizeStack[index] = added * 3;
+		previousFace = added;
+		previousEdge = nextEdge;
+		if (index == 0) {
+			m_VertexFaces[vertex] = added;
+			m_LastFace = added;
+		}
+	}
+}
+
+void plg::Mesh::RemoveStar(int32_t vertex, int32_t face) {
+	// Rewinds to the first face of the fan, which is where it opens on the hull if it does.
+	int32_t first = face, corner = s_FaceCorner(m_Faces[face], vertex);
+	bool closed = true;
+	size_t limit = m_Faces.GetSize();
+	for (size_t step = 0; step < limit; step++) {
+		int32_t twin = m_FaceTwins[first * 3 + corner];
+		if (twin == -1) {
+			closed = false;
+			break;
+		}
+		first = twin / 3;
+		corner = (twin % 3 + 1) % 3;
+		if (first == face) {
+			break;
+		}
+	}
+	// The link of the vertex as a ring (or an open chain on the hull), each link remembering
+	// the outside side and edge it borders.
+	std::vector<int32_t> ring, linkTwins, linkEdges, fan, spokes;
+	int32_t current = first;
+	for (size_t step = 0; step <= limit; step++) {
+		FaceSides sides = ReadFace(current, corner);
+		if (ring.empty()) {
+			ring.push_back(sides.vertex[1]);
+			if (!closed) {
+				spokes.push_back(sides.edge[0]);
+			}
+		}
+		ring.push_back(sides.vertex[2]);
+		linkTwins.push_back(sides.twin[1]);
+		linkEdges.push_back(sides.edge[1]);
+		spokes.push_back(sides.edge[2]);
+		fan.push_back(current);
+		if (sides.twin[2] == -1) {
+			break;
+		}
+		current = sides.twin[2] / 3;
+		corner = sides.twin[2] % 3;
+		if (current == first) {
+			break;
+		}
+	}
+	if (closed) {
+		ring.pop_back();
+	}
+	// Faces filling the hole are painted like the fan face whose link they take over.
+	std::vector<MaterialID> linkMaterials;
+	if (!m_FaceMaterials.empty()) {
+		for (int32_t target : fan) {
+			linkMaterials.push_back(GetFaceMaterial(target));
+		}
+	}
+	for (int32_t target : fan) {
+		m_Faces.Remove((size_t)target);
+		if ((size_t)target < m_FaceMaterials.size()) {
+			m_FaceMaterials[target] = MaterialLibrary::DEFAULT_MATERIAL;
+		}
+	}
+	for (int32_t edge : spokes) {
+		m_Edges.Remove((size_t)edge);
+	}
+	for (int32_t target : ring) {
+		m_VertexFaces[target] = -1;
+	}
+	m_LastFace = -1;
+	for (size_t link = 0; link < linkTwins.size(); link++) {
+		if (linkTwins[link] != -1) {
+			m_VertexFaces[ring[link]] = linkTwins[link] / 3;
+			m_VertexFaces[ring[(link + 1) % ring.size()]] = linkTwins[link] / 3;
+			m_LastFace = linkTwins[link] / 3;
+		}
+	}
+
+	// Clips ears whose circumcircle holds no other link vertex; those are exactly the faces a
+	// full Delaunay pass would put in the hole. An open chain stops once it is convex.
+	while (ring.size() > 3 || (!closed && ring.size() == 3)) {
+		size_t count = ring.size();
+		size_t candidates = closed ? count : count - 2;
+		size_t ear = count, fallback = count;
+		for (size_t candidate = 0; candidate < candidates && ear == count; candidate++) {
+			Vec2 vert1 = m_Vertices[ring[candidate]], vert2 = m_Vertices[ring[(candidate + 1) % count]], vert3 = m_Vertices[ring[(candidate + 2) % count]];
+			if (s_Orient(vert1, vert2, vert3) <= 0.0) {
+				continue;
+			}
+			if (fallback == count) {
+				fallback = candidate;
+			}
+			bool empty = true;
+			for (size_t other = 0; other < count && empty; other++) {
+				if (other != candidate && other != (candidate + 1) % count && other != (candidate + 2) % count) {
+					empty = s_InCircle(vert1, vert2, vert3, m_Vertices[ring[other]]) <= 0.0;
+				}
+			}
+			if (empty) {
+				ear = candidate;
+			}
+		}
+		if (ear == count) {
+			ear = fallback;
+		}
+		if (ear == count) {
+			break;
+		}
+		size_t middle = (ear + 1) % count, last = (ear + 2) % count;
+		int32_t added = NewFace(ring[ear], ring[middle], ring[last]);
+		int32_t edge = (int32_t)m_Edges.Append(Edge(ring[last], ring[ear]));
+		SetSide(added, 0, linkTwins[ear], linkEdges[ear]);
+		SetSide(added, 1, linkTwins[middle], linkEdges[middle]);
+		SetSide(added, 2, -1, edge);
+		m_VertexFaces[ring[ear]] = added;
+		m_VertexFaces[ring[middle]] = added;
+		m_VertexFaces[ring[last]] = added;
+		m_LegalizeStack.push_back(added * 3);
+		m_LegalizeStack.push_back(added * 3 + 1);
+		m_LastFace = added;
+		if (!linkMaterials.empty()) {
+			SetFaceMaterial(added, linkMaterials[ear]);
+			linkMaterials.erase(linkMaterials.begin() + middle);
+		}
+		linkTwins[ear] = added * 3 + 2;
+		linkEdges[ear] = edge;
+		ring.erase(ring.begin() + middle);
+		linkTwins.erase(linkTwins.begin() + middle);
+		linkEdges.erase(linkEdges.begin() + middle);
+	}
+	if (closed && ring.size() == 3) {
+		int32_t added = NewFace(ring[0], ring[1], ring[2]);
+		if (!linkMaterials.empty()) {
+			SetFaceMaterial(added, linkMaterials[0]);
+		}
+		for (int32_t corner = 0; corner < 3; corner++) {
+			SetSide(added, corner, linkTwins[corner], linkEdges[corner]);
+			m_VertexFaces[ring[corner]] = added;
+			m_LegalizeStack.push_back(added * 3 + corner);
+		}
+		m_LastFace = added;
+		return;
+	}
+	// What is left of an open chain is the new hull; links with nothing behind them go away.
+	for (size_t link = 0; link < linkTwins.size(); link++) {
+		if (linkTwins[link] != -1) {
+			m_FaceTwins[linkTwins[link]] = -1;
+		}
+		else {
+			m_Edges.Remove((size_t)linkEdges[link]);
+		}
+	}
+}
+
+void plg::Mesh::FlipEdge(int32_t side) {
+	// Both faces keep their slots and so their materials; the two halves of a split face
+	// share one, so only a flip across a material border can move it.
+	int32_t face = side / 3, twin = m_FaceTwins[side], other = twin / 3;
+	FaceSides near = ReadFace(face, side % 3), far = ReadFace(other, twin % 3);
+	int32_t vertA = near.vertex[0], vertB = near.vertex[1], vertC = near.vertex[2], vertD = far.vertex[2];
+	int32_t edge = near.edge[0];
+	m_Edges[edge] = Edge(vertC, vertD);
+	m_Faces[face] = Face(vertC, vertA, vertD);
+	m_Faces[other] = Face(vertD, vertB, vertC);
+	SetSide(face, 0, near.twin[2], near.edge[2]);
+	SetSide(face, 1, far.twin[1], far.edge[1]);
+	SetSide(other, 0, far.twin[2], far.edge[2]);
+	SetSide(other, 1, near.twin[1], near.edge[1]);
+	SetSide(face, 2, other * 3 + 2, edge);
+	m_VertexFaces[vertA] = face;
+	m_VertexFaces[vertC] = face;
+	m_VertexFaces[vertD] = face;
+	m_VertexFaces[vertB] = other;
+	m_LegalizeStack.push_back(face * 3);
+	m_LegalizeStack.push_back(face * 3 + 1);
+	m_LegalizeStack.push_back(other * 3);
+	m_LegalizeStack.push_back(other * 3 + 1);
+}
+
+void plg::Mesh::Legalize() {
+	while (!m_LegalizeStack.empty()) {
+		int32_t side = m_LegalizeStack.back();
+		m_LegalizeStack.pop_back();
+		int32_t twin = m_FaceTwins[side];
+		if (twin == -1) {
+			continue;
+		}
+		FaceSides near = ReadFace(side / 3, side % 3);
+		int32_t vertD = s_FaceVertex(m_Faces[twin / 3], (twin % 3 + 2) % 3);
+		if (s_InCircle(m_Vertices[near.vertex[0]], m_Vertices[near.vertex[1]], m_Vertices[near.vertex[2]], m_Vertices[vertD]) > 0.0) {
+			FlipEdge(side);
+		}
+	}
 }
 
 void plg::Mesh::RotateEdge(Edge edge, float angle) {
@@ -330,44 +1513,196 @@ plg::Vec2 plg::Mesh::GetFaceCenter(Face face) {
 	return center / 3;
 }
 
+const plg::Vertex* plg::Mesh::GetDrawnDeformation() {
+	if (m_DeformedVertices.size() < m_Vertices.GetCapacity()) {
+		return nullptr;
+	}
+	return m_DeformedVertices.data();
+}
+
 void plg::Mesh::Render(SDL_Renderer* renderer, Vec2 offset) {
+	Render(renderer, Affine2D::Translation(offset));
+}
+
+void plg::Mesh::Render(SDL_Renderer* renderer, const Affine2D& world) {
+	Vec2* positions = container::frameArena.AllocateArray<Vec2>(m_Vertices.GetCapacity());
+	const Vertex* deformed = GetDrawnDeformation();
+	if (deformed != nullptr) {
+		m_Vertices.ForEach([&](Vertex&, size_t index) {
+			positions[index] = world.Apply(deformed[index]);
+		});
+	}
+	else {
+		m_Vertices.ForEach([&](Vertex& vertex, size_t index) {
+			positions[index] = world.Apply(vertex);
+		});
+	}
+	if (!m_FaceMaterials.empty()) {
+		RenderMaterials(renderer, positions, materialLibrary);
+	}
+	// A simplified level stands in for the full mesh once its error is under a pixel on
+	// screen; selections are still drawn from the full mesh.
+	const LODLevel* level = nullptr;
+	if (m_LOD != nullptr && m_LOD->GetRevision() == m_Revision) {
+		size_t levelIndex = m_LOD->SelectLevel(sqrtf(fabsf(world.a * world.d - world.b * world.c)));
+		if (levelIndex > 0) {
+			level = &m_LOD->GetLevel(levelIndex);
+		}
+	}
 	SDL_SetRenderDrawColor(renderer, 76, 156, 216, SDL_ALPHA_OPAQUE);
-	for (auto it_edge = m_Edges.Begin(); it_edge < it_edge.end_ptr; it_edge++) {
-		SDL_RenderDrawLine(renderer, (int)it_edge->GetStart(&m_Vertices).x, (int)it_edge->GetStart(&m_Vertices).y, (int)it_edge->GetEnd(&m_Vertices).x, (int)it_edge->GetEnd(&m_Vertices).y);
+	if (level != nullptr) {
+		for (const Edge& edge : level->edges) {
+			SDL_RenderDrawLine(renderer, (int)positions[edge.m_Start].x, (int)positions[edge.m_Start].y, (int)positions[edge.m_End].x, (int)positions[edge.m_End].y);
+		}
+	}
+	else {
+		for (auto it_edge = m_Edges.Begin(); it_edge < it_edge.end_ptr; it_edge++) {
+			Vec2 start = positions[it_edge->m_Start];
+			Vec2 end = positions[it_edge->m_End];
+			SDL_RenderDrawLine(renderer, (int)start.x, (int)start.y, (int)end.x, (int)end.y);
+		}
 	}
 	if (sceneMeshData.GetMode() == MeshMode::PLG_EDGE) {
 		SDL_SetRenderDrawColor(renderer, 216, 116, 56, SDL_ALPHA_OPAQUE);
 		for (auto edge_it = sceneMeshData.GetEdgeIter(); edge_it < edge_it.end_ptr; edge_it++) {
 			Edge edge = m_Edges[*edge_it];
-			SDL_RenderDrawLine(renderer, (int)m_Vertices[edge.m_Start].x, (int)m_Vertices[edge.m_Start].y, (int)m_Vertices[edge.m_End].x, (int)m_Vertices[edge.m_End].y);
+			SDL_RenderDrawLine(renderer, (int)positions[edge.m_Start].x, (int)positions[edge.m_Start].y, (int)positions[edge.m_End].x, (int)positions[edge.m_End].y);
 		}
 	}
 	else if (sceneMeshData.GetMode() == MeshMode::PLG_VERTEX) {
-		for (auto it_vertex = m_Vertices.Begin(); it_vertex < it_vertex.end_ptr; it_vertex++) {
-			drawCircleFilled(renderer, it_vertex->x, it_vertex->y, 2, { 216, 216, 216, SDL_ALPHA_OPAQUE });
+		if (level != nullptr) {
+			for (int32_t vertex : level->vertices) {
+				drawCircleFilled(renderer, positions[vertex].x, positions[vertex].y, 2, { 216, 216, 216, SDL_ALPHA_OPAQUE });
+			}
+		}
+		else {
+			for (auto it_vertex = m_Vertices.Begin(); it_vertex < it_vertex.end_ptr; it_vertex++) {
+				Vec2 vertex = positions[it_vertex.GetIndex()];
+				drawCircleFilled(renderer, vertex.x, vertex.y, 2, { 216, 216, 216, SDL_ALPHA_OPAQUE });
+			}
 		}
 		for (auto vertex_it = sceneMeshData.GetVertexIter(); vertex_it < vertex_it.end_ptr; vertex_it++) {
-			Vec2 vertex = m_Vertices[*vertex_it];
+			Vec2 vertex = positions[*vertex_it];
 			drawCircleFilled(renderer, vertex.x, vertex.y, 2, { 216, 116, 56, SDL_ALPHA_OPAQUE });
 		}
 	}
 	else if (sceneMeshData.GetMode() == MeshMode::PLG_FACE) {
-		for (auto it_face = m_Faces.Begin(); it_face < it_face.end_ptr; it_face++) {
-			drawPolygon(renderer, { m_Vertices[it_face->m_Vert1], m_Vertices[it_face->m_Vert2], m_Vertices[it_face->m_Vert3] }, { 20, 20, 20, SDL_ALPHA_OPAQUE });
-			drawRawPolygon(renderer, { m_Vertices[it_face->m_Vert1], m_Vertices[it_face->m_Vert2], m_Vertices[it_face->m_Vert3] }, { 216, 216, 216, SDL_ALPHA_OPAQUE });
-			Vec2 center = GetFaceCenter(*it_face);
+		auto drawFace = [&](const Face& face) {
+			Vec2 vert1 = positions[face.m_Vert1], vert2 = positions[face.m_Vert2], vert3 = positions[face.m_Vert3];
+			drawPolygon(renderer, { vert1, vert2, vert3 }, { 20, 20, 20, SDL_ALPHA_OPAQUE });
+			drawRawPolygon(renderer, { vert1, vert2, vert3 }, { 216, 216, 216, SDL_ALPHA_OPAQUE });
+			Vec2 center = (vert1 + vert2 + vert3) / 3;
 			drawCircleFilled(renderer, center.x, center.y, 2, { 216, 216, 216, SDL_ALPHA_OPAQUE });
+		};
+		if (level != nullptr) {
+			for (const Face& face : level->faces) {
+				drawFace(face);
+			}
+		}
+		else {
+			for (auto it_face = m_Faces.Begin(); it_face < it_face.end_ptr; it_face++) {
+				drawFace(*it_face);
+			}
 		}
 		for (auto face_it = sceneMeshData.GetFaceIter(); face_it < face_it.end_ptr; face_it++) {
 			Face face = m_Faces[*face_it];
-			drawPolygon(renderer, { m_Vertices[face.m_Vert1], m_Vertices[face.m_Vert2], m_Vertices[face.m_Vert3] }, { 36, 30, 20, SDL_ALPHA_OPAQUE });
-			drawRawPolygon(renderer, { m_Vertices[face.m_Vert1], m_Vertices[face.m_Vert2], m_Vertices[face.m_Vert3] }, { 216, 116, 56, SDL_ALPHA_OPAQUE });
-			Vec2 center = GetFaceCenter(face);
+			Vec2 vert1 = positions[face.m_Vert1], vert2 = positions[face.m_Vert2], vert3 = positions[face.m_Vert3];
+			drawPolygon(renderer, { vert1, vert2, vert3 }, { 36, 30, 20, SDL_ALPHA_OPAQUE });
+			drawRawPolygon(renderer, { vert1, vert2, vert3 }, { 216, 116, 56, SDL_ALPHA_OPAQUE });
+			Vec2 center = (vert1 + vert2 + vert3) / 3;
 			drawCircleFilled(renderer, center.x, center.y, 2, { 216, 116, 56, SDL_ALPHA_OPAQUE });
 		}
 	}
 }
 
+void plg::Mesh::SetFaceMaterial(int32_t face, MaterialID material) {
+	if (face < 0 || (size_t)face >= m_Faces.GetCapacity() || m_Faces.IsEmptySlot(face)) {
+		Log("Warning! Face does not exist.", true);
+		return;
+	}
+	if (m_FaceMaterials.size() < m_Faces.GetCapacity()) {
+		m_FaceMaterials.resize(m_Faces.GetCapacity(), MaterialLibrary::DEFAULT_MATERIAL);
+	}
+	m_FaceMaterials[face] = material;
+}
+
+plg::MaterialID plg::Mesh::GetFaceMaterial(int32_t face) const {
+	return (face >= 0 && (size_t)face < m_FaceMaterials.size()) ? m_FaceMaterials[face] : MaterialLibrary::DEFAULT_MATERIAL;
+}
+
+void plg::Mesh::RenderMaterials(SDL_Renderer* renderer, const Affine2D& world, const MaterialLibrary& library) {
+	Vec2* positions = container::frameArena.AllocateArray<Vec2>(m_Vertices.GetCapacity());
+	const Vertex* deformed = GetDrawnDeformation();
+	m_Vertices.ForEach([&](Vertex& vertex, size_t index) {
+		positions[index] = world.Apply((deformed != nullptr) ? deformed[index] : vertex);
+	});
+	RenderMaterials(renderer, positions, library);
+}
+
+void plg::Mesh::RenderMaterials(SDL_Renderer* renderer, const Vec2* positions, const MaterialLibrary& library) {
+	m_MaterialBatchCount = 0;
+	size_t faceCount = m_Faces.GetSize();
+	if (faceCount == 0) {
+		return;
+	}
+	// Counting sort of the faces by material, unknown ids falling back to the default.
+	size_t materialCount = library.GetMaterialCount();
+	size_t* offsets = container::frameArena.AllocateArray<size_t>(materialCount + 1);
+	size_t* cursors = container::frameArena.AllocateArray<size_t>(materialCount);
+	std::fill(offsets, offsets + materialCount + 1, (size_t)0);
+	auto materialOf = [&](size_t face) {
+		MaterialID material = GetFaceMaterial((int32_t)face);
+		return library.IsValid(material) ? (size_t)material : (size_t)MaterialLibrary::DEFAULT_MATERIAL;
+	};
+	for (auto face_it = m_Faces.Begin(); face_it < face_it.end_ptr; face_it++) {
+		offsets[materialOf(face_it.GetIndex()) + 1]++;
+	}
+	for (size_t material = 0; material < materialCount; material++) {
+		offsets[material + 1] += offsets[material];
+		cursors[material] = offsets[material];
+	}
+	SDL_Vertex* vertices = container::frameArena.AllocateArray<SDL_Vertex>(faceCount * 3);
+	bool hasUVs = m_UVs.size() >= m_Vertices.GetCapacity();
+	for (auto face_it = m_Faces.Begin(); face_it < face_it.end_ptr; face_it++) {
+		size_t material = materialOf(face_it.GetIndex());
+		SDL_Vertex* corners = vertices + cursors[material]++ * 3;
+		const int32_t faceVertices[3] = { face_it->m_Vert1, face_it->m_Vert2, face_it->m_Vert3 };
+		SDL_Color color = library.GetMaterial((MaterialID)material).color;
+		for (size_t corner = 0; corner < 3; corner++) {
+			int32_t vertex = faceVertices[corner];
+			corners[corner].position = { positions[vertex].x, positions[vertex].y };
+			corners[corner].color = color;
+			corners[corner].tex_coord = hasUVs ? SDL_FPoint{ m_UVs[vertex].x, m_UVs[vertex].y } : SDL_FPoint{ 0.0f, 0.0f };
+		}
+	}
+	// Untextured batches blend with the renderer's draw blend mode, which is put back after.
+	SDL_BlendMode drawBlendMode;
+	SDL_GetRenderDrawBlendMode(renderer, &drawBlendMode);
+	SDL_BlendMode currentBlendMode = drawBlendMode;
+	for (size_t material = 0; material < materialCount; material++) {
+		size_t begin = offsets[material], count = offsets[material + 1] - begin;
+		if (count == 0) {
+			continue;
+		}
+		const Material& settings = library.GetMaterial((MaterialID)material);
+		if (settings.texture != nullptr) {
+			SDL_BlendMode textureBlendMode;
+			if (SDL_GetTextureBlendMode(settings.texture, &textureBlendMode) != 0 || textureBlendMode != settings.blendMode) {
+				SDL_SetTextureBlendMode(settings.texture, settings.blendMode);
+			}
+		}
+		else if (currentBlendMode != settings.blendMode) {
+			SDL_SetRenderDrawBlendMode(renderer, settings.blendMode);
+			currentBlendMode = settings.blendMode;
+		}
+		SDL_RenderGeometry(renderer, settings.texture, vertices + begin * 3, (int)(count * 3), NULL, 0);
+		m_MaterialBatchCount++;
+	}
+	if (currentBlendMode != drawBlendMode) {
+		SDL_SetRenderDrawBlendMode(renderer, drawBlendMode);
+	}
+}
+
 bool plg::SceneMeshData::SetMesh(container::List<Mesh>* meshList, Vec2 mousePos) {
 	return true;
 }
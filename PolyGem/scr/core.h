@@ -5,6 +5,11 @@
 #include <memory>
 #include <math.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PLG_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace plg {
 	class Vec2 {
 	public:
@@ -13,8 +18,6 @@ namespace plg {
 
 		Vec2(float xv = 0.0f, float yv = 0.0f) : x(xv), y(yv) {}
 
-		~Vec2() {}
-
 		void Invert() {
 			x = -x;
 			y = -y;
@@ -88,4 +91,35 @@ namespace plg {
 			return stream << "Vec2< " << x << ", " << y << " >";
 		}
 	};
+	// 2D affine matrix, a point maps to (a * x + c * y + tx, b * x + d * y + ty).
+	class Affine2D {
+	public:
+		float a = 1.0f, b = 0.0f, c = 0.0f, d = 1.0f, tx = 0.0f, ty = 0.0f;
+
+		Affine2D() { }
+		Affine2D(float av, float bv, float cv, float dv, float txv, float tyv) : a(av), b(bv), c(cv), d(dv), tx(txv), ty(tyv) { }
+
+		static Affine2D Translation(const Vec2& offset) { return Affine2D(1.0f, 0.0f, 0.0f, 1.0f, offset.x, offset.y); }
+		static Affine2D FromTRS(const Vec2& position, float rotation, const Vec2& scale);
+		Affine2D operator* (const Affine2D& other) const {
+			return Affine2D(a * other.a + c * other.b, b * other.a + d * other.b,
+				a * other.c + c * other.d, b * other.c + d * other.d,
+				a * other.tx + c * other.ty + tx, b * other.tx + d * other.ty + ty);
+		}
+		Vec2 Apply(const Vec2& point) const { return Vec2(a * point.x + c * point.y + tx, b * point.x + d * point.y + ty); }
+		Vec2 ApplyVector(const Vec2& vec) const { return Vec2(a * vec.x + c * vec.y, b * vec.x + d * vec.y); }
+		Affine2D Inverse() const;
+	};
+
+	class Transform2D {
+	public:
+		Vec2 position;
+		float rotation = 0.0f;
+		Vec2 scale = Vec2(1.0f, 1.0f);
+
+		Transform2D() { }
+		Transform2D(Vec2 positionV, float rotationV = 0.0f, Vec2 scaleV = Vec2(1.0f, 1.0f)) : position(positionV), rotation(rotationV), scale(scaleV) { }
+
+		Affine2D ToMatrix() const { return Affine2D::FromTRS(position, rotation, scale); }
+	};
 }
\ No newline at end of file
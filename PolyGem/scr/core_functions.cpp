@@ -1,4 +1,5 @@
 #include "core_functions.h"
+#include "triangulator.h"
 #include <math.h>
 #include <string>
 
@@ -174,36 +175,55 @@ SDL_Surface* downsample2x(SDL_Surface* surface) {
 }
 
 void drawRawPolygon(SDL_Renderer* renderer, std::initializer_list<plg::Vec2> vertex_list, SDL_Color color) {
-	container::List<plg::Vec2> vertices(vertex_list);
+	const plg::Vec2* vertices = vertex_list.begin();
+	size_t vertexCount = vertex_list.size();
 	SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, SDL_ALPHA_OPAQUE);
-	for (int i = 0; i < vertices.GetCapacity(); i++) {
+	for (size_t i = 0; i < vertexCount; i++) {
 		plg::Vec2 vertex_s = vertices[i];
-		plg::Vec2 vertex_e = vertices[(i + 1) % vertices.GetCapacity()];
+		plg::Vec2 vertex_e = vertices[(i + 1) % vertexCount];
 		SDL_RenderDrawLine(renderer, (int)vertex_s.x, (int)vertex_s.y, (int)vertex_e.x, (int)vertex_e.y);
 	}
 }
 
 void drawPolygon(SDL_Renderer* renderer, std::initializer_list<plg::Vec2> vertex_list, SDL_Color color) {
-	container::List<plg::Vec2> vertices(vertex_list);
-	plg::Vec2 topVertex = vertices[0];
-	for (int i = 1; i < vertices.GetCapacity() - 1; i++) {
-		plg::Vec2 vertex = vertices[i];
-		plg::Vec2 _vertex = vertices[i + 1];
-		SDL_Vertex vert[3];
-		vert[0].position.x = topVertex.x;
-		vert[0].position.y = topVertex.y;
-		vert[0].color = color;
-
-		vert[1].position.x = vertex.x;
-		vert[1].position.y = vertex.y;
-		vert[1].color = color;
-		
-		vert[2].position.x = _vertex.x;
-		vert[2].position.y = _vertex.y;
-		vert[2].color = color;
-		
+	drawPolygon(renderer, std::span<const plg::Vec2>(vertex_list.begin(), vertex_list.size()), {}, color);
+}
+
+void drawPolygon(SDL_Renderer* renderer, std::span<const plg::Vec2> vertices, SDL_Color color) {
+	drawPolygon(renderer, vertices, {}, color);
+}
+
+void drawPolygon(SDL_Renderer* renderer, std::span<const plg::Vec2> vertices, std::span<const uint32_t> contour_ends, SDL_Color color) {
+	size_t vertexCount = vertices.size();
+	if (vertexCount < 3) {
+		return;
+	}
+	// Mesh faces come through here one triangle at a time, so those skip the triangulator.
+	if (vertexCount == 3) {
+		SDL_Vertex* vert = container::frameArena.AllocateArray<SDL_Vertex>(3);
+		for (size_t i = 0; i < 3; i++) {
+			vert[i].position.x = vertices[i].x;
+			vert[i].position.y = vertices[i].y;
+			vert[i].color = color;
+		}
 		SDL_RenderGeometry(renderer, NULL, vert, 3, NULL, 0);
+		return;
+	}
+	// Kept between calls so its buffers are only grown, never reallocated per polygon.
+	static plg::Triangulator triangulator;
+	triangulator.TriangulatePolygon(vertices, contour_ends);
+	std::span<const uint32_t> indices = triangulator.GetTriangles();
+	if (indices.empty()) {
+		return;
+	}
+	SDL_Vertex* vert = container::frameArena.AllocateArray<SDL_Vertex>(indices.size());
+	for (size_t i = 0; i < indices.size(); i++) {
+		const plg::Vec2& vertex = vertices[indices[i]];
+		vert[i].position.x = vertex.x;
+		vert[i].position.y = vertex.y;
+		vert[i].color = color;
 	}
+	SDL_RenderGeometry(renderer, NULL, vert, (int)indices.size(), NULL, 0);
 }
 
 void drawLineThickness(SDL_Renderer* renderer, plg::Vec2 start, plg::Vec2 end, int thickness, SDL_Color color) {
@@ -3,6 +3,7 @@
 #include "SDL.h"
 #include "SDL_image.h"
 #include "core.h"
+#include <span>
 
 SDL_Texture* LoadTexture(std::string path, SDL_Renderer* renderer, SDL_Rect* rect);
 SDL_Surface* SDL_CreateSurfaceFromTexture(SDL_Renderer* renderer, SDL_Texture* texture);
@@ -19,4 +20,8 @@ void drawEllipseFilled(SDL_Renderer* renderer, int x0, int y0, int width, int he
 void drawEllipseThickness(SDL_Renderer* renderer, int x0, int y0, int width, int height, int thickness, SDL_Color color);
 void drawRectRound(SDL_Renderer* renderer, SDL_Rect rect, int radius, SDL_Color color);
 void drawRawPolygon(SDL_Renderer* renderer, std::initializer_list<plg::Vec2> vertex_list, SDL_Color color);
-void drawPolygon(SDL_Renderer* renderer, std::initializer_list<plg::Vec2> vertex_list, SDL_Color color);
\ No newline at end of file
+void drawPolygon(SDL_Renderer* renderer, std::initializer_list<plg::Vec2> vertex_list, SDL_Color color);
+// Fills any simple outline, concave ones included. Outlines stored back to back with
+// contour_ends marking where each stops are filled by the even-odd rule, so inner ones are holes.
+void drawPolygon(SDL_Renderer* renderer, std::span<const plg::Vec2> vertices, SDL_Color color);
+void drawPolygon(SDL_Renderer* renderer, std::span<const plg::Vec2> vertices, std::span<const uint32_t> contour_ends, SDL_Color color);
\ No newline at end of file
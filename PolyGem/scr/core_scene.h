@@ -1,19 +1,24 @@
 #pragma once
 #include "core.h"
 #include "SDL.h"
+#include <span>
+#include <vector>
 
 namespace plg {
 	using Vertex = Vec2;
+	using MaterialID = int32_t;
+	class MeshLOD;
+	class MaterialLibrary;
 
 	class Edge {
 	public:
 		Edge() { }
 		Edge(size_t start, size_t end) : m_Start(start), m_End(end) { }
-		Edge(const Edge& other) : m_Start(other.m_Start), m_End(other.m_End) { }
-		Edge(Edge&& other) noexcept : m_Start(other.m_Start), m_End(other.m_End) { }
-		Edge& operator=(const Edge& other);
-		Edge& operator=(Edge&& other) noexcept;
-		~Edge() { }
+		Edge(const Edge& other) = default;
+		Edge(Edge&& other) noexcept = default;
+		Edge& operator=(const Edge& other) = default;
+		Edge& operator=(Edge&& other) noexcept = default;
+		~Edge() = default;
 
 		Vertex& GetStart(container::List<Vertex>* vertexMesh) { return vertexMesh->operator[](m_Start); }
 		Vertex& GetEnd(container::List<Vertex>* vertexMesh) { return vertexMesh->operator[](m_End); }
@@ -37,7 +42,7 @@ namespace plg {
 			m_Vert2 = vert2;
 			m_Vert3 = vert3;
 		}
-		~Face() { }
+		~Face() = default;
 
 	public:
 		int m_Vert1 = -1;
@@ -53,6 +58,10 @@ namespace plg {
 	public:
 		Mesh() { }
 		Mesh(std::initializer_list<Vertex> vertices);
+		// Builds a mesh from bulk buffers with one allocation per list. Edge and face
+		// indices refer to the vertices buffer. When faces are supplied they are used
+		// as given, otherwise the vertices are triangulated if triangulate is set.
+		Mesh(std::span<const Vertex> vertices, std::span<const Edge> edges = {}, std::span<const Face> faces = {}, bool triangulate = true);
 		Mesh(const Mesh& other);
 		Mesh(Mesh&& other) noexcept;
 		Mesh& operator=(const Mesh& other);
@@ -65,6 +74,10 @@ namespace plg {
 		container::ListIterator<container::List<Edge>> GetEdgeIter() { return m_Edges.Begin(); }
 		container::List<Face>* GetFaceList() { return &m_Faces; }
 		container::ListIterator<container::List<Face>> GetFaceIter() { return m_Faces.Begin(); }
+		// Moves on whenever vertices, edges or faces are added or removed through the mesh
+		// and is never shared by two meshes, so data built from a mesh can tell it is out of
+		// date. Edits made straight on the lists above are not seen.
+		uint32_t GetRevision() const { return m_Revision; }
 		void RotateEdge(Edge edge, float angle);
 		void RotateEdge(Edge edge, Vec2 normal);
 		void RotateByCenterEdge(Edge edge, float angle);
@@ -78,12 +91,117 @@ namespace plg {
 		int32_t AddVertex(Vertex object);
 		int32_t AddEdge(Edge object);
 		int32_t AddFace(Face object);
+		// Adds a vertex and keeps the triangulation Delaunay around it: the face under the
+		// point is found by walking from the last face edited, split in place and the
+		// edges around the split are flipped until they are legal again. A point on an
+		// existing vertex returns that vertex.
+		int32_t InsertVertex(Vertex object);
+		// Removes a vertex with its fan of faces and fills the hole with Delaunay ears.
+		bool RemoveVertex(int32_t vertex);
+		// Extrudes edges away from the faces they border, or to their left when they border
+		// none; edges with faces on both sides are skipped. Every vertex of the selection is
+		// copied once, pushed out along the mitred normal of its edges, and each edge is
+		// joined to its copy by two faces. Returns the first new vertex, or -1 when there was
+		// nothing to extrude.
+		int32_t ExtrudeEdges(std::span<const int32_t> edges, float distance);
+		// Lifts the faces by offset and walls their outline back to where it was. Only the
+		// vertices on the outline, read from face adjacency, are copied; those inside move.
+		int32_t ExtrudeFaces(std::span<const int32_t> faces, Vec2 offset);
+		// Chamfers the outline corners where two selected boundary edges meet, cutting up
+		// to width off each of them. Corners the cut would fold are left as they are.
+		// Returns the number of corners bevelled.
+		size_t BevelEdges(std::span<const int32_t> edges, float width);
+		void Reserve(size_t vertexCount, size_t edgeCount, size_t faceCount);
+		int32_t AppendVertices(std::span<const Vertex> vertices);
+		int32_t AppendEdges(std::span<const Edge> edges, int32_t vertexOffset = 0);
+		int32_t AppendFaces(std::span<const Face> faces, int32_t vertexOffset = 0);
 		void Render(SDL_Renderer* renderer, Vec2 offset);
+		void Render(SDL_Renderer* renderer, const Affine2D& world);
+		// Positions drawn in place of the rest vertices, one per vertex slot. The buffer
+		// is owned by the deformer and is not copied with the mesh; an empty span, or one
+		// shorter than the vertex slots after edits added some, draws the rest pose.
+		void SetDeformedVertices(std::span<const Vertex> vertices) { m_DeformedVertices = vertices; }
+		std::span<const Vertex> GetDeformedVertices() const { return m_DeformedVertices; }
+		// Simplified levels drawn in place of the full wireframe when the mesh is small on
+		// screen, as long as they were built from the mesh's current revision. Owned by the
+		// caller and not copied with the mesh, like deformed vertices.
+		void SetLOD(const MeshLOD* lod) { m_LOD = lod; }
+		const MeshLOD* GetLOD() const { return m_LOD; }
+		// Texture coordinates, one per vertex slot, copied with the mesh. Vertices added
+		// later have none until the coordinates are set again.
+		void SetUVs(std::span<const Vec2> uvs) { m_UVs.assign(uvs.begin(), uvs.end()); }
+		std::span<const Vec2> GetUVs() const { return m_UVs; }
+		// Material of every face slot, copied with the mesh. Faces never given one, and
+		// slots freed by removing faces, use the default material.
+		void SetFaceMaterial(int32_t face, MaterialID material);
+		MaterialID GetFaceMaterial(int32_t face) const;
+		bool HasFaceMaterials() const { return !m_FaceMaterials.empty(); }
+		// Fills the faces with their materials: the faces are bucketed by material and each
+		// material is drawn as one geometry batch, so texture and blend mode changes follow
+		// the material count rather than the face count. Render does this before the
+		// wireframe once any face has a material.
+		void RenderMaterials(SDL_Renderer* renderer, const Affine2D& world, const MaterialLibrary& library);
+		// Geometry batches drawn by the last RenderMaterials.
+		size_t GetMaterialBatchCount() const { return m_MaterialBatchCount; }
 		
 	private:
+		enum class Location {
+			INSIDE, EDGE, VERTEX, OUTSIDE
+		};
+
+		// A face read starting from one of its sides, so corner 0 is that side's start.
+		struct FaceSides {
+			int32_t vertex[3];
+			int32_t twin[3];
+			int32_t edge[3];
+		};
+
+		void Triangulate();
+		// Links face sides to their twins and to one shared edge each. Sides are stored as
+		// face * 3 + corner, side corner running from corner to the next one.
+		void BuildTopology();
+		FaceSides ReadFace(int32_t face, int32_t side);
+		// Calls func(face, corner) for every face around the vertex.
+		template<typename T_func>
+		void VisitFan(int32_t vertex, T_func&& func);
+		// The side running from start to end and the one running back, -1 where there is none.
+		void FindEdgeSides(int32_t start, int32_t end, int32_t* forward, int32_t* backward);
+		int32_t NewFace(int32_t vert1, int32_t vert2, int32_t vert3);
+		// Gives a face cut from another the other's material; -1 leaves the default.
+		void InheritMaterial(int32_t face, int32_t parent);
+		void SetSide(int32_t face, int32_t corner, int32_t twin, int32_t edge);
+		// Relinks faces that were added or reshaped in place, when the only sides they can meet
+		// are each other's and the given neighbours'. Sides take an edge from the candidates or a new one.
+		void StitchFaces(std::span<const int32_t> faces, std::span<const int32_t> neighbours, std::span<const int32_t> edges);
+		Location ClassifyPoint(int32_t face, Vec2 point, int32_t firstSide, int32_t* side);
+		Location LocateFace(Vec2 point, int32_t* face, int32_t* side);
+		void SplitFace(int32_t face, int32_t vertex);
+		void SplitEdge(int32_t face, int32_t side, int32_t vertex);
+		void ExtendHull(int32_t face, int32_t side, int32_t vertex);
+		void RemoveStar(int32_t vertex, int32_t face);
+		void FlipEdge(int32_t side);
+		void Legalize();
+		void RenderMaterials(SDL_Renderer* renderer, const Vec2* positions, const MaterialLibrary& library);
+		// Deformed vertices covering every vertex slot, nullptr when the rest pose is drawn.
+		const Vertex* GetDrawnDeformation();
+		static uint32_t NewRevision();
+
 		container::List<Vertex> m_Vertices;
 		container::List<Edge> m_Edges;
 		container::List<Face> m_Faces;
+		std::vector<Vec2> m_UVs;
+		std::vector<MaterialID> m_FaceMaterials;
+		std::span<const Vertex> m_DeformedVertices;
+		const MeshLOD* m_LOD = nullptr;
+		std::vector<int32_t> m_FaceTwins;
+		std::vector<int32_t> m_FaceEdges;
+		std::vector<int32_t> m_VertexFaces;
+		std::vector<int32_t> m_LegalizeStack;
+		int32_t m_LastFace = -1;
+		size_t m_LooseEdgeCount = 0;
+		size_t m_MaterialBatchCount = 0;
+		bool m_TopologyDirty = true;
+		uint32_t m_Revision = NewRevision();
 	};
 
 	class SceneMeshData {
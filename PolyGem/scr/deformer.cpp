@@ -0,0 +1,395 @@
+#include "deformer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+static constexpr size_t s_DeformGrain = 4096;
+static constexpr float s_FlatAmount = 1e-6f;
+
+int32_t plg::DeformerStack::AddDeformer(const DeformerSettings& settings) {
+	m_Stages.emplace_back();
+	m_Stages.back().settings = settings;
+	int32_t deformer = (int32_t)(m_Stages.size() - 1);
+	if (settings.type == DeformerType::LATTICE) {
+		SetLatticeSize(deformer, 2, 2);
+	}
+	MarkDirty((size_t)deformer);
+	return deformer;
+}
+
+void plg::DeformerStack::RemoveDeformer(int32_t deformer) {
+	if (!IsValid(deformer)) {
+		return;
+	}
+	m_Stages.erase(m_Stages.begin() + deformer);
+	MarkDirty((size_t)deformer, true);
+}
+
+void plg::DeformerStack::SetSettings(int32_t deformer, const DeformerSettings& settings) {
+	if (!IsValid(deformer)) {
+		return;
+	}
+	Stage& stage = m_Stages[deformer];
+	bool enabledChanged = stage.settings.enabled != settings.enabled;
+	// The binding holds for as long as the box stays where it is.
+	if (stage.settings.type != settings.type || stage.settings.origin.x != settings.origin.x || stage.settings.origin.y != settings.origin.y ||
+		stage.settings.angle != settings.angle || stage.settings.length != settings.length || stage.settings.width != settings.width) {
+		stage.bound = false;
+	}
+	stage.settings = settings;
+	if (settings.type == DeformerType::LATTICE && stage.columns == 0) {
+		SetLatticeSize(deformer, 2, 2);
+	}
+	MarkDirty((size_t)deformer, enabledChanged);
+}
+
+void plg::DeformerStack::SetEnabled(int32_t deformer, bool enabled) {
+	if (!IsValid(deformer) || m_Stages[deformer].settings.enabled == enabled) {
+		return;
+	}
+	m_Stages[deformer].settings.enabled = enabled;
+	MarkDirty((size_t)deformer, true);
+}
+
+void plg::DeformerStack::SetLatticeSize(int32_t deformer, uint32_t columns, uint32_t rows) {
+	if (!IsValid(deformer)) {
+		return;
+	}
+	if (m_Stages[deformer].settings.type != DeformerType::LATTICE) {
+		Log("Warning! Lattice size set on a deformer that is not a lattice!", true);
+		return;
+	}
+	Stage& stage = m_Stages[deformer];
+	stage.columns = std::clamp(columns, 2u, MAX_LATTICE_SIZE);
+	stage.rows = std::clamp(rows, 2u, MAX_LATTICE_SIZE);
+	stage.offsets.assign((size_t)stage.columns * stage.rows, Vec2());
+	stage.bound = false;
+	MarkDirty((size_t)deformer);
+}
+
+void plg::DeformerStack::SetLatticePoint(int32_t deformer, uint32_t column, uint32_t row, Vec2 position) {
+	if (!IsValid(deformer)) {
+		return;
+	}
+	Stage& stage = m_Stages[deformer];
+	if (column >= stage.columns || row >= stage.rows) {
+		Log("Warning! Lattice point out of range!", true);
+		return;
+	}
+	Vec2 rest = GetLatticeRest(stage, column, row);
+	stage.offsets[(size_t)row * stage.columns + column] = Vec2(position.x - rest.x, position.y - rest.y);
+	MarkDirty((size_t)deformer);
+}
+
+plg::Vec2 plg::DeformerStack::GetLatticePoint(int32_t deformer, uint32_t column, uint32_t row) const {
+	if (!IsValid(deformer)) {
+		return Vec2();
+	}
+	const Stage& stage = m_Stages[deformer];
+	if (column >= stage.columns || row >= stage.rows) {
+		return Vec2();
+	}
+	Vec2 rest = GetLatticeRest(stage, column, row);
+	const Vec2& offset = stage.offsets[(size_t)row * stage.columns + column];
+	return Vec2(rest.x + offset.x, rest.y + offset.y);
+}
+
+void plg::DeformerStack::Deform(Mesh* mesh, bool parallel) {
+	container::List<Vertex>* vertices = mesh->GetVertexList();
+	size_t vertexCount = vertices->GetCapacity();
+	if (vertexCount != m_VertexCount) {
+		m_VertexCount = vertexCount;
+		m_RestX.resize(vertexCount);
+		m_RestY.resize(vertexCount);
+		m_Deformed.resize(vertexCount);
+		m_RestDirty = true;
+	}
+	bool inputChanged = m_RestDirty;
+	if (m_RestDirty) {
+		const Vertex* rest = vertices->GetData();
+		for (size_t index = 0; index < vertexCount; index++) {
+			m_RestX[index] = rest[index].x;
+			m_RestY[index] = rest[index].y;
+		}
+		m_RestDirty = false;
+		m_FirstDirty = 0;
+	}
+	m_EvaluatedCount = 0;
+	if (m_FirstDirty != NO_DIRTY) {
+		auto forRange = [&](auto&& func) {
+			if (parallel) {
+				container::GetThreadPool().ParallelFor(vertexCount, s_DeformGrain, func);
+			}
+			else {
+				func(0, vertexCount);
+			}
+		};
+		// Stages above the first dirty one are up to date, so the last enabled one among
+		// them feeds the rest of the chain.
+		const float* inputX = m_RestX.data();
+		const float* inputY = m_RestY.data();
+		size_t firstDirty = std::min(m_FirstDirty, m_Stages.size());
+		for (size_t index = 0; index < firstDirty; index++) {
+			if (m_Stages[index].settings.enabled) {
+				inputX = m_Stages[index].x.data();
+				inputY = m_Stages[index].y.data();
+			}
+		}
+		for (size_t index = firstDirty; index < m_Stages.size(); index++) {
+			Stage& stage = m_Stages[index];
+			if (!stage.settings.enabled) {
+				continue;
+			}
+			stage.x.resize(vertexCount);
+			stage.y.resize(vertexCount);
+			if (stage.settings.type == DeformerType::LATTICE && (inputChanged || !stage.bound)) {
+				stage.cells.resize(vertexCount);
+				for (std::vector<float>& weights : stage.weights) {
+					weights.resize(vertexCount);
+				}
+				forRange([&](size_t begin, size_t end) {
+					Bind(stage, inputX, inputY, begin, end);
+				});
+				stage.bound = true;
+			}
+			forRange([&](size_t begin, size_t end) {
+				Evaluate(stage, inputX, inputY, begin, end);
+			});
+			inputX = stage.x.data();
+			inputY = stage.y.data();
+			inputChanged = true;
+			m_EvaluatedCount++;
+		}
+		Vertex* deformed = m_Deformed.data();
+		forRange([&](size_t begin, size_t end) {
+			for (size_t index = begin; index < end; index++) {
+				deformed[index] = Vertex(inputX[index], inputY[index]);
+			}
+		});
+		m_FirstDirty = NO_DIRTY;
+	}
+	mesh->SetDeformedVertices(m_Deformed);
+}
+
+bool plg::DeformerStack::IsValid(int32_t deformer) const {
+	if (deformer < 0 || (size_t)deformer >= m_Stages.size()) {
+		Log("Warning! Deformer does not exist!", true);
+		return false;
+	}
+	return true;
+}
+
+void plg::DeformerStack::MarkDirty(size_t stage, bool unbind) {
+	m_FirstDirty = std::min(m_FirstDirty, stage);
+	if (unbind) {
+		for (size_t index = stage; index < m_Stages.size(); index++) {
+			m_Stages[index].bound = false;
+		}
+	}
+}
+
+plg::Vec2 plg::DeformerStack::GetLatticeRest(const Stage& stage, uint32_t column, uint32_t row) const {
+	const DeformerSettings& settings = stage.settings;
+	float u = settings.length * (float)column / (float)(stage.columns - 1);
+	float v = settings.width * (float)row / (float)(stage.rows - 1);
+	float cosine = cosf(settings.angle);
+	float sine = sinf(settings.angle);
+	return Vec2(settings.origin.x + u * cosine - v * sine, settings.origin.y + u * sine + v * cosine);
+}
+
+void plg::DeformerStack::Bind(Stage& stage, const float* inputX, const float* inputY, size_t begin, size_t end) {
+	const DeformerSettings& settings = stage.settings;
+	float cosine = cosf(settings.angle);
+	float sine = sinf(settings.angle);
+	float cellsU = (float)(stage.columns - 1);
+	float cellsV = (float)(stage.rows - 1);
+	int32_t* cells = stage.cells.data();
+	if (!(settings.length > 0.0f && settings.width > 0.0f)) {
+		std::fill(cells + begin, cells + end, -1);
+		return;
+	}
+	float scaleU = cellsU / settings.length;
+	float scaleV = cellsV / settings.width;
+	float* weights0 = stage.weights[0].data();
+	float* weights1 = stage.weights[1].data();
+	float* weights2 = stage.weights[2].data();
+	float* weights3 = stage.weights[3].data();
+	for (size_t index = begin; index < end; index++) {
+		float dx = inputX[index] - settings.origin.x;
+		float dy = inputY[index] - settings.origin.y;
+		float u = (dx * cosine + dy * sine) * scaleU;
+		float v = (dy * cosine - dx * sine) * scaleV;
+		if (!(u >= 0.0f && u <= cellsU && v >= 0.0f && v <= cellsV)) {
+			cells[index] = -1;
+			weights0[index] = weights1[index] = weights2[index] = weights3[index] = 0.0f;
+			continue;
+		}
+		uint32_t column = std::min((uint32_t)u, stage.columns - 2);
+		uint32_t row = std::min((uint32_t)v, stage.rows - 2);
+		float s = u - (float)column;
+		float t = v - (float)row;
+		cells[index] = (int32_t)(row * stage.columns + column);
+		weights0[index] = (1.0f - s) * (1.0f - t);
+		weights1[index] = s * (1.0f - t);
+		weights2[index] = (1.0f - s) * t;
+		weights3[index] = s * t;
+	}
+}
+
+void plg::DeformerStack::Evaluate(Stage& stage, const float* inputX, const float* inputY, size_t begin, size_t end) {
+	const DeformerSettings& settings = stage.settings;
+	float* outputX = stage.x.data();
+	float* outputY = stage.y.data();
+	float originX = settings.origin.x;
+	float originY = settings.origin.y;
+	float cosine = cosf(settings.angle);
+	float sine = sinf(settings.angle);
+	float length = std::max(settings.length, s_FlatAmount);
+	bool flat = fabsf(settings.amount) < s_FlatAmount;
+	if (settings.type != DeformerType::LATTICE && settings.type != DeformerType::TAPER && flat) {
+		memcpy(outputX + begin, inputX + begin, (end - begin) * sizeof(float));
+		memcpy(outputY + begin, inputY + begin, (end - begin) * sizeof(float));
+		return;
+	}
+	switch (settings.type) {
+	case DeformerType::BEND: {
+		// The part of the axis from 0 to length is rolled onto a circle of radius
+		// length / amount, and what lies past its end carries on along the tangent.
+		float radius = length / settings.amount;
+		float anglePerUnit = settings.amount / length;
+		for (size_t index = begin; index < end; index++) {
+			float dx = inputX[index] - originX;
+			float dy = inputY[index] - originY;
+			float u = dx * cosine + dy * sine;
+			float v = dy * cosine - dx * sine;
+			float along = std::clamp(u, 0.0f, length);
+			float past = u - along;
+			float bend = along * anglePerUnit;
+			float bendCosine = cosf(bend);
+			float bendSine = sinf(bend);
+			float bentU = (radius - v) * bendSine + past * bendCosine;
+			float bentV = radius - (radius - v) * bendCosine + past * bendSine;
+			outputX[index] = originX + bentU * cosine - bentV * sine;
+			outputY[index] = originY + bentU * sine + bentV * cosine;
+		}
+		break;
+	}
+	case DeformerType::TWIST: {
+		float inverseLength = 1.0f / length;
+		for (size_t index = begin; index < end; index++) {
+			float dx = inputX[index] - originX;
+			float dy = inputY[index] - originY;
+			float falloff = std::max(1.0f - sqrtf(dx * dx + dy * dy) * inverseLength, 0.0f);
+			float twist = settings.amount * falloff * falloff;
+			float twistCosine = cosf(twist);
+			float twistSine = sinf(twist);
+			outputX[index] = originX + dx * twistCosine - dy * twistSine;
+			outputY[index] = originY + dx * twistSine + dy * twistCosine;
+		}
+		break;
+	}
+	case DeformerType::TAPER: {
+		// Scaling across the axis by s moves a point by (s - 1) v along the normal.
+		float inverseLength = 1.0f / length;
+		float scaleStep = settings.amount - 1.0f;
+		for (size_t index = begin; index < end; index++) {
+			float dx = inputX[index] - originX;
+			float dy = inputY[index] - originY;
+			float u = dx * cosine + dy * sine;
+			float v = dy * cosine - dx * sine;
+			float push = std::clamp(u * inverseLength, 0.0f, 1.0f) * scaleStep * v;
+			outputX[index] = inputX[index] - push * sine;
+			outputY[index] = inputY[index] + push * cosine;
+		}
+		break;
+	}
+	case DeformerType::LATTICE: {
+		const Vec2* offsets = stage.offsets.data();
+		const int32_t* cells = stage.cells.data();
+		const float* weights0 = stage.weights[0].data();
+		const float* weights1 = stage.weights[1].data();
+		const float* weights2 = stage.weights[2].data();
+		const float* weights3 = stage.weights[3].data();
+		size_t columns = stage.columns;
+		for (size_t index = begin; index < end; index++) {
+			int32_t cell = cells[index];
+			if (cell < 0) {
+				outputX[index] = inputX[index];
+				outputY[index] = inputY[index];
+				continue;
+			}
+			const Vec2& offset0 = offsets[cell];
+			const Vec2& offset1 = offsets[cell + 1];
+			const Vec2& offset2 = offsets[cell + columns];
+			const Vec2& offset3 = offsets[cell + columns + 1];
+			outputX[index] = inputX[index] + weights0[index] * offset0.x + weights1[index] * offset1.x + weights2[index] * offset2.x + weights3[index] * offset3.x;
+			outputY[index] = inputY[index] + weights0[index] * offset0.y + weights1[index] * offset1.y + weights2[index] * offset2.y + weights3[index] * offset3.y;
+		}
+		break;
+	}
+	}
+}
+
+void plg::BenchmarkDeformers(size_t repeatCount) {
+	// A 400 x 400 grid of points gives 160000 vertices.
+	const size_t side = 400;
+	std::vector<Vertex> vertices;
+	vertices.reserve(side * side);
+	for (size_t row = 0; row < side; row++) {
+		for (size_t column = 0; column < side; column++) {
+			vertices.push_back(Vertex((float)column, (float)row));
+		}
+	}
+	Mesh mesh(vertices, {}, {}, false);
+	DeformerStack stack;
+	DeformerSettings settings;
+	settings.length = (float)side;
+	settings.width = (float)side;
+	const DeformerType types[] = { DeformerType::BEND, DeformerType::TAPER, DeformerType::TWIST, DeformerType::LATTICE };
+	for (size_t deformer = 0; deformer < 8; deformer++) {
+		settings.type = types[deformer % 4];
+		settings.origin = Vec2((settings.type == DeformerType::TWIST) ? (float)side * 0.5f : 0.0f, (settings.type == DeformerType::TWIST) ? (float)side * 0.5f : 0.0f);
+		settings.amount = (settings.type == DeformerType::TAPER) ? 0.8f : 0.3f;
+		int32_t id = stack.AddDeformer(settings);
+		if (settings.type == DeformerType::LATTICE) {
+			stack.SetLatticeSize(id, 4, 4);
+		}
+	}
+	int32_t last = (int32_t)stack.GetDeformerCount() - 1;
+	const char* names[] = { "full", "first changed", "last changed", "lattice point moved" };
+	for (size_t test = 0; test < 4; test++) {
+		double seconds = 0.0;
+		size_t evaluated = 0;
+		for (size_t repeat = 0; repeat < repeatCount; repeat++) {
+			float change = 0.01f * (float)(repeat + 1);
+			if (test == 0) {
+				stack.Invalidate();
+			}
+			else if (test == 1) {
+				DeformerSettings first = stack.GetSettings(0);
+				first.amount = 0.3f + change;
+				stack.SetSettings(0, first);
+			}
+			else if (test == 2) {
+				// Moving the box makes the last lattice bind again.
+				DeformerSettings lastSettings = stack.GetSettings(last);
+				lastSettings.width = (float)side + change;
+				stack.SetSettings(last, lastSettings);
+			}
+			else {
+				stack.SetLatticePoint(last, 2, 2, Vec2(2.0f * (float)side / 3.0f + 10.0f * change, 2.0f * (float)side / 3.0f));
+			}
+			auto start = std::chrono::high_resolution_clock::now();
+			stack.Deform(&mesh);
+			seconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+			evaluated = stack.GetEvaluatedCount();
+		}
+		Log("Deformer stack ");
+		Log(names[test]);
+		Log(": ");
+		Log(seconds * 1000.0 / (double)repeatCount);
+		Log(" ms, ");
+		Log(evaluated);
+		Log(" deformers run", true);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,97 @@
+#pragma once
+#include "core_scene.h"
+#include <vector>
+
+namespace plg {
+	enum class DeformerType {
+		BEND, TWIST, TAPER, LATTICE
+	};
+
+	// Placement and strength of one deformer. Bend, taper and lattice work in a frame at
+	// origin whose x axis points along angle, and act over length along that axis. Twist
+	// swirls points around origin and fades out at a distance of length.
+	struct DeformerSettings {
+		DeformerType type = DeformerType::BEND;
+		Vec2 origin;
+		float angle = 0.0f;
+		float length = 100.0f;
+		// Height of the lattice box across the axis; the other deformers ignore it.
+		float width = 100.0f;
+		// Bend: angle turned over the length. Twist: angle turned at the origin.
+		// Taper: scale across the axis at the far end, 1 leaving the shape as it is.
+		float amount = 0.0f;
+		bool enabled = true;
+	};
+
+	// Non-destructive chain of deformers over the rest vertices of a mesh. Every deformer
+	// keeps its output as structure-of-arrays coordinates and runs as one batch kernel over
+	// them, so changing a deformer reruns it and those after it from the cached output of
+	// the one before, and the deformers above it are not touched. A lattice binds each
+	// vertex to its cell with four weights once; moving lattice points only reblends them,
+	// and the binding is redone when the lattice box changes or its input is recomputed.
+	class DeformerStack {
+	public:
+		static constexpr uint32_t MAX_LATTICE_SIZE = 64;
+
+		DeformerStack() { }
+
+		// Deformers run in the order they were added; ids are positions in the stack, so
+		// removing one moves those after it down by one.
+		int32_t AddDeformer(const DeformerSettings& settings);
+		void RemoveDeformer(int32_t deformer);
+		void SetSettings(int32_t deformer, const DeformerSettings& settings);
+		void SetEnabled(int32_t deformer, bool enabled);
+		// Resets the lattice to a flat grid of columns by rows points over its box.
+		void SetLatticeSize(int32_t deformer, uint32_t columns, uint32_t rows);
+		void SetLatticePoint(int32_t deformer, uint32_t column, uint32_t row, Vec2 position);
+		Vec2 GetLatticePoint(int32_t deformer, uint32_t column, uint32_t row) const;
+		// Rest vertices are read again on the next Deform. Call it after editing the mesh.
+		void Invalidate() { m_RestDirty = true; }
+		// Brings the stack up to date and hands the result to the mesh's render path.
+		void Deform(Mesh* mesh, bool parallel = true);
+
+		size_t GetDeformerCount() const { return m_Stages.size(); }
+		const DeformerSettings& GetSettings(int32_t deformer) const { return m_Stages[deformer].settings; }
+		// Deformers that ran during the last Deform.
+		size_t GetEvaluatedCount() const { return m_EvaluatedCount; }
+		const Vertex* GetDeformedVertices() const { return m_Deformed.data(); }
+
+	private:
+		static constexpr size_t NO_DIRTY = SIZE_MAX;
+
+		struct Stage {
+			DeformerSettings settings;
+			std::vector<float> x;
+			std::vector<float> y;
+			// Lattice points are kept as offsets from their place on the flat grid.
+			uint32_t columns = 0;
+			uint32_t rows = 0;
+			std::vector<Vec2> offsets;
+			// First point of the cell each vertex lies in, -1 outside the box.
+			std::vector<int32_t> cells;
+			std::vector<float> weights[4];
+			bool bound = false;
+		};
+
+		bool IsValid(int32_t deformer) const;
+		// Stages from the given one on rerun; unbind also drops their lattice bindings, for
+		// changes that give them different input.
+		void MarkDirty(size_t stage, bool unbind = false);
+		Vec2 GetLatticeRest(const Stage& stage, uint32_t column, uint32_t row) const;
+		void Bind(Stage& stage, const float* inputX, const float* inputY, size_t begin, size_t end);
+		void Evaluate(Stage& stage, const float* inputX, const float* inputY, size_t begin, size_t end);
+
+		std::vector<Stage> m_Stages;
+		std::vector<float> m_RestX;
+		std::vector<float> m_RestY;
+		std::vector<Vertex> m_Deformed;
+		size_t m_VertexCount = 0;
+		size_t m_FirstDirty = 0;
+		size_t m_EvaluatedCount = 0;
+		bool m_RestDirty = true;
+	};
+
+	// Logs a full evaluation of a stack of deformers over a large grid against reruns
+	// after changing its first or last deformer or moving a lattice point.
+	void BenchmarkDeformers(size_t repeatCount = 10);
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+#include "easing.h"
+#include <algorithm>
+#include <cmath>
+
+static constexpr float s_SampleStep = 1.0f / (float)(plg::EasingCurve::TABLE_SIZE - 1);
+static constexpr int s_NewtonIterations = 4;
+static constexpr float s_NewtonMinSlope = 0.001f;
+static constexpr float s_NewtonPrecision = 0.000001f;
+static constexpr int s_BisectionIterations = 20;
+
+// One coordinate of the curve in polynomial form, with the end points fixed at 0 and 1.
+static float s_Bezier(float t, float p1, float p2) {
+	return (((1.0f - 3.0f * p2 + 3.0f * p1) * t + (3.0f * p2 - 6.0f * p1)) * t + 3.0f * p1) * t;
+}
+
+static float s_BezierSlope(float t, float p1, float p2) {
+	return 3.0f * (1.0f - 3.0f * p2 + 3.0f * p1) * t * t + 2.0f * (3.0f * p2 - 6.0f * p1) * t + 3.0f * p1;
+}
+
+plg::EasingCurve::EasingCurve(float x1, float y1, float x2, float y2)
+	: m_X1(std::clamp(x1, 0.0f, 1.0f)), m_Y1(y1), m_X2(std::clamp(x2, 0.0f, 1.0f)), m_Y2(y2) {
+	// x has to stay monotonic for y(x) to exist, so the control points keep x in [0, 1].
+	m_Linear = (m_X1 == m_Y1 && m_X2 == m_Y2);
+	for (size_t sample = 0; sample < TABLE_SIZE; sample++) {
+		m_Samples[sample] = s_Bezier((float)sample * s_SampleStep, m_X1, m_X2);
+	}
+}
+
+float plg::EasingCurve::Evaluate(float x) const {
+	if (m_Linear) {
+		return x;
+	}
+	if (x <= 0.0f) {
+		return 0.0f;
+	}
+	if (x >= 1.0f) {
+		return 1.0f;
+	}
+	return s_Bezier(SolveT(x), m_Y1, m_Y2);
+}
+
+void plg::EasingCurve::Evaluate(const float* x, float* y, size_t count) const {
+	if (m_Linear) {
+		std::copy(x, x + count, y);
+		return;
+	}
+	for (size_t index = 0; index < count; index++) {
+		float value = x[index];
+		y[index] = (value <= 0.0f) ? 0.0f : (value >= 1.0f) ? 1.0f : s_Bezier(SolveT(value), m_Y1, m_Y2);
+	}
+}
+
+float plg::EasingCurve::SolveT(float x) const {
+	size_t sample = 1;
+	while (sample < TABLE_SIZE - 1 && m_Samples[sample] <= x) {
+		sample++;
+	}
+	sample--;
+	float span = m_Samples[sample + 1] - m_Samples[sample];
+	float start = (float)sample * s_SampleStep;
+	float t = start + ((span > 0.0f) ? (x - m_Samples[sample]) / span : 0.0f) * s_SampleStep;
+
+	// Newton converges quickly on the steep parts; near a flat spot it only creeps along,
+	// so a guess that has not converged afterwards is settled by bisecting its table interval.
+	for (int iteration = 0; iteration < s_NewtonIterations; iteration++) {
+		float slope = s_BezierSlope(t, m_X1, m_X2);
+		if (slope < s_NewtonMinSlope) {
+			break;
+		}
+		float step = (s_Bezier(t, m_X1, m_X2) - x) / slope;
+		t = std::clamp(t - step, 0.0f, 1.0f);
+		if (std::abs(step) <= s_NewtonPrecision) {
+			return t;
+		}
+	}
+	// On a flat spot a tiny error in x is a large one in t, so bisection runs to a fixed width.
+	float low = start, high = start + s_SampleStep;
+	for (int iteration = 0; iteration < s_BisectionIterations; iteration++) {
+		t = (low + high) * 0.5f;
+		if (s_Bezier(t, m_X1, m_X2) > x) {
+			high = t;
+		}
+		else {
+			low = t;
+		}
+	}
+	return t;
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+
+namespace plg {
+	// A timing curve from (0, 0) to (1, 1) shaped by two cubic Bezier control points, as
+	// used by CSS easings. x(t) is sampled into a small table when the curve is set; a
+	// lookup gives a close first guess for t and a couple of Newton steps, or bisection
+	// where the curve is too flat for Newton, refine it before y(t) is returned.
+	class EasingCurve {
+	public:
+		static constexpr size_t TABLE_SIZE = 11;
+
+		EasingCurve() : EasingCurve(0.0f, 0.0f, 1.0f, 1.0f) { }
+		EasingCurve(float x1, float y1, float x2, float y2);
+
+		static EasingCurve EaseIn() { return EasingCurve(0.42f, 0.0f, 1.0f, 1.0f); }
+		static EasingCurve EaseOut() { return EasingCurve(0.0f, 0.0f, 0.58f, 1.0f); }
+		static EasingCurve EaseInOut() { return EasingCurve(0.42f, 0.0f, 0.58f, 1.0f); }
+
+		float Evaluate(float x) const;
+		void Evaluate(const float* x, float* y, size_t count) const;
+
+		float GetX1() const { return m_X1; }
+		float GetY1() const { return m_Y1; }
+		float GetX2() const { return m_X2; }
+		float GetY2() const { return m_Y2; }
+		bool IsLinear() const { return m_Linear; }
+
+	private:
+		float SolveT(float x) const;
+
+		float m_X1, m_Y1, m_X2, m_Y2;
+		bool m_Linear;
+		float m_Samples[TABLE_SIZE];
+	};
+}
\ No newline at end of file
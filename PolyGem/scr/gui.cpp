@@ -1,6 +1,10 @@
 #include "gui.h"
 #include "core_scene.h"
 #include "core_functions.h"
+#include "subdivision.h"
+#include "mesh_weld.h"
+#include "uv_unwrap.h"
+#include "material.h"
 #include <unordered_map>
 #include <unordered_set>
 
@@ -672,6 +676,22 @@ void gui::HandleSceneEvents(GUIEvent* guiEvent, Frame* frame, void* sceneMeshRaw
 			scene->operator[](meshID).GetVertexList()->operator[](*index).AddVec(offset);
 		}
 	}
+	// Unwraps the mesh on the worker thread; the layout is picked up on a later frame
+	// without waiting for the solve.
+	static plg::UVUnwrapper unwrapper;
+	static int32_t unwrappedMesh = plg::SceneMeshData::NULL_MESH;
+	if ((guiEvent->GetKeyState(SDL_SCANCODE_LCTRL) || guiEvent->GetKeyState(SDL_SCANCODE_RCTRL)) && guiEvent->GetKeyState(SDL_SCANCODE_U) && meshID != plg::sceneMeshData.NULL_MESH) {
+		unwrapper.SetMesh(scene->operator[](meshID));
+		unwrapper.Submit();
+		unwrappedMesh = meshID;
+		guiEvent->SetKeyState(SDL_SCANCODE_U, false);
+	}
+	if (unwrappedMesh != plg::sceneMeshData.NULL_MESH && unwrappedMesh == meshID && unwrapper.FetchResult(scene->operator[](meshID))) {
+		Log("Unwrapped mesh in ");
+		Log(unwrapper.GetLastIterations());
+		Log(" iterations.", true);
+		unwrappedMesh = plg::sceneMeshData.NULL_MESH;
+	}
 	if (!s_CollideWith(*guiEvent->GetMousePos(), frame->GetRect())) {
 		return;
 	}
@@ -698,7 +718,9 @@ void gui::HandleSceneEvents(GUIEvent* guiEvent, Frame* frame, void* sceneMeshRaw
 	if (*guiEvent->GetMousePressed(SDL_BUTTON_RIGHT) && (guiEvent->GetKeyState(SDL_SCANCODE_LCTRL) || guiEvent->GetKeyState(SDL_SCANCODE_LCTRL))) {
 		Vector2D mousePos = *guiEvent->GetMousePos();
 		if (plg::sceneMeshData.GetMode() == plg::MeshMode::PLG_VERTEX) {
-			int32_t vertexID = scene->operator[](meshID).AddVertex(plg::Vertex(mousePos.x - frame->GetRect().x, mousePos.y - frame->GetRect().y));
+			plg::Mesh& mesh = scene->operator[](meshID);
+			plg::Vertex vertex(mousePos.x - frame->GetRect().x, mousePos.y - frame->GetRect().y);
+			int32_t vertexID = (mesh.GetFaceList()->GetSize() > 0) ? mesh.InsertVertex(vertex) : mesh.AddVertex(vertex);
 			if (plg::sceneMeshData.GetVertexCount() > 0 && (guiEvent->GetKeyState(SDL_SCANCODE_LSHIFT) || guiEvent->GetKeyState(SDL_SCANCODE_LSHIFT))) {
 				for (auto vertex_it = plg::sceneMeshData.GetVertexIter(); vertex_it < vertex_it.end_ptr; vertex_it++) {
 					scene->operator[](meshID).AddEdge(plg::Edge(vertexID, *vertex_it));
@@ -718,8 +740,93 @@ void gui::HandleSceneEvents(GUIEvent* guiEvent, Frame* frame, void* sceneMeshRaw
 		}
 		guiEvent->SetKeyState(SDL_SCANCODE_J, false);
 	}
+	if ((guiEvent->GetKeyState(SDL_SCANCODE_LCTRL) || guiEvent->GetKeyState(SDL_SCANCODE_RCTRL)) && guiEvent->GetKeyState(SDL_SCANCODE_D)) {
+		// Subdivides the selected faces, or the whole mesh without a face selection; Shift smooths with Loop.
+		static plg::Subdivider subdivider;
+		plg::Mesh& mesh = scene->operator[](meshID);
+		plg::SubdivisionScheme scheme = (guiEvent->GetKeyState(SDL_SCANCODE_LSHIFT) || guiEvent->GetKeyState(SDL_SCANCODE_RSHIFT)) ?
+			plg::SubdivisionScheme::LOOP : plg::SubdivisionScheme::MIDPOINT;
+		if (plg::sceneMeshData.GetMode() == plg::MeshMode::PLG_FACE && plg::sceneMeshData.GetFaceCount() > 0) {
+			std::vector<int32_t> faces;
+			for (auto face_it = plg::sceneMeshData.GetFaceIter(); face_it < face_it.end_ptr; face_it++) {
+				faces.push_back(*face_it);
+			}
+			subdivider.Subdivide(mesh, faces, 1, scheme);
+		}
+		else {
+			subdivider.Subdivide(mesh, 1, scheme);
+		}
+		plg::sceneMeshData.Clear();
+		guiEvent->SetKeyState(SDL_SCANCODE_D, false);
+	}
+	if ((guiEvent->GetKeyState(SDL_SCANCODE_LCTRL) || guiEvent->GetKeyState(SDL_SCANCODE_RCTRL)) && guiEvent->GetKeyState(SDL_SCANCODE_W)) {
+		// Welds vertices of the mesh that sit within two pixels of each other.
+		static plg::MeshWelder welder;
+		size_t removed = welder.Weld(scene->operator[](meshID), 2.0f);
+		Log("Welded ");
+		Log(removed);
+		Log(" vertices.", true);
+		plg::sceneMeshData.Clear();
+		guiEvent->SetKeyState(SDL_SCANCODE_W, false);
+	}
+	if ((guiEvent->GetKeyState(SDL_SCANCODE_LCTRL) || guiEvent->GetKeyState(SDL_SCANCODE_RCTRL)) && guiEvent->GetKeyState(SDL_SCANCODE_E)) {
+		// Extrudes the selected edges twenty pixels out, or lifts the selected faces up and to the right.
+		plg::Mesh& mesh = scene->operator[](meshID);
+		std::vector<int32_t> selection;
+		if (plg::sceneMeshData.GetMode() == plg::MeshMode::PLG_EDGE) {
+			for (auto edge_it = plg::sceneMeshData.GetEdgeIter(); edge_it < edge_it.end_ptr; edge_it++) {
+				selection.push_back(*edge_it);
+			}
+			mesh.ExtrudeEdges(selection, 20.0f);
+		}
+		else if (plg::sceneMeshData.GetMode() == plg::MeshMode::PLG_FACE) {
+			for (auto face_it = plg::sceneMeshData.GetFaceIter(); face_it < face_it.end_ptr; face_it++) {
+				selection.push_back(*face_it);
+			}
+			mesh.ExtrudeFaces(selection, plg::Vec2(20.0f, -20.0f));
+		}
+		plg::sceneMeshData.Clear();
+		guiEvent->SetKeyState(SDL_SCANCODE_E, false);
+	}
+	if ((guiEvent->GetKeyState(SDL_SCANCODE_LCTRL) || guiEvent->GetKeyState(SDL_SCANCODE_RCTRL)) && guiEvent->GetKeyState(SDL_SCANCODE_B)) {
+		// Chamfers the outline corners between selected edges by up to ten pixels.
+		if (plg::sceneMeshData.GetMode() == plg::MeshMode::PLG_EDGE && plg::sceneMeshData.GetEdgeCount() > 1) {
+			std::vector<int32_t> edges;
+			for (auto edge_it = plg::sceneMeshData.GetEdgeIter(); edge_it < edge_it.end_ptr; edge_it++) {
+				edges.push_back(*edge_it);
+			}
+			scene->operator[](meshID).BevelEdges(edges, 10.0f);
+			plg::sceneMeshData.Clear();
+		}
+		guiEvent->SetKeyState(SDL_SCANCODE_B, false);
+	}
+	if ((guiEvent->GetKeyState(SDL_SCANCODE_LCTRL) || guiEvent->GetKeyState(SDL_SCANCODE_RCTRL)) && guiEvent->GetKeyState(SDL_SCANCODE_M)) {
+		// Gives the selected faces a new flat coloured material, stepping the hue each time.
+		if (plg::sceneMeshData.GetMode() == plg::MeshMode::PLG_FACE && plg::sceneMeshData.GetFaceCount() > 0) {
+			plg::Material material;
+			uint32_t step = (uint32_t)plg::materialLibrary.GetMaterialCount() * 53;
+			material.color = { (uint8_t)(96 + step % 128), (uint8_t)(96 + (step * 3) % 128), (uint8_t)(96 + (step * 7) % 128), 192 };
+			plg::MaterialID materialID = plg::materialLibrary.AddMaterial(material);
+			for (auto face_it = plg::sceneMeshData.GetFaceIter(); face_it < face_it.end_ptr; face_it++) {
+				scene->operator[](meshID).SetFaceMaterial(*face_it, materialID);
+			}
+			plg::sceneMeshData.Clear();
+		}
+		guiEvent->SetKeyState(SDL_SCANCODE_M, false);
+	}
 	if (guiEvent->GetKeyState(SDL_SCANCODE_DELETE) && plg::sceneMeshData.GetVertexCount()) {
-
+		if (plg::sceneMeshData.GetMode() == plg::MeshMode::PLG_VERTEX) {
+			// A mesh keeps at least a triangle; removals past that are skipped.
+			plg::Mesh& mesh = scene->operator[](meshID);
+			for (auto vertex_it = plg::sceneMeshData.GetVertexIter(); vertex_it < vertex_it.end_ptr; vertex_it++) {
+				if (mesh.GetVertexList()->GetSize() <= 3) {
+					break;
+				}
+				mesh.RemoveVertex(*vertex_it);
+			}
+			plg::sceneMeshData.Clear();
+		}
+		guiEvent->SetKeyState(SDL_SCANCODE_DELETE, false);
 	}
 }
 
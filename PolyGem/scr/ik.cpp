@@ -0,0 +1,216 @@
+#include "ik.h"
+#include "container.h"
+#include <algorithm>
+
+plg::IKJointID plg::IKRig::AddJoint(IKJointID parent, Vec2 position) {
+	IKJointID joint = (IKJointID)m_Positions.size();
+	if (joint > 0) {
+		// Walking up from the last joint must meet the parent, or the preorder would break.
+		IKJointID ancestor = joint - 1;
+		while (ancestor != NULL_JOINT && ancestor != parent) {
+			ancestor = m_Parents[ancestor];
+		}
+		if (parent == NULL_JOINT || ancestor == NULL_JOINT) {
+			Log("Warning! IK joint parent must be the last joint or one of its ancestors!", true);
+			return NULL_JOINT;
+		}
+	}
+	else {
+		parent = NULL_JOINT;
+	}
+	for (IKJointID ancestor = parent; ancestor != NULL_JOINT; ancestor = m_Parents[ancestor]) {
+		m_SubtreeSizes[ancestor]++;
+	}
+	m_Parents.push_back(parent);
+	m_SubtreeSizes.push_back(1);
+	m_Lengths.push_back((parent == NULL_JOINT) ? 0.0f : position.GetDistanceTo(m_Positions[parent]));
+	m_Positions.push_back(position);
+	m_RestPositions.push_back(position);
+	m_Targets.push_back(position);
+	m_HasTarget.push_back(0);
+	m_Accumulated.push_back(Vec2());
+	m_AccumulatedCounts.push_back(0);
+	return joint;
+}
+
+void plg::IKRig::SetTarget(IKJointID joint, Vec2 target) {
+	m_Targets[joint] = target;
+	m_HasTarget[joint] = (joint > 0) ? 1 : 0;
+}
+
+void plg::IKRig::ClearTarget(IKJointID joint) {
+	m_HasTarget[joint] = 0;
+}
+
+void plg::IKRig::ResetPose() {
+	Vec2 root = m_Positions[0];
+	Vec2 offset = root - m_RestPositions[0];
+	for (size_t joint = 0; joint < m_Positions.size(); joint++) {
+		m_Positions[joint] = m_RestPositions[joint] + offset;
+	}
+}
+
+uint32_t plg::IKRig::Solve(const IKSettings& settings) {
+	if (m_Positions.size() < 2) {
+		return 0;
+	}
+	float error = GetError();
+	uint32_t iteration = 0;
+	while (error > settings.tolerance && iteration < settings.maxIterations) {
+		if (settings.method == IKMethod::FABRIK) {
+			SolveFABRIK();
+		}
+		else {
+			SolveCCD();
+		}
+		iteration++;
+		float previousError = error;
+		error = GetError();
+		// An unreachable target stops improving once the chain points straight at it.
+		if (previousError - error < settings.tolerance * 0.001f) {
+			break;
+		}
+	}
+	return iteration;
+}
+
+void plg::IKRig::SolveBatch(std::span<IKRig> rigs, const IKSettings& settings) {
+	container::GetThreadPool().ParallelFor(rigs.size(), 4, [&](size_t begin, size_t end) {
+		for (size_t rig = begin; rig < end; rig++) {
+			rigs[rig].Solve(settings);
+		}
+	});
+}
+
+plg::Affine2D plg::IKRig::GetBoneMatrix(IKJointID joint) const {
+	IKJointID parent = m_Parents[joint];
+	if (parent == NULL_JOINT) {
+		return Affine2D::Translation(m_Positions[joint]);
+	}
+	Vec2 start = m_Positions[parent];
+	Vec2 end = m_Positions[joint];
+	Vec2 direction = end - start;
+	return Affine2D::FromTRS(start, std::atan2(direction.y, direction.x), Vec2(1.0f, 1.0f));
+}
+
+float plg::IKRig::GetError() const {
+	float error = 0.0f;
+	for (size_t joint = 1; joint < m_Positions.size(); joint++) {
+		if (m_HasTarget[joint]) {
+			Vec2 position = m_Positions[joint];
+			error = std::max(error, position.GetDistanceTo(m_Targets[joint]));
+		}
+	}
+	return error;
+}
+
+void plg::IKRig::SolveFABRIK() {
+	size_t jointCount = m_Positions.size();
+	Vec2 root = m_Positions[0];
+	for (size_t joint = 0; joint < jointCount; joint++) {
+		m_Accumulated[joint] = m_HasTarget[joint] ? m_Targets[joint] : Vec2();
+		m_AccumulatedCounts[joint] = m_HasTarget[joint];
+	}
+	// Forward pass: from the effectors towards the root. A joint shared by several
+	// branches is placed at the average of the positions its children ask for.
+	for (size_t joint = jointCount - 1; joint > 0; joint--) {
+		if (m_AccumulatedCounts[joint] == 0) {
+			continue;
+		}
+		Vec2 desired = m_Accumulated[joint] / (float)m_AccumulatedCounts[joint];
+		m_Positions[joint] = desired;
+		IKJointID parent = m_Parents[joint];
+		Vec2 direction = m_Positions[parent] - desired;
+		float distance = direction.Magnitude();
+		if (distance > 0.0f) {
+			direction /= distance;
+		}
+		m_Accumulated[parent] += desired + direction * m_Lengths[joint];
+		m_AccumulatedCounts[parent]++;
+	}
+	// Backward pass: pin the root and restore every bone length along the tree.
+	m_Positions[0] = root;
+	for (size_t joint = 1; joint < jointCount; joint++) {
+		Vec2 start = m_Positions[m_Parents[joint]];
+		Vec2 direction = m_Positions[joint] - start;
+		float distance = direction.Magnitude();
+		if (distance > 0.0f) {
+			direction /= distance;
+		}
+		m_Positions[joint] = start + direction * m_Lengths[joint];
+	}
+}
+
+void plg::IKRig::SolveCCD() {
+	for (size_t pivot = m_Positions.size() - 1; pivot != (size_t)-1; pivot--) {
+		size_t end = pivot + (size_t)m_SubtreeSizes[pivot];
+		Vec2 center = m_Positions[pivot];
+		float sumCos = 0.0f, sumSin = 0.0f;
+		for (size_t joint = pivot + 1; joint < end; joint++) {
+			if (!m_HasTarget[joint]) {
+				continue;
+			}
+			Vec2 current = m_Positions[joint] - center;
+			Vec2 target = m_Targets[joint] - center;
+			float lengths = current.Magnitude() * target.Magnitude();
+			if (lengths > 0.0f) {
+				sumCos += current.ScalarProduct(target) / lengths;
+				sumSin += current.CrossProduct(target) / lengths;
+			}
+		}
+		float magnitude = std::sqrt(sumCos * sumCos + sumSin * sumSin);
+		if (magnitude == 0.0f) {
+			continue;
+		}
+		// Several effectors in the subtree rotate it by the average of their angles.
+		Vec2 rotation(sumCos / magnitude, sumSin / magnitude);
+		for (size_t joint = pivot + 1; joint < end; joint++) {
+			m_Positions[joint] = center + (m_Positions[joint] - center).RotateByVec(rotation);
+		}
+	}
+}
+
+void plg::BenchmarkIK(size_t solveCount) {
+	const size_t boneCounts[] = { 3, 10, 50 };
+	const IKMethod methods[] = { IKMethod::FABRIK, IKMethod::CCD };
+	const size_t batchSize = 256;
+	for (size_t boneCount : boneCounts) {
+		IKRig chain;
+		for (size_t joint = 0; joint <= boneCount; joint++) {
+			chain.AddJoint((IKJointID)joint - 1, Vec2(10.0f * (float)joint, 0.0f));
+		}
+		float radius = 7.0f * (float)boneCount;
+		for (IKMethod method : methods) {
+			IKSettings settings;
+			settings.method = method;
+			IKRig rig = chain;
+			auto start = std::chrono::high_resolution_clock::now();
+			for (size_t solve = 0; solve < solveCount; solve++) {
+				float angle = 0.01f * (float)solve;
+				rig.SetTarget((IKJointID)boneCount, Vec2(radius * std::cos(angle), radius * std::sin(angle)));
+				rig.Solve(settings);
+			}
+			double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+			std::vector<IKRig> rigs(batchSize, chain);
+			size_t batchCount = std::max<size_t>(1, solveCount / batchSize);
+			start = std::chrono::high_resolution_clock::now();
+			for (size_t batch = 0; batch < batchCount; batch++) {
+				float angle = 0.01f * (float)batch;
+				for (IKRig& batchRig : rigs) {
+					batchRig.SetTarget((IKJointID)boneCount, Vec2(radius * std::cos(angle), radius * std::sin(angle)));
+				}
+				IKRig::SolveBatch(rigs, settings);
+			}
+			double batchSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+			Log((method == IKMethod::FABRIK) ? "IK FABRIK " : "IK CCD ");
+			Log(boneCount);
+			Log(" bones: ");
+			Log((size_t)((double)solveCount / seconds));
+			Log(" solves/s, batched: ");
+			Log((size_t)((double)(batchCount * batchSize) / batchSeconds));
+			Log(" solves/s", true);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+#pragma once
+#include "core.h"
+#include <span>
+#include <vector>
+
+namespace plg {
+	using IKJointID = int32_t;
+
+	enum class IKMethod : uint8_t {
+		FABRIK, CCD
+	};
+
+	struct IKSettings {
+		IKMethod method = IKMethod::FABRIK;
+		uint32_t maxIterations = 16;
+		float tolerance = 0.01f;
+	};
+
+	// A 2D bone tree solved towards one or more end effector targets. Joints are stored in
+	// depth-first preorder like the scene graph, so the subtree of a joint is the range that
+	// follows it. All buffers are sized while the rig is built; Solve allocates nothing and
+	// starts from the previous solution, so a slowly moving target converges in a few passes.
+	class IKRig {
+	public:
+		static constexpr IKJointID NULL_JOINT = -1;
+
+		IKRig() { }
+
+		// parent must be the last added joint or one of its ancestors to keep the preorder.
+		IKJointID AddJoint(IKJointID parent, Vec2 position);
+		void SetRoot(Vec2 position) { m_Positions[0] = position; }
+		void SetTarget(IKJointID joint, Vec2 target);
+		void ClearTarget(IKJointID joint);
+		void ResetPose();
+		// Returns the number of iterations run, 0 when the warm start already converged.
+		uint32_t Solve(const IKSettings& settings);
+		static void SolveBatch(std::span<IKRig> rigs, const IKSettings& settings);
+
+		size_t GetJointCount() const { return m_Positions.size(); }
+		IKJointID GetParent(IKJointID joint) const { return m_Parents[joint]; }
+		Vec2 GetPosition(IKJointID joint) const { return m_Positions[joint]; }
+		const Vec2* GetPositions() const { return m_Positions.data(); }
+		// World matrix of the bone ending at joint: placed on the parent joint and rotated
+		// along the bone. It can be used directly as a Skin bone pose.
+		Affine2D GetBoneMatrix(IKJointID joint) const;
+		float GetError() const;
+
+	private:
+		void SolveFABRIK();
+		void SolveCCD();
+
+		std::vector<IKJointID> m_Parents;
+		std::vector<int32_t> m_SubtreeSizes;
+		std::vector<float> m_Lengths;
+		std::vector<Vec2> m_Positions;
+		std::vector<Vec2> m_RestPositions;
+		std::vector<Vec2> m_Targets;
+		std::vector<uint8_t> m_HasTarget;
+		std::vector<Vec2> m_Accumulated;
+		std::vector<uint32_t> m_AccumulatedCounts;
+	};
+
+	// Logs solves per second of 3, 10 and 50 bone chains for both methods, solved one by
+	// one and batched across the thread pool.
+	void BenchmarkIK(size_t solveCount = 20000);
+}
\ No newline at end of file
@@ -5,6 +5,15 @@
 
 #include "benchmark.h"
 #include "core_scene.h"
+#include "scene_graph.h"
+#include "ik.h"
+#include "polygon_boolean.h"
+#include "subdivision.h"
+#include "deformer.h"
+#include "mesh_lod.h"
+#include "mesh_weld.h"
+#include "uv_unwrap.h"
+#include "material.h"
 #include "gui.h"
 #include "core_functions.h"
 
@@ -60,6 +69,17 @@ int main() {
 		TTF_Init();
 	}
 	
+#if RUN_BENCHMARKS == 1
+	plg::BenchmarkIK();
+	plg::BenchmarkPolygonBoolean();
+	plg::BenchmarkSubdivision();
+	plg::BenchmarkDeformers();
+	plg::BenchmarkMeshLOD();
+	plg::BenchmarkMeshWeld();
+	plg::BenchmarkUVUnwrap();
+	plg::BenchmarkMaterialRender(renderer);
+#endif
+
 	gui::InitializeGUIStatics(renderer);
 	gui::Layer testLayer(renderer, { 10, 10, 800, 600 }, gui::DefaultColorBG);
 	gui::Frame testFrame(renderer, { 850, 50, 500, 500 });
@@ -69,14 +89,15 @@ int main() {
 	sceneMesh.Append(plg::Mesh({ plg::Vertex(50, 50), plg::Vertex(90, 150), plg::Vertex(130, 100), plg::Vertex(100, 100),
 		plg::Vertex(50, 140), plg::Vertex(80, 140), plg::Vertex(20, 90), plg::Vertex(180, 40), plg::Vertex(150, 40),
 		plg::Vertex(240, 110), plg::Vertex(190, 130), plg::Vertex(50, 200), plg::Vertex(120, 170), plg::Vertex(200, 240), plg::Vertex(210, 20) }));
+	plg::SceneGraph sceneGraph;
+	plg::SceneNodeID sceneRoot = sceneGraph.AddNode(plg::SceneNodeType::GROUP, plg::SceneGraph::NULL_NODE, -1, "Scene");
+	sceneGraph.AddNode(plg::SceneNodeType::MESH, sceneRoot, 0, "Mesh");
 	
 	testLayer.AddTreeView(renderer, { 500, 10, 0, 0 }, { "Branch0", "Branch01", "Branch02", "Branch1", "Branch11", "Branch111", "Branch112", "Branch1121", "Branch1122", "Branch113", "Branch12", "Branch121", "Branch122", "Branch2"},
 		{ 0, 1, 1, 0, 1, 2, 2, 3, 3, 2, 1, 2, 2, 0 }, 20, gui::DefaultGUIColor, gui::DefaultTextColor, gui::DefaultDestructiveButtonColor);
 	
 	while (!(*guiEvent.GetQuitState())) {
-		container::List<plg::Vertex>* vertices = sceneMesh[0].GetVertexList();
-		plg::Vec2 center = GetCircleCenter((*vertices)[0], (*vertices)[1], (*vertices)[2]);
-		float radius = center.GetDistanceTo((*vertices)[2]);
+		container::frameArena.Reset();
 
 		SDL_SetRenderDrawColor(renderer, 36, 36, 36, SDL_ALPHA_OPAQUE);
 		SDL_RenderClear(renderer);
@@ -86,8 +107,9 @@ int main() {
 		gui::HandleSceneEvents(&guiEvent, &testFrame, (void*)(&sceneMesh));
 		plg::sceneMeshData.SetMode(edgeButton->GetState());
 		
+		sceneGraph.UpdateWorldTransforms();
 		testFrame.SetRenderTarget(renderer);
-		sceneMesh[0].Render(renderer, plg::Vec2());
+		sceneGraph.Render(renderer, &sceneMesh);
 		testFrame.UnSetRenderTarget(renderer);
 		testLayer.Render(renderer);
 		testFrame.Render(renderer);
@@ -0,0 +1,82 @@
+#include "material.h"
+#include <chrono>
+
+plg::MaterialLibrary plg::materialLibrary = plg::MaterialLibrary();
+
+plg::MaterialLibrary::MaterialLibrary() {
+	Material material;
+	material.color = { 56, 96, 126, SDL_ALPHA_OPAQUE };
+	m_Materials.push_back(material);
+}
+
+plg::MaterialID plg::MaterialLibrary::AddMaterial(const Material& material) {
+	m_Materials.push_back(material);
+	return (MaterialID)(m_Materials.size() - 1);
+}
+
+void plg::MaterialLibrary::SetMaterial(MaterialID material, const Material& settings) {
+	if (!IsValid(material)) {
+		Log("Warning! Material does not exist.", true);
+		return;
+	}
+	m_Materials[material] = settings;
+}
+
+const plg::Material& plg::MaterialLibrary::GetMaterial(MaterialID material) const {
+	return m_Materials[IsValid(material) ? material : DEFAULT_MATERIAL];
+}
+
+void plg::BenchmarkMaterialRender(SDL_Renderer* renderer, size_t repeatCount) {
+	if (renderer == nullptr) {
+		return;
+	}
+	// A 200 x 200 grid of quads split in two, its faces dealt round eight materials so
+	// neighbouring faces never share one.
+	const size_t side = 200, materialCount = 8;
+	std::vector<Vertex> vertices;
+	std::vector<Face> faces;
+	std::vector<Vec2> uvs;
+	for (size_t row = 0; row < side; row++) {
+		for (size_t column = 0; column < side; column++) {
+			vertices.push_back(Vertex(2.0f * (float)column, 2.0f * (float)row));
+			uvs.push_back(Vec2((float)column / (float)(side - 1), (float)row / (float)(side - 1)));
+		}
+	}
+	for (size_t row = 0; row + 1 < side; row++) {
+		for (size_t column = 0; column + 1 < side; column++) {
+			int32_t corner = (int32_t)(row * side + column);
+			faces.push_back(Face(corner, corner + 1, corner + (int32_t)side + 1));
+			faces.push_back(Face(corner, corner + (int32_t)side + 1, corner + (int32_t)side));
+		}
+	}
+	Mesh mesh(vertices, {}, faces, false);
+	mesh.SetUVs(uvs);
+	MaterialLibrary library;
+	MaterialID first = (MaterialID)library.GetMaterialCount();
+	for (size_t material = 0; material < materialCount; material++) {
+		Material settings;
+		settings.color = { (uint8_t)(40 + material * 25), (uint8_t)(200 - material * 20), 120, 160 };
+		settings.blendMode = (material % 2 == 0) ? SDL_BLENDMODE_BLEND : SDL_BLENDMODE_ADD;
+		library.AddMaterial(settings);
+	}
+	for (auto face_it = mesh.GetFaceIter(); face_it < face_it.end_ptr; face_it++) {
+		mesh.SetFaceMaterial((int32_t)face_it.GetIndex(), first + (MaterialID)(face_it.GetIndex() % materialCount));
+	}
+	double seconds = 0.0;
+	for (size_t repeat = 0; repeat < repeatCount; repeat++) {
+		container::frameArena.Reset();
+		auto start = std::chrono::high_resolution_clock::now();
+		mesh.RenderMaterials(renderer, Affine2D(), library);
+		seconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+	container::frameArena.Reset();
+	Log("Material render of ");
+	Log(mesh.GetFaceList()->GetSize());
+	Log(" faces in ");
+	Log(materialCount);
+	Log(" materials: ");
+	Log(seconds * 1000.0 / (double)repeatCount);
+	Log(" ms, ");
+	Log(mesh.GetMaterialBatchCount());
+	Log(" batches", true);
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+#include "core_scene.h"
+#include "SDL.h"
+#include <vector>
+
+namespace plg {
+	// How a face is filled. The texture is not owned and is sampled with the mesh's UVs;
+	// without one the face is filled with the flat colour.
+	struct Material {
+		SDL_Texture* texture = nullptr;
+		SDL_Color color = { 255, 255, 255, SDL_ALPHA_OPAQUE };
+		SDL_BlendMode blendMode = SDL_BLENDMODE_BLEND;
+	};
+
+	// Materials shared by every mesh, looked up by id. Id 0 always exists and fills the
+	// faces no material was given to.
+	class MaterialLibrary {
+	public:
+		static constexpr MaterialID DEFAULT_MATERIAL = 0;
+
+		MaterialLibrary();
+
+		MaterialID AddMaterial(const Material& material);
+		void SetMaterial(MaterialID material, const Material& settings);
+		// Ids out of range read as the default material.
+		const Material& GetMaterial(MaterialID material) const;
+		size_t GetMaterialCount() const { return m_Materials.size(); }
+		bool IsValid(MaterialID material) const { return material >= 0 && (size_t)material < m_Materials.size(); }
+
+	private:
+		std::vector<Material> m_Materials;
+	};
+
+	extern MaterialLibrary materialLibrary;
+
+	// Logs the time to draw a large mesh whose faces are spread over a few materials, and
+	// the number of geometry batches it took.
+	void BenchmarkMaterialRender(SDL_Renderer* renderer, size_t repeatCount = 10);
+}
\ No newline at end of file
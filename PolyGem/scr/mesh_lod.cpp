@@ -0,0 +1,394 @@
+#include "mesh_lod.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+// Outline edges cost this many times more to move off than inner ones.
+static constexpr double s_BoundaryWeight = 16.0;
+// A collapse may not shrink a face below this part of its area, which also keeps it from flipping.
+static constexpr float s_MinAreaRatio = 1e-3f;
+
+static uint64_t s_EdgeKey(int32_t first, int32_t second) {
+	return ((uint64_t)(uint32_t)std::min(first, second) << 32) | (uint32_t)std::max(first, second);
+}
+
+static float s_Cross(const plg::Vec2& first, const plg::Vec2& second, const plg::Vec2& third) {
+	return (second.x - first.x) * (third.y - first.y) - (second.y - first.y) * (third.x - first.x);
+}
+
+size_t plg::MeshLOD::Build(Mesh& mesh, size_t maxLevels, float faceRatio, size_t minFaces) {
+	m_Levels.clear();
+	Load(mesh);
+	faceRatio = std::clamp(faceRatio, 0.05f, 0.95f);
+	size_t vertexCount = m_Positions.size();
+	m_Targets.assign(vertexCount, -1);
+	m_Versions.assign(vertexCount, 0);
+	m_Queue.clear();
+	for (size_t vertex = 0; vertex < vertexCount; vertex++) {
+		UpdateCandidate((int32_t)vertex);
+	}
+	size_t sourceFaces = m_LiveFaces;
+	size_t levelFaces = (size_t)((float)m_LiveFaces * faceRatio);
+	float maxError = 0.0f;
+	while (!m_Queue.empty() && m_Levels.size() + 1 < maxLevels && m_LiveFaces > minFaces) {
+		std::pop_heap(m_Queue.begin(), m_Queue.end(), std::greater<>());
+		Candidate candidate = m_Queue.back();
+		m_Queue.pop_back();
+		if (candidate.version != m_Versions[candidate.vertex]) {
+			continue;
+		}
+		// Collapses around the target may have made this one invalid since it was queued.
+		int32_t target = m_Targets[candidate.vertex];
+		Gather(candidate.vertex, m_Neighbours);
+		if (!CanCollapse(candidate.vertex, target)) {
+			UpdateCandidate(candidate.vertex);
+			continue;
+		}
+		maxError = std::max(maxError, m_Positions[candidate.vertex].GetDistanceTo(m_Positions[target]));
+		Collapse(candidate.vertex, target);
+		if (m_LiveFaces <= levelFaces) {
+			Snapshot(maxError);
+			levelFaces = (size_t)((float)m_LiveFaces * faceRatio);
+		}
+	}
+	// What was collapsed after the last cut still makes a level when it saved enough.
+	size_t lastFaces = m_Levels.empty() ? sourceFaces : m_Levels.back().faces.size();
+	if (m_Levels.size() + 1 < maxLevels && m_LiveFaces * 4 < lastFaces * 3) {
+		Snapshot(maxError);
+	}
+	return GetLevelCount();
+}
+
+size_t plg::MeshLOD::SelectLevel(float screenScale) const {
+	size_t chosen = 0;
+	for (size_t level = 0; level < m_Levels.size(); level++) {
+		if (m_Levels[level].error * screenScale > m_PixelError) {
+			break;
+		}
+		chosen = level + 1;
+	}
+	return chosen;
+}
+
+void plg::MeshLOD::Load(Mesh& mesh) {
+	container::List<Vertex>* vertices = mesh.GetVertexList();
+	size_t vertexCount = vertices->GetCapacity();
+	m_Revision = mesh.GetRevision();
+	m_Positions.assign(vertices->GetData(), vertices->GetData() + vertexCount);
+	m_Quadrics.assign(vertexCount, Quadric{ });
+	// Vertices stay locked until a face uses them, so empty slots never move.
+	m_Locked.assign(vertexCount, 1);
+	m_Boundary.assign(vertexCount, 0);
+	m_CollapsedTo.assign(vertexCount, -1);
+	m_VertexCorners.assign(vertexCount, -1);
+	m_Corners.clear();
+	m_FaceSigns.clear();
+	m_SideKeys.clear();
+	for (auto face_it = mesh.GetFaceIter(); face_it < face_it.end_ptr; face_it++) {
+		int32_t corners[3] = { face_it->m_Vert1, face_it->m_Vert2, face_it->m_Vert3 };
+		if (corners[0] == corners[1] || corners[1] == corners[2] || corners[2] == corners[0]) {
+			continue;
+		}
+		for (int32_t corner = 0; corner < 3; corner++) {
+			m_Corners.push_back(corners[corner]);
+			m_Locked[corners[corner]] = 0;
+			m_SideKeys.push_back(s_EdgeKey(corners[corner], corners[(corner + 1) % 3]));
+		}
+		m_FaceSigns.push_back((s_Cross(m_Positions[corners[0]], m_Positions[corners[1]], m_Positions[corners[2]]) < 0.0f) ? -1.0f : 1.0f);
+	}
+	m_LiveFaces = m_FaceSigns.size();
+	m_FaceAlive.assign(m_LiveFaces, 1);
+	m_CornerNext.resize(m_Corners.size());
+	for (size_t corner = 0; corner < m_Corners.size(); corner++) {
+		m_CornerNext[corner] = m_VertexCorners[m_Corners[corner]];
+		m_VertexCorners[m_Corners[corner]] = (int32_t)corner;
+	}
+	// Sides shared by two faces are inner edges; one face makes a boundary edge, and more
+	// than two a fin that no collapse may touch.
+	std::sort(m_SideKeys.begin(), m_SideKeys.end());
+	for (size_t first = 0; first < m_SideKeys.size();) {
+		size_t last = first + 1;
+		while (last < m_SideKeys.size() && m_SideKeys[last] == m_SideKeys[first]) {
+			last++;
+		}
+		int32_t start = (int32_t)(m_SideKeys[first] >> 32);
+		int32_t end = (int32_t)(uint32_t)m_SideKeys[first];
+		size_t faceCount = last - first;
+		if (faceCount == 1) {
+			m_Boundary[start] = m_Boundary[end] = 1;
+		}
+		else if (faceCount > 2) {
+			m_Locked[start] = m_Locked[end] = 1;
+		}
+		AddLine(start, end, (faceCount == 1) ? s_BoundaryWeight : 1.0);
+		first = last;
+	}
+	// Edges outside every face are carried through the levels as they are.
+	m_SourceEdges.clear();
+	for (auto edge_it = mesh.GetEdgeIter(); edge_it < edge_it.end_ptr; edge_it++) {
+		if (edge_it->m_Start < 0 || edge_it->m_End < 0 || (size_t)edge_it->m_Start >= vertexCount || (size_t)edge_it->m_End >= vertexCount) {
+			continue;
+		}
+		m_SourceEdges.push_back(*edge_it);
+		if (!std::binary_search(m_SideKeys.begin(), m_SideKeys.end(), s_EdgeKey(edge_it->m_Start, edge_it->m_End))) {
+			m_Locked[edge_it->m_Start] = m_Locked[edge_it->m_End] = 1;
+		}
+	}
+}
+
+void plg::MeshLOD::AddLine(int32_t start, int32_t end, double weight) {
+	double dx = (double)m_Positions[end].x - m_Positions[start].x;
+	double dy = (double)m_Positions[end].y - m_Positions[start].y;
+	double length = sqrt(dx * dx + dy * dy);
+	if (length == 0.0) {
+		return;
+	}
+	// The line ax + by + c = 0 with a unit normal, so p^T Q p is the squared distance.
+	double a = -dy / length;
+	double b = dx / length;
+	double c = -(a * m_Positions[start].x + b * m_Positions[start].y);
+	for (int32_t vertex : { start, end }) {
+		Quadric& quadric = m_Quadrics[vertex];
+		quadric.xx += weight * a * a;
+		quadric.xy += weight * a * b;
+		quadric.yy += weight * b * b;
+		quadric.x += weight * a * c;
+		quadric.y += weight * b * c;
+		quadric.c += weight * c * c;
+	}
+}
+
+double plg::MeshLOD::GetCost(int32_t vertex, int32_t target) const {
+	const Quadric& quadric = m_Quadrics[vertex];
+	double x = m_Positions[target].x;
+	double y = m_Positions[target].y;
+	double cost = quadric.xx * x * x + 2.0 * quadric.xy * x * y + quadric.yy * y * y + 2.0 * quadric.x * x + 2.0 * quadric.y * y + quadric.c;
+	return std::max(cost, 0.0);
+}
+
+void plg::MeshLOD::Gather(int32_t vertex, std::vector<int32_t>& neighbours) {
+	neighbours.clear();
+	// Corners of faces removed by earlier collapses are unlinked on the way.
+	int32_t* link = &m_VertexCorners[vertex];
+	while (*link != -1) {
+		int32_t corner = *link;
+		int32_t face = corner / 3;
+		if (!m_FaceAlive[face]) {
+			*link = m_CornerNext[corner];
+			continue;
+		}
+		int32_t base = face * 3;
+		neighbours.push_back(m_Corners[base + (corner - base + 1) % 3]);
+		neighbours.push_back(m_Corners[base + (corner - base + 2) % 3]);
+		link = &m_CornerNext[corner];
+	}
+	std::sort(neighbours.begin(), neighbours.end());
+	neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+}
+
+bool plg::MeshLOD::CanCollapse(int32_t vertex, int32_t target) {
+	if (target < 0 || m_Locked[vertex] || m_CollapsedTo[target] != -1) {
+		return false;
+	}
+	Gather(target, m_TargetNeighbours);
+	size_t sharedFaces = 0;
+	const Vec2& destination = m_Positions[target];
+	for (int32_t corner = m_VertexCorners[vertex]; corner != -1; corner = m_CornerNext[corner]) {
+		int32_t face = corner / 3;
+		int32_t base = face * 3;
+		int32_t next = m_Corners[base + (corner - base + 1) % 3];
+		int32_t previous = m_Corners[base + (corner - base + 2) % 3];
+		if (next == target || previous == target) {
+			sharedFaces++;
+			continue;
+		}
+		float before = s_Cross(m_Positions[vertex], m_Positions[next], m_Positions[previous]) * m_FaceSigns[face];
+		float after = s_Cross(destination, m_Positions[next], m_Positions[previous]) * m_FaceSigns[face];
+		if (after <= before * s_MinAreaRatio) {
+			return false;
+		}
+	}
+	// A boundary vertex may only slide along the outline.
+	if (sharedFaces == 0 || (m_Boundary[vertex] && sharedFaces != 1)) {
+		return false;
+	}
+	// Neighbours the two have in common other than across their shared faces would be
+	// pinched together into a fin.
+	size_t common = 0;
+	auto first = m_Neighbours.begin();
+	auto second = m_TargetNeighbours.begin();
+	while (first != m_Neighbours.end() && second != m_TargetNeighbours.end()) {
+		if (*first < *second) {
+			first++;
+		}
+		else if (*second < *first) {
+			second++;
+		}
+		else {
+			common++;
+			first++;
+			second++;
+		}
+	}
+	return common == sharedFaces;
+}
+
+void plg::MeshLOD::UpdateCandidate(int32_t vertex) {
+	m_Versions[vertex]++;
+	m_Targets[vertex] = -1;
+	if (m_Locked[vertex]) {
+		return;
+	}
+	Gather(vertex, m_Neighbours);
+	// Targets are tried cheapest first, so the checks usually stop at the first one.
+	m_OptionCosts.clear();
+	for (int32_t option : m_Neighbours) {
+		m_OptionCosts.push_back({ GetCost(vertex, option), option });
+	}
+	std::sort(m_OptionCosts.begin(), m_OptionCosts.end());
+	double bestCost = 0.0;
+	for (const std::pair<double, int32_t>& option : m_OptionCosts) {
+		if (CanCollapse(vertex, option.second)) {
+			m_Targets[vertex] = option.second;
+			bestCost = option.first;
+			break;
+		}
+	}
+	if (m_Targets[vertex] != -1) {
+		m_Queue.push_back(Candidate{ (float)bestCost, vertex, m_Versions[vertex] });
+		std::push_heap(m_Queue.begin(), m_Queue.end(), std::greater<>());
+	}
+}
+
+void plg::MeshLOD::Collapse(int32_t vertex, int32_t target) {
+	// Faces on the collapsed edge go away and the rest of the fan moves over to the target.
+	int32_t corner = m_VertexCorners[vertex];
+	while (corner != -1) {
+		int32_t next = m_CornerNext[corner];
+		int32_t face = corner / 3;
+		if (m_FaceAlive[face]) {
+			int32_t base = face * 3;
+			if (m_Corners[base] == target || m_Corners[base + 1] == target || m_Corners[base + 2] == target) {
+				m_FaceAlive[face] = 0;
+				m_LiveFaces--;
+			}
+			else {
+				m_Corners[corner] = target;
+				m_CornerNext[corner] = m_VertexCorners[target];
+				m_VertexCorners[target] = corner;
+			}
+		}
+		corner = next;
+	}
+	m_VertexCorners[vertex] = -1;
+	Quadric& sum = m_Quadrics[target];
+	const Quadric& added = m_Quadrics[vertex];
+	sum.xx += added.xx;
+	sum.xy += added.xy;
+	sum.yy += added.yy;
+	sum.x += added.x;
+	sum.y += added.y;
+	sum.c += added.c;
+	m_Locked[vertex] = 1;
+	m_CollapsedTo[vertex] = target;
+	m_Versions[vertex]++;
+	Gather(target, m_Ring);
+	UpdateCandidate(target);
+	for (int32_t neighbour : m_Ring) {
+		UpdateCandidate(neighbour);
+	}
+}
+
+int32_t plg::MeshLOD::FindRoot(int32_t vertex) {
+	int32_t root = vertex;
+	while (m_CollapsedTo[root] != -1) {
+		root = m_CollapsedTo[root];
+	}
+	while (m_CollapsedTo[vertex] != -1) {
+		int32_t next = m_CollapsedTo[vertex];
+		m_CollapsedTo[vertex] = root;
+		vertex = next;
+	}
+	return root;
+}
+
+void plg::MeshLOD::Snapshot(float error) {
+	LODLevel& level = m_Levels.emplace_back();
+	level.error = error;
+	level.faces.reserve(m_LiveFaces);
+	m_Used.assign(m_Positions.size(), 0);
+	for (size_t face = 0; face < m_FaceAlive.size(); face++) {
+		if (!m_FaceAlive[face]) {
+			continue;
+		}
+		const int32_t* corners = &m_Corners[face * 3];
+		level.faces.push_back(Face(corners[0], corners[1], corners[2]));
+		m_Used[corners[0]] = m_Used[corners[1]] = m_Used[corners[2]] = 1;
+	}
+	m_EdgeKeys.clear();
+	for (const Edge& edge : m_SourceEdges) {
+		int32_t start = FindRoot(edge.m_Start);
+		int32_t end = FindRoot(edge.m_End);
+		if (start != end) {
+			m_EdgeKeys.push_back(s_EdgeKey(start, end));
+		}
+	}
+	std::sort(m_EdgeKeys.begin(), m_EdgeKeys.end());
+	m_EdgeKeys.erase(std::unique(m_EdgeKeys.begin(), m_EdgeKeys.end()), m_EdgeKeys.end());
+	level.edges.reserve(m_EdgeKeys.size());
+	for (uint64_t key : m_EdgeKeys) {
+		int32_t start = (int32_t)(key >> 32);
+		int32_t end = (int32_t)(uint32_t)key;
+		level.edges.push_back(Edge(start, end));
+		m_Used[start] = m_Used[end] = 1;
+	}
+	for (size_t vertex = 0; vertex < m_Used.size(); vertex++) {
+		if (m_Used[vertex]) {
+			level.vertices.push_back((int32_t)vertex);
+		}
+	}
+}
+
+void plg::BenchmarkMeshLOD(size_t repeatCount) {
+	// A 200 x 200 grid of quads split in two gives 79202 faces.
+	const size_t side = 200;
+	std::vector<Vertex> vertices;
+	std::vector<Edge> edges;
+	std::vector<Face> faces;
+	for (size_t row = 0; row < side; row++) {
+		for (size_t column = 0; column < side; column++) {
+			vertices.push_back(Vertex(4.0f * (float)column, 4.0f * (float)row + 8.0f * sinf(0.05f * (float)column)));
+		}
+	}
+	for (size_t row = 0; row + 1 < side; row++) {
+		for (size_t column = 0; column + 1 < side; column++) {
+			int32_t corner = (int32_t)(row * side + column);
+			faces.push_back(Face(corner, corner + 1, corner + (int32_t)side + 1));
+			faces.push_back(Face(corner, corner + (int32_t)side + 1, corner + (int32_t)side));
+			edges.push_back(Edge(corner, corner + 1));
+			edges.push_back(Edge(corner, corner + side));
+			edges.push_back(Edge(corner, corner + side + 1));
+		}
+	}
+	Mesh mesh(vertices, edges, faces, false);
+	MeshLOD lod;
+	double seconds = 0.0;
+	for (size_t repeat = 0; repeat < repeatCount; repeat++) {
+		auto start = std::chrono::high_resolution_clock::now();
+		lod.Build(mesh);
+		seconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+	Log("Mesh LOD build: ");
+	Log(seconds * 1000.0 / (double)repeatCount);
+	Log(" ms", true);
+	for (size_t level = 1; level < lod.GetLevelCount(); level++) {
+		Log("Mesh LOD level ");
+		Log(level);
+		Log(": ");
+		Log(lod.GetLevel(level).faces.size());
+		Log(" faces, ");
+		Log(lod.GetLevel(level).edges.size());
+		Log(" edges, error ");
+		Log(lod.GetLevel(level).error, true);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,98 @@
+#pragma once
+#include "core_scene.h"
+#include <vector>
+
+namespace plg {
+	// One simplified version of a mesh. Indices refer to the vertex slots of the source
+	// mesh, so deformed vertices still apply; vertices lists the slots the level uses.
+	struct LODLevel {
+		std::vector<int32_t> vertices;
+		std::vector<Edge> edges;
+		std::vector<Face> faces;
+		// Farthest a collapse moved a vertex, in mesh units, on the way to this level.
+		float error = 0.0f;
+	};
+
+	// Chain of simplified levels of a mesh built with quadric error edge collapses. Every
+	// vertex carries a quadric of the squared distances to the lines of its edges, with
+	// boundary edges weighted up so the outline holds longest, and the cheapest collapse
+	// of a vertex onto a neighbour is taken from a priority queue. Collapses that would
+	// flip a face or pinch the surface are skipped. A vertex is moved onto the neighbour
+	// rather than to a new point, so all levels share the source mesh's vertices and are
+	// cut from one pass, each time the face count halves.
+	class MeshLOD {
+	public:
+		MeshLOD() { }
+
+		// Returns the number of levels, counting the full mesh as level 0. Stops when a
+		// level would have fewer than minFaces faces or no collapse is left.
+		size_t Build(Mesh& mesh, size_t maxLevels = 6, float faceRatio = 0.5f, size_t minFaces = 8);
+		void Clear() { m_Levels.clear(); m_Revision = 0; }
+		// Picks the coarsest level whose error stays under the pixel error once the mesh
+		// is drawn with the given scale, 0 being the full mesh.
+		size_t SelectLevel(float screenScale) const;
+
+		size_t GetLevelCount() const { return m_Levels.size() + 1; }
+		// Levels from 1 on; level 0 is the mesh itself.
+		const LODLevel& GetLevel(size_t level) const { return m_Levels[level - 1]; }
+		// Revision of the mesh the chain was built from. A mesh whose revision has moved on
+		// has been edited and draws in full.
+		uint32_t GetRevision() const { return m_Revision; }
+		void SetPixelError(float pixels) { m_PixelError = pixels; }
+		float GetPixelError() const { return m_PixelError; }
+
+	private:
+		struct Quadric {
+			double xx, xy, yy, x, y, c;
+		};
+
+		struct Candidate {
+			float cost;
+			int32_t vertex;
+			uint32_t version;
+
+			bool operator>(const Candidate& other) const { return cost > other.cost; }
+		};
+
+		void Load(Mesh& mesh);
+		void AddLine(int32_t start, int32_t end, double weight);
+		double GetCost(int32_t vertex, int32_t target) const;
+		void Gather(int32_t vertex, std::vector<int32_t>& neighbours);
+		// Expects the neighbours of vertex gathered into m_Neighbours.
+		bool CanCollapse(int32_t vertex, int32_t target);
+		void UpdateCandidate(int32_t vertex);
+		void Collapse(int32_t vertex, int32_t target);
+		int32_t FindRoot(int32_t vertex);
+		void Snapshot(float error);
+
+		std::vector<LODLevel> m_Levels;
+		std::vector<Vec2> m_Positions;
+		std::vector<Quadric> m_Quadrics;
+		std::vector<uint8_t> m_Locked;
+		std::vector<uint8_t> m_Boundary;
+		std::vector<int32_t> m_CollapsedTo;
+		// Face corners, and for every vertex a chain through the corners that use it.
+		std::vector<int32_t> m_Corners;
+		std::vector<int32_t> m_CornerNext;
+		std::vector<int32_t> m_VertexCorners;
+		std::vector<uint8_t> m_FaceAlive;
+		std::vector<float> m_FaceSigns;
+		std::vector<Edge> m_SourceEdges;
+		std::vector<uint64_t> m_SideKeys;
+		std::vector<int32_t> m_Targets;
+		std::vector<uint32_t> m_Versions;
+		std::vector<Candidate> m_Queue;
+		std::vector<int32_t> m_Neighbours;
+		std::vector<int32_t> m_TargetNeighbours;
+		std::vector<std::pair<double, int32_t>> m_OptionCosts;
+		std::vector<int32_t> m_Ring;
+		std::vector<uint64_t> m_EdgeKeys;
+		std::vector<uint8_t> m_Used;
+		uint32_t m_Revision = 0;
+		size_t m_LiveFaces = 0;
+		float m_PixelError = 1.0f;
+	};
+
+	// Logs the time to build the levels of a large grid and the size of each level.
+	void BenchmarkMeshLOD(size_t repeatCount = 10);
+}
\ No newline at end of file
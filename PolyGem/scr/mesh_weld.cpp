@@ -0,0 +1,248 @@
+#include "mesh_weld.h"
+#include "material.h"
+#include <algorithm>
+#include <cmath>
+
+// Cells never shrink below this, so a zero tolerance still only welds exact duplicates
+// without overflowing the cell coordinates.
+static constexpr float s_MinCellSize = 1e-4f;
+
+static uint64_t s_Mix(uint64_t key) {
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdULL;
+	key ^= key >> 33;
+	key *= 0xc4ceb9fe1a85ec53ULL;
+	key ^= key >> 33;
+	return key;
+}
+
+plg::Mesh plg::MeshWelder::Merge(std::span<Mesh* const> meshes, float tolerance) {
+	size_t slotCount = 0, vertexCount = 0, edgeCount = 0, faceCount = 0;
+	bool hasUVs = false, hasMaterials = false;
+	for (Mesh* mesh : meshes) {
+		hasUVs = hasUVs || !mesh->GetUVs().empty();
+		hasMaterials = hasMaterials || mesh->HasFaceMaterials();
+		slotCount += mesh->GetVertexList()->GetCapacity();
+		vertexCount += mesh->GetVertexList()->GetSize();
+		edgeCount += mesh->GetEdgeList()->GetSize();
+		faceCount += mesh->GetFaceList()->GetSize();
+	}
+	m_Tolerance = std::max(tolerance, 0.0f);
+	m_InverseCell = 1.0f / std::max(m_Tolerance, s_MinCellSize);
+	m_Remap.assign(slotCount, -1);
+	m_Vertices.clear();
+	m_Vertices.reserve(vertexCount);
+	m_CellX.clear();
+	m_CellX.reserve(vertexCount);
+	m_CellY.clear();
+	m_CellY.reserve(vertexCount);
+	m_Next.clear();
+	m_Next.reserve(vertexCount);
+	m_UVs.clear();
+	GrowTable(m_CellTable, vertexCount);
+	size_t base = 0;
+	for (Mesh* mesh : meshes) {
+		std::span<const Vec2> uvs = mesh->GetUVs();
+		for (auto vertex_it = mesh->GetVertexIter(); vertex_it < vertex_it.end_ptr; vertex_it++) {
+			m_Remap[base + vertex_it.GetIndex()] = FindOrAdd(*vertex_it);
+			if (hasUVs && m_UVs.size() < m_Vertices.size()) {
+				m_UVs.push_back((vertex_it.GetIndex() < uvs.size()) ? uvs[vertex_it.GetIndex()] : Vec2());
+			}
+		}
+		base += mesh->GetVertexList()->GetCapacity();
+	}
+
+	// Every edge and face is remapped once and kept unless an equal one is already in.
+	auto remap = [&](int32_t vertex, size_t meshBase, size_t capacity) {
+		return (vertex >= 0 && (size_t)vertex < capacity) ? m_Remap[meshBase + vertex] : -1;
+	};
+	m_Edges.clear();
+	m_Edges.reserve(edgeCount);
+	GrowTable(m_EdgeTable, edgeCount);
+	size_t edgeMask = m_EdgeTable.size() - 1;
+	base = 0;
+	for (Mesh* mesh : meshes) {
+		size_t capacity = mesh->GetVertexList()->GetCapacity();
+		for (auto edge_it = mesh->GetEdgeIter(); edge_it < edge_it.end_ptr; edge_it++) {
+			int32_t start = remap(edge_it->m_Start, base, capacity);
+			int32_t end = remap(edge_it->m_End, base, capacity);
+			if (start < 0 || end < 0 || start == end) {
+				continue;
+			}
+			int32_t low = std::min(start, end), high = std::max(start, end);
+			size_t slot = s_Mix(((uint64_t)(uint32_t)low << 32) | (uint32_t)high) & edgeMask;
+			while (m_EdgeTable[slot] != -1) {
+				const Edge& other = m_Edges[m_EdgeTable[slot]];
+				if (std::min(other.m_Start, other.m_End) == low && std::max(other.m_Start, other.m_End) == high) {
+					break;
+				}
+				slot = (slot + 1) & edgeMask;
+			}
+			if (m_EdgeTable[slot] == -1) {
+				m_EdgeTable[slot] = (int32_t)m_Edges.size();
+				m_Edges.push_back(Edge(start, end));
+			}
+		}
+		base += capacity;
+	}
+
+	// Faces are compared by their corners in sorted order, so a face and its mirror
+	// image count as the same face.
+	m_Faces.clear();
+	m_Faces.reserve(faceCount);
+	m_Materials.clear();
+	GrowTable(m_FaceTable, faceCount);
+	size_t faceMask = m_FaceTable.size() - 1;
+	auto sortCorners = [](const Face& face, int32_t* corners) {
+		corners[0] = face.m_Vert1;
+		corners[1] = face.m_Vert2;
+		corners[2] = face.m_Vert3;
+		std::sort(corners, corners + 3);
+	};
+	base = 0;
+	for (Mesh* mesh : meshes) {
+		size_t capacity = mesh->GetVertexList()->GetCapacity();
+		for (auto face_it = mesh->GetFaceIter(); face_it < face_it.end_ptr; face_it++) {
+			Face face(remap(face_it->m_Vert1, base, capacity), remap(face_it->m_Vert2, base, capacity), remap(face_it->m_Vert3, base, capacity));
+			if (face.m_Vert1 < 0 || face.m_Vert2 < 0 || face.m_Vert3 < 0 ||
+				face.m_Vert1 == face.m_Vert2 || face.m_Vert2 == face.m_Vert3 || face.m_Vert3 == face.m_Vert1) {
+				continue;
+			}
+			int32_t corners[3];
+			sortCorners(face, corners);
+			uint64_t key = ((uint64_t)(uint32_t)corners[0] * 0x9E3779B97F4A7C15ULL) ^ ((uint64_t)(uint32_t)corners[1] << 21) ^ (uint64_t)(uint32_t)corners[2];
+			size_t slot = s_Mix(key) & faceMask;
+			while (m_FaceTable[slot] != -1) {
+				int32_t other[3];
+				sortCorners(m_Faces[m_FaceTable[slot]], other);
+				if (other[0] == corners[0] && other[1] == corners[1] && other[2] == corners[2]) {
+					break;
+				}
+				slot = (slot + 1) & faceMask;
+			}
+			if (m_FaceTable[slot] == -1) {
+				m_FaceTable[slot] = (int32_t)m_Faces.size();
+				m_Faces.push_back(face);
+				if (hasMaterials) {
+					m_Materials.push_back(mesh->GetFaceMaterial((int32_t)face_it.GetIndex()));
+				}
+			}
+		}
+		base += capacity;
+	}
+	Mesh merged(m_Vertices, m_Edges, m_Faces, false);
+	if (hasUVs) {
+		merged.SetUVs(m_UVs);
+	}
+	for (size_t face = 0; face < m_Materials.size(); face++) {
+		if (m_Materials[face] != MaterialLibrary::DEFAULT_MATERIAL) {
+			merged.SetFaceMaterial((int32_t)face, m_Materials[face]);
+		}
+	}
+	return merged;
+}
+
+size_t plg::MeshWelder::Weld(Mesh& mesh, float tolerance) {
+	Mesh* meshes[1] = { &mesh };
+	size_t vertexCount = mesh.GetVertexList()->GetSize();
+	mesh = Merge(meshes, tolerance);
+	return vertexCount - mesh.GetVertexList()->GetSize();
+}
+
+int32_t plg::MeshWelder::FindOrAdd(const Vec2& position) {
+	int64_t cellX = (int64_t)floor((double)position.x * m_InverseCell);
+	int64_t cellY = (int64_t)floor((double)position.y * m_InverseCell);
+	size_t mask = m_CellTable.size() - 1;
+	auto findCell = [&](int64_t x, int64_t y) {
+		size_t slot = s_Mix((uint64_t)x * 0x9E3779B97F4A7C15ULL ^ (uint64_t)y) & mask;
+		while (m_CellTable[slot] != -1 && (m_CellX[m_CellTable[slot]] != x || m_CellY[m_CellTable[slot]] != y)) {
+			slot = (slot + 1) & mask;
+		}
+		return slot;
+	};
+	// A vertex within the tolerance lies in this cell or one of its eight neighbours.
+	float limit = m_Tolerance * m_Tolerance;
+	for (int64_t y = cellY - 1; y <= cellY + 1; y++) {
+		for (int64_t x = cellX - 1; x <= cellX + 1; x++) {
+			for (int32_t kept = m_CellTable[findCell(x, y)]; kept != -1; kept = m_Next[kept]) {
+				float dx = m_Vertices[kept].x - position.x;
+				float dy = m_Vertices[kept].y - position.y;
+				if (dx * dx + dy * dy <= limit) {
+					return kept;
+				}
+			}
+		}
+	}
+	int32_t vertex = (int32_t)m_Vertices.size();
+	m_Vertices.push_back(position);
+	m_CellX.push_back(cellX);
+	m_CellY.push_back(cellY);
+	size_t slot = findCell(cellX, cellY);
+	m_Next.push_back(m_CellTable[slot]);
+	m_CellTable[slot] = vertex;
+	return vertex;
+}
+
+void plg::MeshWelder::GrowTable(std::vector<int32_t>& table, size_t count) {
+	// Kept at most half full so probe runs stay short.
+	size_t size = 16;
+	while (size < count * 2) {
+		size <<= 1;
+	}
+	table.assign(size, -1);
+}
+
+void plg::BenchmarkMeshWeld(size_t repeatCount) {
+	// Eight by eight tiles of 32 x 32 quads, each tile repeating the border of its
+	// neighbours with a little noise, weld down to one 257 x 257 grid.
+	const size_t tiles = 8, side = 33;
+	std::vector<Mesh> pieces;
+	pieces.reserve(tiles * tiles);
+	for (size_t tileY = 0; tileY < tiles; tileY++) {
+		for (size_t tileX = 0; tileX < tiles; tileX++) {
+			std::vector<Vertex> vertices;
+			std::vector<Edge> edges;
+			std::vector<Face> faces;
+			for (size_t row = 0; row < side; row++) {
+				for (size_t column = 0; column < side; column++) {
+					float noise = 0.001f * sinf((float)(vertices.size() + tileX * 7 + tileY * 13));
+					vertices.push_back(Vertex((float)(tileX * (side - 1) + column) + noise, (float)(tileY * (side - 1) + row) - noise));
+				}
+			}
+			for (size_t row = 0; row + 1 < side; row++) {
+				for (size_t column = 0; column + 1 < side; column++) {
+					int32_t corner = (int32_t)(row * side + column);
+					faces.push_back(Face(corner, corner + 1, corner + (int32_t)side + 1));
+					faces.push_back(Face(corner, corner + (int32_t)side + 1, corner + (int32_t)side));
+					edges.push_back(Edge(corner, corner + 1));
+					edges.push_back(Edge(corner, corner + side));
+					edges.push_back(Edge(corner, corner + side + 1));
+				}
+			}
+			pieces.push_back(Mesh(vertices, edges, faces, false));
+		}
+	}
+	std::vector<Mesh*> meshes;
+	for (Mesh& piece : pieces) {
+		meshes.push_back(&piece);
+	}
+	MeshWelder welder;
+	Mesh merged;
+	double seconds = 0.0;
+	for (size_t repeat = 0; repeat < repeatCount; repeat++) {
+		auto start = std::chrono::high_resolution_clock::now();
+		merged = welder.Merge(meshes, 0.01f);
+		seconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+	Log("Mesh weld of ");
+	Log(meshes.size());
+	Log(" tiles: ");
+	Log(seconds * 1000.0 / (double)repeatCount);
+	Log(" ms, ");
+	Log(merged.GetVertexList()->GetSize());
+	Log(" vertices, ");
+	Log(merged.GetEdgeList()->GetSize());
+	Log(" edges, ");
+	Log(merged.GetFaceList()->GetSize());
+	Log(" faces", true);
+}
\ No newline at end of file
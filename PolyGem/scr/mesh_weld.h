@@ -0,0 +1,48 @@
+#pragma once
+#include "core_scene.h"
+#include <span>
+#include <vector>
+
+namespace plg {
+	// Merges meshes into one and welds vertices closer than a tolerance. Positions are
+	// hashed into a grid of tolerance sized cells, so a vertex is only compared with the
+	// ones kept in the nine cells around it and the weld is expected O(n). Edges and faces
+	// are remapped in one pass, and those left degenerate or repeated are dropped through
+	// hash sets. The first vertex of each welded group keeps its position and uv, and the
+	// first of each set of repeated faces its material. Meshes without uvs or materials
+	// give their vertices a zero uv and their faces the default material when others have them.
+	class MeshWelder {
+	public:
+		Mesh Merge(std::span<Mesh* const> meshes, float tolerance = 0.0f);
+		// Welds a mesh in place and returns the number of vertices removed. The remaining
+		// vertices are packed, so slot indices change.
+		size_t Weld(Mesh& mesh, float tolerance = 0.0f);
+
+		// Source vertex of the last operation, counted over all meshes in order and all
+		// their slots, to the vertex it became; -1 for empty slots.
+		std::span<const int32_t> GetVertexRemap() const { return m_Remap; }
+
+	private:
+		int32_t FindOrAdd(const Vec2& position);
+		void GrowTable(std::vector<int32_t>& table, size_t count);
+
+		float m_Tolerance = 0.0f;
+		float m_InverseCell = 1.0f;
+		std::vector<int32_t> m_Remap;
+		std::vector<Vertex> m_Vertices;
+		std::vector<Edge> m_Edges;
+		std::vector<Face> m_Faces;
+		std::vector<Vec2> m_UVs;
+		std::vector<MaterialID> m_Materials;
+		// Cell of every kept vertex, and the kept vertices of a cell chained through next.
+		std::vector<int64_t> m_CellX;
+		std::vector<int64_t> m_CellY;
+		std::vector<int32_t> m_Next;
+		std::vector<int32_t> m_CellTable;
+		std::vector<int32_t> m_EdgeTable;
+		std::vector<int32_t> m_FaceTable;
+	};
+
+	// Logs the time to merge a set of grid tiles whose borders overlap.
+	void BenchmarkMeshWeld(size_t repeatCount = 10);
+}
\ No newline at end of file
@@ -0,0 +1,180 @@
+#include "motion_path.h"
+#include <algorithm>
+
+static constexpr uint32_t s_MaxFlattenDepth = 16;
+static constexpr size_t s_MaxTableSize = 4096;
+
+static float s_Distance(const plg::Vec2& from, const plg::Vec2& to) {
+	float dx = to.x - from.x, dy = to.y - from.y;
+	return std::sqrt(dx * dx + dy * dy);
+}
+
+static plg::Vec2 s_Midpoint(const plg::Vec2& from, const plg::Vec2& to) {
+	return plg::Vec2((from.x + to.x) * 0.5f, (from.y + to.y) * 0.5f);
+}
+
+plg::MotionPath::MotionPath(Vec2 start, float tolerance, float tableSpacing)
+	: m_Tolerance(tolerance), m_TableSpacing(tableSpacing) {
+	m_Points.push_back(start);
+}
+
+size_t plg::MotionPath::AddSegment(Vec2 control1, Vec2 control2, Vec2 end) {
+	m_Points.push_back(control1);
+	m_Points.push_back(control2);
+	m_Points.push_back(end);
+	m_SegmentEnds.push_back(GetLength());
+	m_Segments.emplace_back();
+	m_EndsDirty = true;
+	return m_Segments.size() - 1;
+}
+
+void plg::MotionPath::SetControlPoint(size_t point, Vec2 position) {
+	if (point >= m_Points.size()) {
+		Log("Warning! Motion path control point is out of range!", true);
+		return;
+	}
+	m_Points[point] = position;
+	size_t segment = point / 3;
+	// An end point is shared by the segment before it and the one after it.
+	if (point % 3 == 0 && segment > 0) {
+		m_Segments[segment - 1].dirty = true;
+	}
+	if (segment < m_Segments.size()) {
+		m_Segments[segment].dirty = true;
+	}
+}
+
+size_t plg::MotionPath::Rebuild() {
+	size_t rebuilt = 0;
+	for (size_t segment = 0; segment < m_Segments.size(); segment++) {
+		if (m_Segments[segment].dirty) {
+			BuildSegment(segment);
+			rebuilt++;
+		}
+	}
+	if (rebuilt > 0 || m_EndsDirty) {
+		float length = 0.0f;
+		for (size_t segment = 0; segment < m_Segments.size(); segment++) {
+			length += m_Segments[segment].length;
+			m_SegmentEnds[segment] = length;
+		}
+		m_EndsDirty = false;
+	}
+	return rebuilt;
+}
+
+void plg::MotionPath::Sample(float distance, Vec2* position, Vec2* tangent) const {
+	if (m_Segments.empty()) {
+		*position = m_Points[0];
+		if (tangent != nullptr) {
+			*tangent = Vec2(1.0f, 0.0f);
+		}
+		return;
+	}
+	distance = std::clamp(distance, 0.0f, GetLength());
+	size_t segment = (size_t)(std::upper_bound(m_SegmentEnds.begin(), m_SegmentEnds.end(), distance) - m_SegmentEnds.begin());
+	segment = std::min(segment, m_Segments.size() - 1);
+	const Segment& target = m_Segments[segment];
+	float t = 0.0f;
+	if (target.length > 0.0f) {
+		float local = distance - ((segment > 0) ? m_SegmentEnds[segment - 1] : 0.0f);
+		size_t steps = target.table.size() - 1;
+		float step = std::clamp(local / target.length, 0.0f, 1.0f) * (float)steps;
+		size_t index = std::min((size_t)step, steps - 1);
+		float fraction = step - (float)index;
+		t = target.table[index] + (target.table[index + 1] - target.table[index]) * fraction;
+	}
+	*position = Evaluate(segment, t);
+	if (tangent != nullptr) {
+		Vec2 derivative = EvaluateTangent(segment, t);
+		float magnitude = derivative.Magnitude();
+		*tangent = (magnitude > 0.0f) ? derivative / magnitude : Vec2(1.0f, 0.0f);
+	}
+}
+
+void plg::MotionPath::Sample(const float* distances, size_t count, Vec2* positions, Vec2* tangents) const {
+	for (size_t index = 0; index < count; index++) {
+		Sample(distances[index], &positions[index], (tangents != nullptr) ? &tangents[index] : nullptr);
+	}
+}
+
+void plg::MotionPath::Follow(SceneGraph* graph, SceneNodeID node, float distance, bool orient) const {
+	Vec2 position, tangent;
+	Sample(distance, &position, &tangent);
+	Transform2D* local = graph->GetLocalTransformPtr(node);
+	local->position = position;
+	if (orient) {
+		local->rotation = std::atan2(tangent.y, tangent.x);
+	}
+	graph->MarkDirty(node);
+}
+
+void plg::MotionPath::BuildSegment(size_t segment) {
+	const Vec2* points = m_Points.data() + segment * 3;
+	m_FlatParameters.clear();
+	m_FlatLengths.clear();
+	m_FlatParameters.push_back(0.0f);
+	m_FlatLengths.push_back(0.0f);
+	Flatten(points, 0.0f, 1.0f, 0, m_FlatParameters, m_FlatLengths);
+
+	Segment& target = m_Segments[segment];
+	target.length = m_FlatLengths.back();
+	size_t steps = std::clamp((size_t)std::ceil(target.length / m_TableSpacing), (size_t)1, s_MaxTableSize);
+	target.table.resize(steps + 1);
+	// Walk the flattened polyline once, reading off t at every equal arc-length step.
+	size_t flat = 0;
+	for (size_t step = 0; step <= steps; step++) {
+		float distance = target.length * (float)step / (float)steps;
+		while (flat + 2 < m_FlatLengths.size() && m_FlatLengths[flat + 1] < distance) {
+			flat++;
+		}
+		float span = m_FlatLengths[flat + 1] - m_FlatLengths[flat];
+		float fraction = (span > 0.0f) ? std::clamp((distance - m_FlatLengths[flat]) / span, 0.0f, 1.0f) : 0.0f;
+		target.table[step] = m_FlatParameters[flat] + (m_FlatParameters[flat + 1] - m_FlatParameters[flat]) * fraction;
+	}
+	target.dirty = false;
+}
+
+void plg::MotionPath::Flatten(const Vec2* points, float t0, float t1, uint32_t depth, std::vector<float>& parameters, std::vector<float>& lengths) const {
+	float chordX = points[3].x - points[0].x, chordY = points[3].y - points[0].y;
+	float chord = std::sqrt(chordX * chordX + chordY * chordY);
+	float deviation;
+	if (chord > 0.0f) {
+		float deviation1 = std::abs((points[1].x - points[0].x) * chordY - (points[1].y - points[0].y) * chordX);
+		float deviation2 = std::abs((points[2].x - points[0].x) * chordY - (points[2].y - points[0].y) * chordX);
+		deviation = std::max(deviation1, deviation2) / chord;
+	}
+	else {
+		deviation = std::max(s_Distance(points[0], points[1]), s_Distance(points[0], points[2]));
+	}
+	if (deviation <= m_Tolerance || depth >= s_MaxFlattenDepth) {
+		parameters.push_back(t1);
+		lengths.push_back(lengths.back() + chord);
+		return;
+	}
+	// de Casteljau split at the middle of the parameter range.
+	Vec2 p01 = s_Midpoint(points[0], points[1]), p12 = s_Midpoint(points[1], points[2]), p23 = s_Midpoint(points[2], points[3]);
+	Vec2 p012 = s_Midpoint(p01, p12), p123 = s_Midpoint(p12, p23);
+	Vec2 middle = s_Midpoint(p012, p123);
+	const Vec2 left[4] = { points[0], p01, p012, middle };
+	const Vec2 right[4] = { middle, p123, p23, points[3] };
+	float tm = (t0 + t1) * 0.5f;
+	Flatten(left, t0, tm, depth + 1, parameters, lengths);
+	Flatten(right, tm, t1, depth + 1, parameters, lengths);
+}
+
+plg::Vec2 plg::MotionPath::Evaluate(size_t segment, float t) const {
+	const Vec2* points = m_Points.data() + segment * 3;
+	float u = 1.0f - t;
+	float w0 = u * u * u, w1 = 3.0f * u * u * t, w2 = 3.0f * u * t * t, w3 = t * t * t;
+	return Vec2(w0 * points[0].x + w1 * points[1].x + w2 * points[2].x + w3 * points[3].x,
+		w0 * points[0].y + w1 * points[1].y + w2 * points[2].y + w3 * points[3].y);
+}
+
+plg::Vec2 plg::MotionPath::EvaluateTangent(size_t segment, float t) const {
+	const Vec2* points = m_Points.data() + segment * 3;
+	float u = 1.0f - t;
+	float w0 = 3.0f * u * u, w1 = 6.0f * u * t, w2 = 3.0f * t * t;
+	return Vec2(w0 * (points[1].x - points[0].x) + w1 * (points[2].x - points[1].x) + w2 * (points[3].x - points[2].x),
+		w0 * (points[1].y - points[0].y) + w1 * (points[2].y - points[1].y) + w2 * (points[3].y - points[2].y));
+}
\ No newline at end of file
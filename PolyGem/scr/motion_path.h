@@ -0,0 +1,52 @@
+#pragma once
+#include "scene_graph.h"
+#include <vector>
+
+namespace plg {
+	// A chain of cubic Bezier segments travelled at constant speed. Each segment is
+	// flattened adaptively once and resampled into a table of curve parameters at equal
+	// arc-length steps, so a distance query is a binary search over the segments and a
+	// table lookup inside one. Editing a control point only rebuilds the segments it shapes.
+	class MotionPath {
+	public:
+		MotionPath(Vec2 start = Vec2(), float tolerance = 0.25f, float tableSpacing = 2.0f);
+
+		// Appends a segment from the current end point; returns its index.
+		size_t AddSegment(Vec2 control1, Vec2 control2, Vec2 end);
+		// Control points are numbered start, control1, control2, end, control1, ...
+		void SetControlPoint(size_t point, Vec2 position);
+		Vec2 GetControlPoint(size_t point) const { return m_Points[point]; }
+		size_t GetControlPointCount() const { return m_Points.size(); }
+		size_t GetSegmentCount() const { return m_Segments.size(); }
+
+		// Rebuilds the tables of edited segments and returns how many were rebuilt. Queries
+		// read the tables as they are, so call it after edits and before sampling.
+		size_t Rebuild();
+		float GetLength() const { return m_Segments.empty() ? 0.0f : m_SegmentEnds.back(); }
+		void Sample(float distance, Vec2* position, Vec2* tangent = nullptr) const;
+		void Sample(const float* distances, size_t count, Vec2* positions, Vec2* tangents = nullptr) const;
+		// Places a node on the path, turning it along the tangent when orient is set.
+		void Follow(SceneGraph* graph, SceneNodeID node, float distance, bool orient = true) const;
+
+	private:
+		struct Segment {
+			std::vector<float> table;
+			float length = 0.0f;
+			bool dirty = true;
+		};
+
+		void BuildSegment(size_t segment);
+		void Flatten(const Vec2* points, float t0, float t1, uint32_t depth, std::vector<float>& parameters, std::vector<float>& lengths) const;
+		Vec2 Evaluate(size_t segment, float t) const;
+		Vec2 EvaluateTangent(size_t segment, float t) const;
+
+		std::vector<Vec2> m_Points;
+		std::vector<Segment> m_Segments;
+		std::vector<float> m_SegmentEnds;
+		std::vector<float> m_FlatParameters;
+		std::vector<float> m_FlatLengths;
+		float m_Tolerance;
+		float m_TableSpacing;
+		bool m_EndsDirty = false;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,135 @@
+#include "onion_skin.h"
+#include <algorithm>
+
+plg::OnionSkin::~OnionSkin() {
+	ReleaseTextures();
+}
+
+void plg::OnionSkin::SetRange(int32_t framesBefore, int32_t framesAfter) {
+	m_FramesBefore = std::max(framesBefore, 0);
+	m_FramesAfter = std::max(framesAfter, 0);
+}
+
+void plg::OnionSkin::Invalidate() {
+	for (Ghost& ghost : m_Ghosts) {
+		ghost.valid = false;
+	}
+}
+
+void plg::OnionSkin::Update(SDL_Renderer* renderer, int width, int height) {
+	m_LastRenderCount = 0;
+	if (width != m_Width || height != m_Height) {
+		ReleaseTextures();
+		m_Width = width;
+		m_Height = height;
+	}
+	int32_t playhead = m_Timeline->GetPlayhead();
+	for (size_t index = m_Ghosts.size(); index-- > 0;) {
+		int32_t offset = m_Ghosts[index].frame - playhead;
+		if (offset == 0 || offset < -m_FramesBefore || offset > m_FramesAfter) {
+			if (m_Ghosts[index].texture != nullptr) {
+				m_FreeTextures.push_back(m_Ghosts[index].texture);
+			}
+			m_Ghosts[index] = std::move(m_Ghosts.back());
+			m_Ghosts.pop_back();
+		}
+	}
+	for (int32_t offset = -m_FramesBefore; offset <= m_FramesAfter; offset++) {
+		if (offset != 0 && FindGhost(playhead + offset) == nullptr) {
+			m_Ghosts.push_back({ playhead + offset, AcquireTexture(renderer), { }, 0, false });
+		}
+	}
+
+	AnimationClip* clip = m_Timeline->GetClip();
+	SceneGraph* graph = m_Timeline->GetGraph();
+	TimelineCache* cache = m_Timeline->GetCache();
+	SDL_Texture* target = SDL_GetRenderTarget(renderer);
+	size_t trackCount = clip->GetTrackCount();
+	for (Ghost& ghost : m_Ghosts) {
+		if (ghost.texture == nullptr || (ghost.valid && ghost.clipRevision == clip->GetRevision())) {
+			continue;
+		}
+		float time = m_Timeline->GetFrameTime(ghost.frame);
+		const float* pose = cache->FindPose(clip, ghost.frame, time);
+		if (pose == nullptr) {
+			pose = cache->StorePose(clip, ghost.frame, time);
+		}
+		ghost.clipRevision = clip->GetRevision();
+		// Key edits elsewhere in the clip leave this frame's pose, and its ghost, unchanged.
+		if (ghost.valid && ghost.pose.size() == trackCount && std::equal(pose, pose + trackCount, ghost.pose.begin())) {
+			continue;
+		}
+		ghost.pose.assign(pose, pose + trackCount);
+		clip->Apply(pose, graph);
+		graph->UpdateWorldTransforms();
+		SDL_SetRenderTarget(renderer, ghost.texture);
+		SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_TRANSPARENT);
+		SDL_RenderClear(renderer);
+		graph->Render(renderer, m_Meshes);
+		ghost.valid = true;
+		m_LastRenderCount++;
+	}
+	if (m_LastRenderCount > 0) {
+		SDL_SetRenderTarget(renderer, target);
+		m_Timeline->SetPlayhead(playhead);
+		graph->UpdateWorldTransforms();
+	}
+}
+
+void plg::OnionSkin::Render(SDL_Renderer* renderer, const SDL_Rect* destination) {
+	int32_t playhead = m_Timeline->GetPlayhead();
+	int32_t farthest = std::max(m_FramesBefore, m_FramesAfter);
+	// Farther ghosts are drawn first and fainter so the nearest frames stay on top.
+	for (int32_t distance = farthest; distance > 0; distance--) {
+		for (int32_t side = -1; side <= 1; side += 2) {
+			int32_t range = (side < 0) ? m_FramesBefore : m_FramesAfter;
+			Ghost* ghost = (distance <= range) ? FindGhost(playhead + side * distance) : nullptr;
+			if (ghost == nullptr || !ghost->valid) {
+				continue;
+			}
+			SDL_Color tint = (side < 0) ? m_BeforeTint : m_AfterTint;
+			uint8_t alpha = (uint8_t)((int32_t)m_Opacity * (range + 1 - distance) / (range + 1));
+			SDL_SetTextureColorMod(ghost->texture, tint.r, tint.g, tint.b);
+			SDL_SetTextureAlphaMod(ghost->texture, alpha);
+			SDL_RenderCopy(renderer, ghost->texture, NULL, destination);
+		}
+	}
+}
+
+plg::OnionSkin::Ghost* plg::OnionSkin::FindGhost(int32_t frame) {
+	for (Ghost& ghost : m_Ghosts) {
+		if (ghost.frame == frame) {
+			return &ghost;
+		}
+	}
+	return nullptr;
+}
+
+SDL_Texture* plg::OnionSkin::AcquireTexture(SDL_Renderer* renderer) {
+	if (!m_FreeTextures.empty()) {
+		SDL_Texture* texture = m_FreeTextures.back();
+		m_FreeTextures.pop_back();
+		return texture;
+	}
+	SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, m_Width, m_Height);
+	if (texture == NULL) {
+		Log("Unable to create the onion skin texture! ", false);
+		Log(SDL_GetError(), true);
+		return nullptr;
+	}
+	SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+	return texture;
+}
+
+void plg::OnionSkin::ReleaseTextures() {
+	for (Ghost& ghost : m_Ghosts) {
+		if (ghost.texture != nullptr) {
+			SDL_DestroyTexture(ghost.texture);
+		}
+	}
+	for (SDL_Texture* texture : m_FreeTextures) {
+		SDL_DestroyTexture(texture);
+	}
+	m_Ghosts.clear();
+	m_FreeTextures.clear();
+}
\ No newline at end of file
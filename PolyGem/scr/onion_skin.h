@@ -0,0 +1,54 @@
+#pragma once
+#include "timeline.h"
+#include <vector>
+
+namespace plg {
+	// Ghosts of the frames around the playhead, each rendered once into its own target
+	// texture and composited tinted every frame. A ghost is redrawn only when its pose
+	// changes or after Invalidate, and moving the playhead reuses the ghosts of frames
+	// that stay in range, so steady-state playback costs one SDL_RenderCopy per ghost.
+	class OnionSkin {
+	public:
+		OnionSkin(Timeline* timeline, container::List<Mesh>* meshes) : m_Timeline(timeline), m_Meshes(meshes) { }
+		OnionSkin(const OnionSkin&) = delete;
+		OnionSkin& operator=(const OnionSkin&) = delete;
+		~OnionSkin();
+
+		void SetRange(int32_t framesBefore, int32_t framesAfter);
+		void SetTints(SDL_Color before, SDL_Color after) { m_BeforeTint = before; m_AfterTint = after; }
+		void SetOpacity(uint8_t opacity) { m_Opacity = opacity; }
+		// Redraws every ghost on the next Update, for edits the clip does not track such as mesh changes.
+		void Invalidate();
+
+		// Renders stale ghosts at the given size and restores the playhead pose afterwards.
+		void Update(SDL_Renderer* renderer, int width, int height);
+		void Render(SDL_Renderer* renderer, const SDL_Rect* destination);
+		size_t GetLastRenderCount() const { return m_LastRenderCount; }
+
+	private:
+		struct Ghost {
+			int32_t frame;
+			SDL_Texture* texture;
+			std::vector<float> pose;
+			uint32_t clipRevision;
+			bool valid;
+		};
+
+		Ghost* FindGhost(int32_t frame);
+		SDL_Texture* AcquireTexture(SDL_Renderer* renderer);
+		void ReleaseTextures();
+
+		Timeline* m_Timeline;
+		container::List<Mesh>* m_Meshes;
+		std::vector<Ghost> m_Ghosts;
+		std::vector<SDL_Texture*> m_FreeTextures;
+		int32_t m_FramesBefore = 2;
+		int32_t m_FramesAfter = 2;
+		SDL_Color m_BeforeTint = { 216, 80, 80, 255 };
+		SDL_Color m_AfterTint = { 80, 216, 120, 255 };
+		uint8_t m_Opacity = 128;
+		int m_Width = 0;
+		int m_Height = 0;
+		size_t m_LastRenderCount = 0;
+	};
+}
\ No newline at end of file
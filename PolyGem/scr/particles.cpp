@@ -0,0 +1,236 @@
+#include "particles.h"
+#include <random>
+
+static constexpr size_t s_IntegrateGrain = 2048;
+
+static uint64_t s_SplitMix(uint64_t& state) {
+	uint64_t value = (state += 0x9E3779B97F4A7C15ull);
+	value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+	value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+	return value ^ (value >> 31);
+}
+
+static uint8_t s_LerpChannel(uint8_t from, uint8_t to, float t) {
+	return (uint8_t)((float)from + ((float)to - (float)from) * t);
+}
+
+plg::ParticleEmitter::ParticleEmitter(size_t capacity, const EmitterSettings& settings, uint64_t seed)
+	: m_Settings(settings), m_Capacity(capacity) {
+	// Storage is padded to whole SIMD lanes so the kernels never need a scalar tail.
+	size_t storage = (capacity + 3) & ~(size_t)3;
+	m_PositionX.resize(storage);
+	m_PositionY.resize(storage);
+	m_VelocityX.resize(storage);
+	m_VelocityY.resize(storage);
+	m_Life.resize(storage);
+	m_InverseMaxLife.resize(storage);
+	m_Colors.resize(storage);
+	SetSeed(seed);
+}
+
+void plg::ParticleEmitter::SetSeed(uint64_t seed) {
+	if (seed == 0) {
+		std::random_device device;
+		seed = ((uint64_t)device() << 32) | device();
+	}
+	m_RandomState = seed;
+}
+
+float plg::ParticleEmitter::NextRandom() {
+	return (float)(s_SplitMix(m_RandomState) >> 40) * (1.0f / 16777216.0f);
+}
+
+void plg::ParticleEmitter::Emit(size_t count) {
+	count = std::min(count, m_Capacity - m_Count);
+	for (size_t spawned = 0; spawned < count; spawned++) {
+		size_t particle = m_Count++;
+		float angle = m_Settings.direction + (NextRandom() - 0.5f) * m_Settings.spread;
+		float speed = m_Settings.minSpeed + (m_Settings.maxSpeed - m_Settings.minSpeed) * NextRandom();
+		float life = m_Settings.minLife + (m_Settings.maxLife - m_Settings.minLife) * NextRandom();
+		float tint = NextRandom();
+		m_PositionX[particle] = m_Settings.position.x;
+		m_PositionY[particle] = m_Settings.position.y;
+		m_VelocityX[particle] = std::cos(angle) * speed;
+		m_VelocityY[particle] = std::sin(angle) * speed;
+		m_Life[particle] = life;
+		m_InverseMaxLife[particle] = (life > 0.0f) ? 1.0f / life : 0.0f;
+		SDL_Color& color = m_Colors[particle];
+		color.r = s_LerpChannel(m_Settings.startColor.r, m_Settings.endColor.r, tint);
+		color.g = s_LerpChannel(m_Settings.startColor.g, m_Settings.endColor.g, tint);
+		color.b = s_LerpChannel(m_Settings.startColor.b, m_Settings.endColor.b, tint);
+		color.a = s_LerpChannel(m_Settings.startColor.a, m_Settings.endColor.a, tint);
+	}
+}
+
+void plg::ParticleEmitter::Update(float deltaTime) {
+	m_SpawnAccumulator += m_Settings.spawnRate * deltaTime;
+	size_t spawnCount = (size_t)m_SpawnAccumulator;
+	m_SpawnAccumulator -= (float)spawnCount;
+	Emit(spawnCount);
+
+	size_t blockCount = (m_Count + 3) >> 2;
+	container::GetThreadPool().ParallelFor(blockCount, s_IntegrateGrain, [&](size_t beginBlock, size_t endBlock) {
+		size_t begin = beginBlock << 2, end = endBlock << 2;
+		for (const ParticleAttractor& attractor : m_Attractors) {
+			ApplyAttractor(attractor, begin, end, deltaTime);
+		}
+		Integrate(begin, end, deltaTime);
+	});
+	RemoveDead();
+}
+
+void plg::ParticleEmitter::Integrate(size_t begin, size_t end, float deltaTime) {
+	float* positionX = m_PositionX.data();
+	float* positionY = m_PositionY.data();
+	float* velocityX = m_VelocityX.data();
+	float* velocityY = m_VelocityY.data();
+	float* life = m_Life.data();
+	float damping = std::max(0.0f, 1.0f - m_Settings.drag * deltaTime);
+#ifdef PLG_SSE2
+	__m128 dt = _mm_set1_ps(deltaTime);
+	__m128 dampingV = _mm_set1_ps(damping);
+	__m128 gravityX = _mm_set1_ps(m_Settings.gravity.x * deltaTime);
+	__m128 gravityY = _mm_set1_ps(m_Settings.gravity.y * deltaTime);
+	for (size_t index = begin; index < end; index += 4) {
+		__m128 vx = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(velocityX + index), dampingV), gravityX);
+		__m128 vy = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(velocityY + index), dampingV), gravityY);
+		_mm_storeu_ps(velocityX + index, vx);
+		_mm_storeu_ps(velocityY + index, vy);
+		_mm_storeu_ps(positionX + index, _mm_add_ps(_mm_loadu_ps(positionX + index), _mm_mul_ps(vx, dt)));
+		_mm_storeu_ps(positionY + index, _mm_add_ps(_mm_loadu_ps(positionY + index), _mm_mul_ps(vy, dt)));
+		_mm_storeu_ps(life + index, _mm_sub_ps(_mm_loadu_ps(life + index), dt));
+	}
+#else
+	float gravityX = m_Settings.gravity.x * deltaTime;
+	float gravityY = m_Settings.gravity.y * deltaTime;
+	for (size_t index = begin; index < end; index++) {
+		velocityX[index] = velocityX[index] * damping + gravityX;
+		velocityY[index] = velocityY[index] * damping + gravityY;
+		positionX[index] += velocityX[index] * deltaTime;
+		positionY[index] += velocityY[index] * deltaTime;
+		life[index] -= deltaTime;
+	}
+#endif
+}
+
+void plg::ParticleEmitter::ApplyAttractor(const ParticleAttractor& attractor, size_t begin, size_t end, float deltaTime) {
+	const float* positionX = m_PositionX.data();
+	const float* positionY = m_PositionY.data();
+	float* velocityX = m_VelocityX.data();
+	float* velocityY = m_VelocityY.data();
+	// The pull falls off with distance; the softening term keeps it finite at the centre.
+	const float softening = 1.0f;
+#ifdef PLG_SSE2
+	__m128 centerX = _mm_set1_ps(attractor.position.x);
+	__m128 centerY = _mm_set1_ps(attractor.position.y);
+	__m128 impulse = _mm_set1_ps(attractor.strength * deltaTime);
+	__m128 soft = _mm_set1_ps(softening);
+	for (size_t index = begin; index < end; index += 4) {
+		__m128 dx = _mm_sub_ps(centerX, _mm_loadu_ps(positionX + index));
+		__m128 dy = _mm_sub_ps(centerY, _mm_loadu_ps(positionY + index));
+		__m128 distanceSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), soft);
+		__m128 scale = _mm_div_ps(impulse, distanceSquared);
+		_mm_storeu_ps(velocityX + index, _mm_add_ps(_mm_loadu_ps(velocityX + index), _mm_mul_ps(dx, scale)));
+		_mm_storeu_ps(velocityY + index, _mm_add_ps(_mm_loadu_ps(velocityY + index), _mm_mul_ps(dy, scale)));
+	}
+#else
+	float impulse = attractor.strength * deltaTime;
+	for (size_t index = begin; index < end; index++) {
+		float dx = attractor.position.x - positionX[index];
+		float dy = attractor.position.y - positionY[index];
+		float scale = impulse / (dx * dx + dy * dy + softening);
+		velocityX[index] += dx * scale;
+		velocityY[index] += dy * scale;
+	}
+#endif
+}
+
+void plg::ParticleEmitter::RemoveDead() {
+	size_t particle = 0;
+	while (particle < m_Count) {
+		if (m_Life[particle] > 0.0f) {
+			particle++;
+			continue;
+		}
+		size_t last = --m_Count;
+		m_PositionX[particle] = m_PositionX[last];
+		m_PositionY[particle] = m_PositionY[last];
+		m_VelocityX[particle] = m_VelocityX[last];
+		m_VelocityY[particle] = m_VelocityY[last];
+		m_Life[particle] = m_Life[last];
+		m_InverseMaxLife[particle] = m_InverseMaxLife[last];
+		m_Colors[particle] = m_Colors[last];
+	}
+}
+
+void plg::ParticleEmitter::Render(SDL_Renderer* renderer, SDL_Texture* texture) {
+	if (m_Count == 0) {
+		return;
+	}
+	SDL_Vertex* vertices = container::frameArena.AllocateArray<SDL_Vertex>(m_Count * 4);
+	int* indices = container::frameArena.AllocateArray<int>(m_Count * 6);
+	float halfSize = m_Settings.size * 0.5f;
+	const SDL_FPoint corners[4] = { { -halfSize, -halfSize }, { halfSize, -halfSize }, { halfSize, halfSize }, { -halfSize, halfSize } };
+	const SDL_FPoint uvs[4] = { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } };
+	for (size_t particle = 0; particle < m_Count; particle++) {
+		SDL_Color color = m_Colors[particle];
+		float fade = std::min(1.0f, m_Life[particle] * m_InverseMaxLife[particle]);
+		color.a = (uint8_t)((float)color.a * fade);
+		SDL_Vertex* quad = vertices + particle * 4;
+		for (size_t corner = 0; corner < 4; corner++) {
+			quad[corner].position.x = m_PositionX[particle] + corners[corner].x;
+			quad[corner].position.y = m_PositionY[particle] + corners[corner].y;
+			quad[corner].color = color;
+			quad[corner].tex_coord = uvs[corner];
+		}
+		int first = (int)(particle * 4);
+		int* quadIndices = indices + particle * 6;
+		quadIndices[0] = first;
+		quadIndices[1] = first + 1;
+		quadIndices[2] = first + 2;
+		quadIndices[3] = first;
+		quadIndices[4] = first + 2;
+		quadIndices[5] = first + 3;
+	}
+	SDL_RenderGeometry(renderer, texture, vertices, (int)(m_Count * 4), indices, (int)(m_Count * 6));
+}
+
+int32_t plg::ParticleSystem::AddEmitter(size_t capacity, const EmitterSettings& settings) {
+	uint64_t seed = m_Seed;
+	if (seed != 0) {
+		seed = s_SplitMix(seed) + m_Emitters.size();
+	}
+	m_Emitters.emplace_back(capacity, settings, seed);
+	return (int32_t)(m_Emitters.size() - 1);
+}
+
+void plg::ParticleSystem::SetSeed(uint64_t seed) {
+	m_Seed = seed;
+	for (size_t emitter = 0; emitter < m_Emitters.size(); emitter++) {
+		uint64_t state = seed;
+		m_Emitters[emitter].Clear();
+		m_Emitters[emitter].SetSeed((seed == 0) ? 0 : s_SplitMix(state) + emitter);
+	}
+}
+
+void plg::ParticleSystem::Update(float deltaTime) {
+	container::GetThreadPool().ParallelFor(m_Emitters.size(), 1, [&](size_t begin, size_t end) {
+		for (size_t emitter = begin; emitter < end; emitter++) {
+			m_Emitters[emitter].Update(deltaTime);
+		}
+	});
+}
+
+void plg::ParticleSystem::Render(SDL_Renderer* renderer, SDL_Texture* texture) {
+	for (ParticleEmitter& emitter : m_Emitters) {
+		emitter.Render(renderer, texture);
+	}
+}
+
+size_t plg::ParticleSystem::GetParticleCount() const {
+	size_t count = 0;
+	for (const ParticleEmitter& emitter : m_Emitters) {
+		count += emitter.GetCount();
+	}
+	return count;
+}
\ No newline at end of file
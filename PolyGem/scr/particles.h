@@ -0,0 +1,89 @@
+#pragma once
+#include "core.h"
+#include "SDL.h"
+#include <vector>
+
+namespace plg {
+	struct EmitterSettings {
+		Vec2 position;
+		float spawnRate = 100.0f;
+		float direction = -1.5707964f;
+		float spread = 0.5f;
+		float minSpeed = 40.0f;
+		float maxSpeed = 80.0f;
+		float minLife = 1.0f;
+		float maxLife = 2.0f;
+		float size = 3.0f;
+		float drag = 0.0f;
+		Vec2 gravity;
+		SDL_Color startColor = { 255, 200, 80, 255 };
+		SDL_Color endColor = { 255, 60, 20, 255 };
+	};
+
+	// A point that pulls particles in, or pushes them away with a negative strength.
+	struct ParticleAttractor {
+		Vec2 position;
+		float strength = 0.0f;
+	};
+
+	// Fixed-capacity particle pool stored as structure of arrays. Dead particles are swap
+	// removed, so the live ones stay packed at the front and the integration kernels run
+	// over contiguous lanes. Every emitter owns its random state, so a fixed seed and a
+	// fixed time step replay the same simulation no matter which thread updates it.
+	class ParticleEmitter {
+	public:
+		ParticleEmitter(size_t capacity, const EmitterSettings& settings = EmitterSettings(), uint64_t seed = 0);
+
+		void Update(float deltaTime);
+		void Emit(size_t count);
+		void Render(SDL_Renderer* renderer, SDL_Texture* texture = nullptr);
+		void Clear() { m_Count = 0; m_SpawnAccumulator = 0.0f; }
+		void SetSeed(uint64_t seed);
+		void SetAttractors(const ParticleAttractor* attractors, size_t count) { m_Attractors.assign(attractors, attractors + count); }
+
+		EmitterSettings* GetSettings() { return &m_Settings; }
+		size_t GetCount() const { return m_Count; }
+		size_t GetCapacity() const { return m_Capacity; }
+		Vec2 GetPosition(size_t particle) const { return Vec2(m_PositionX[particle], m_PositionY[particle]); }
+		float GetLife(size_t particle) const { return m_Life[particle]; }
+
+	private:
+		void Integrate(size_t begin, size_t end, float deltaTime);
+		void ApplyAttractor(const ParticleAttractor& attractor, size_t begin, size_t end, float deltaTime);
+		void RemoveDead();
+		float NextRandom();
+
+		EmitterSettings m_Settings;
+		size_t m_Capacity;
+		size_t m_Count = 0;
+		float m_SpawnAccumulator = 0.0f;
+		uint64_t m_RandomState = 0;
+		std::vector<float> m_PositionX;
+		std::vector<float> m_PositionY;
+		std::vector<float> m_VelocityX;
+		std::vector<float> m_VelocityY;
+		std::vector<float> m_Life;
+		std::vector<float> m_InverseMaxLife;
+		std::vector<SDL_Color> m_Colors;
+		std::vector<ParticleAttractor> m_Attractors;
+	};
+
+	class ParticleSystem {
+	public:
+		ParticleSystem() { }
+
+		// With a seed every emitter gets a seed derived from it in creation order.
+		int32_t AddEmitter(size_t capacity, const EmitterSettings& settings);
+		void SetSeed(uint64_t seed);
+		void Update(float deltaTime);
+		void Render(SDL_Renderer* renderer, SDL_Texture* texture = nullptr);
+
+		ParticleEmitter* GetEmitter(int32_t emitter) { return &m_Emitters[emitter]; }
+		size_t GetEmitterCount() const { return m_Emitters.size(); }
+		size_t GetParticleCount() const;
+
+	private:
+		std::vector<ParticleEmitter> m_Emitters;
+		uint64_t m_Seed = 0;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,387 @@
+#include "polygon_boolean.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <unordered_set>
+
+static constexpr uint8_t s_SubjectRegion = 1;
+static constexpr uint8_t s_ClipRegion = 2;
+
+static double s_Orient(const plg::Vec2& a, const plg::Vec2& b, const plg::Vec2& c) {
+	return ((double)b.x - a.x) * ((double)c.y - a.y) - ((double)b.y - a.y) * ((double)c.x - a.x);
+}
+
+static bool s_Equal(const plg::Vec2& a, const plg::Vec2& b) {
+	return a.x == b.x && a.y == b.y;
+}
+
+// Sweep order: left to right, bottom to top on the same vertical.
+static bool s_Before(const plg::Vec2& a, const plg::Vec2& b) {
+	return (a.x != b.x) ? a.x < b.x : a.y < b.y;
+}
+
+static bool s_Inside(const plg::Vec2& start, const plg::Vec2& end, const plg::Vec2& point) {
+	return s_Before(start, point) && s_Before(point, end);
+}
+
+static const plg::Vec2& s_Nearer(const plg::Vec2& start, const plg::Vec2& end, const plg::Vec2& point) {
+	double startX = (double)point.x - start.x, startY = (double)point.y - start.y;
+	double endX = (double)point.x - end.x, endY = (double)point.y - end.y;
+	return (startX * startX + startY * startY <= endX * endX + endY * endY) ? start : end;
+}
+
+static uint64_t s_EdgeKey(int32_t start, int32_t end) {
+	return (start < end) ? ((uint64_t)(uint32_t)start << 32) | (uint32_t)end : ((uint64_t)(uint32_t)end << 32) | (uint32_t)start;
+}
+
+bool plg::PolygonBoolean::StatusOrder::operator()(int32_t first, int32_t second) const {
+	return sweep->SegmentBelow(first, second);
+}
+
+plg::Mesh plg::PolygonBoolean::Compute(std::span<const Vec2> subject, std::span<const uint32_t> subjectEnds, std::span<const Vec2> clip,
+	std::span<const uint32_t> clipEnds, BooleanOperation operation) {
+	m_Events.clear();
+	m_Queue.clear();
+	AddContours(subject, subjectEnds, s_SubjectRegion);
+	AddContours(clip, clipEnds, s_ClipRegion);
+	Sweep();
+	return BuildMesh(operation);
+}
+
+plg::Mesh plg::PolygonBoolean::Compute(Mesh& subject, Mesh& clip, BooleanOperation operation) {
+	m_Events.clear();
+	m_Queue.clear();
+	AddMesh(subject, s_SubjectRegion);
+	AddMesh(clip, s_ClipRegion);
+	Sweep();
+	return BuildMesh(operation);
+}
+
+void plg::PolygonBoolean::AddContours(std::span<const Vec2> points, std::span<const uint32_t> contourEnds, uint8_t region) {
+	size_t contourCount = contourEnds.empty() ? 1 : contourEnds.size();
+	uint32_t first = 0;
+	for (size_t contour = 0; contour < contourCount; contour++) {
+		uint32_t last = contourEnds.empty() ? (uint32_t)points.size() : std::min(contourEnds[contour], (uint32_t)points.size());
+		for (uint32_t point = first; point < last; point++) {
+			AddSegment(points[point], points[(point + 1 == last) ? first : point + 1], region);
+		}
+		first = last;
+	}
+}
+
+void plg::PolygonBoolean::AddMesh(Mesh& mesh, uint8_t region) {
+	container::List<Vertex>* vertices = mesh.GetVertexList();
+	auto isVertex = [&](int32_t vertex) {
+		return vertex >= 0 && (size_t)vertex < vertices->GetCapacity() && !vertices->IsEmptySlot(vertex);
+	};
+	if (mesh.GetFaceList()->GetSize() == 0) {
+		for (auto edge = mesh.GetEdgeIter(); edge < edge.end_ptr; edge++) {
+			if (isVertex(edge->m_Start) && isVertex(edge->m_End)) {
+				AddSegment((*vertices)[edge->m_Start], (*vertices)[edge->m_End], region);
+			}
+		}
+		return;
+	}
+	// Sides shared by two faces cancel out, which leaves the outline.
+	std::unordered_set<uint64_t> outline;
+	for (auto face = mesh.GetFaceIter(); face < face.end_ptr; face++) {
+		const int32_t corners[3] = { face->m_Vert1, face->m_Vert2, face->m_Vert3 };
+		for (int32_t corner = 0; corner < 3; corner++) {
+			uint64_t key = s_EdgeKey(corners[corner], corners[(corner + 1) % 3]);
+			if (!outline.erase(key)) {
+				outline.insert(key);
+			}
+		}
+	}
+	for (uint64_t key : outline) {
+		int32_t start = (int32_t)(key >> 32), end = (int32_t)(key & 0xFFFFFFFF);
+		if (isVertex(start) && isVertex(end)) {
+			AddSegment((*vertices)[start], (*vertices)[end], region);
+		}
+	}
+}
+
+void plg::PolygonBoolean::AddSegment(Vec2 start, Vec2 end, uint8_t region) {
+	if (s_Equal(start, end)) {
+		return;
+	}
+	if (s_Before(end, start)) {
+		std::swap(start, end);
+	}
+	int32_t left = AddEvent(start, -1, region, true);
+	int32_t right = AddEvent(end, left, region, false);
+	m_Events[left].other = right;
+	PushEvent(left);
+	PushEvent(right);
+}
+
+int32_t plg::PolygonBoolean::AddEvent(Vec2 point, int32_t other, uint8_t region, bool left) {
+	m_Events.push_back({ point, other, -1, region, left, Status::iterator() });
+	return (int32_t)m_Events.size() - 1;
+}
+
+void plg::PolygonBoolean::PushEvent(int32_t event) {
+	m_Queue.push_back(event);
+	std::push_heap(m_Queue.begin(), m_Queue.end(), [this](int32_t first, int32_t second) { return EventAfter(first, second); });
+}
+
+bool plg::PolygonBoolean::EventAfter(int32_t first, int32_t second) const {
+	const SweepEvent& eventA = m_Events[first];
+	const SweepEvent& eventB = m_Events[second];
+	if (!s_Equal(eventA.point, eventB.point)) {
+		return s_Before(eventB.point, eventA.point);
+	}
+	// At a shared point the edges ending there leave before the ones starting there arrive.
+	if (eventA.left != eventB.left) {
+		return eventA.left;
+	}
+	// Otherwise the lower edge goes first.
+	const Vec2& otherA = m_Events[eventA.other].point;
+	const Vec2& otherB = m_Events[eventB.other].point;
+	double orient = eventA.left ? s_Orient(eventA.point, otherA, otherB) : s_Orient(otherA, eventA.point, otherB);
+	if (orient != 0.0) {
+		return orient < 0.0;
+	}
+	return first > second;
+}
+
+bool plg::PolygonBoolean::SegmentBelow(int32_t first, int32_t second) const {
+	if (first == second) {
+		return false;
+	}
+	const Vec2& startA = m_Events[first].point;
+	const Vec2& endA = m_Events[m_Events[first].other].point;
+	const Vec2& startB = m_Events[second].point;
+	const Vec2& endB = m_Events[m_Events[second].other].point;
+	double orientStart = s_Orient(startA, endA, startB), orientEnd = s_Orient(startA, endA, endB);
+	if (orientStart != 0.0 || orientEnd != 0.0) {
+		if (s_Equal(startA, startB)) {
+			return orientEnd > 0.0;
+		}
+		if (startA.x == startB.x) {
+			return startA.y < startB.y;
+		}
+		// Whichever edge arrived later is placed against the line of the one already there.
+		if (EventAfter(first, second)) {
+			return s_Orient(startB, endB, startA) <= 0.0;
+		}
+		return orientStart > 0.0;
+	}
+	// Collinear edges keep their sweep order; identical ones fall back to the event index.
+	if (s_Equal(startA, startB) && s_Equal(endA, endB)) {
+		return first < second;
+	}
+	return EventAfter(second, first);
+}
+
+void plg::PolygonBoolean::Intersect(int32_t first, int32_t second) {
+	// Copies, as splitting grows the event storage.
+	const Vec2 startA = m_Events[first].point, endA = m_Events[m_Events[first].other].point;
+	const Vec2 startB = m_Events[second].point, endB = m_Events[m_Events[second].other].point;
+	double orient1 = s_Orient(startA, endA, startB), orient2 = s_Orient(startA, endA, endB);
+	if ((orient1 > 0.0 && orient2 > 0.0) || (orient1 < 0.0 && orient2 < 0.0)) {
+		return;
+	}
+	double orient3 = s_Orient(startB, endB, startA), orient4 = s_Orient(startB, endB, endA);
+	if ((orient3 > 0.0 && orient4 > 0.0) || (orient3 < 0.0 && orient4 < 0.0)) {
+		return;
+	}
+	if (orient1 == 0.0 && orient2 == 0.0) {
+		// Overlapping edges are split at each other's ends so the overlap becomes one shared
+		// piece; the far split goes first so the near one still lands on the left part.
+		if (!s_Before(startB, endA) || !s_Before(startA, endB)) {
+			return;
+		}
+		size_t splits = 0;
+		if (s_Before(endB, endA)) {
+			Split(first, endB);
+			splits++;
+		}
+		if (s_Before(startA, startB)) {
+			Split(first, startB);
+			splits++;
+		}
+		if (s_Before(endA, endB)) {
+			Split(second, endA);
+			splits++;
+		}
+		if (s_Before(startB, startA)) {
+			Split(second, startA);
+			splits++;
+		}
+		m_IntersectionCount += (splits > 0) ? 1 : 0;
+		return;
+	}
+	Vec2 point;
+	if (orient1 == 0.0) {
+		point = startB;
+	}
+	else if (orient2 == 0.0) {
+		point = endB;
+	}
+	else if (orient3 == 0.0) {
+		point = startA;
+	}
+	else if (orient4 == 0.0) {
+		point = endA;
+	}
+	else {
+		double t = orient3 / (orient3 - orient4);
+		point = Vec2((float)(startA.x + t * ((double)endA.x - startA.x)), (float)(startA.y + t * ((double)endA.y - startA.y)));
+	}
+	// Rounding can leave a crossing just past the end of an edge; it is snapped onto that end.
+	if (!s_Inside(startA, endA, point)) {
+		point = s_Nearer(startA, endA, point);
+	}
+	if (!s_Inside(startB, endB, point)) {
+		point = s_Nearer(startB, endB, point);
+	}
+	bool splitA = s_Inside(startA, endA, point), splitB = s_Inside(startB, endB, point);
+	if (splitA) {
+		Split(first, point);
+	}
+	if (splitB) {
+		Split(second, point);
+	}
+	m_IntersectionCount += (splitA || splitB) ? 1 : 0;
+}
+
+void plg::PolygonBoolean::Split(int32_t event, Vec2 point) {
+	// The left part keeps its place in the status; the right part is queued as a new edge.
+	int32_t right = m_Events[event].other;
+	uint8_t region = m_Events[event].region;
+	int32_t splitRight = AddEvent(point, event, region, false);
+	int32_t splitLeft = AddEvent(point, right, region, true);
+	m_Events[event].other = splitRight;
+	m_Events[right].other = splitLeft;
+	PushEvent(splitRight);
+	PushEvent(splitLeft);
+}
+
+void plg::PolygonBoolean::Sweep() {
+	auto after = [this](int32_t first, int32_t second) { return EventAfter(first, second); };
+	m_Points.clear();
+	m_Segments.clear();
+	m_SegmentRegions.clear();
+	m_Status.clear();
+	m_IntersectionCount = 0;
+	while (!m_Queue.empty()) {
+		std::pop_heap(m_Queue.begin(), m_Queue.end(), after);
+		int32_t event = m_Queue.back();
+		m_Queue.pop_back();
+		// Equal points leave the queue back to back, so each one gets a single index.
+		const Vec2 point = m_Events[event].point;
+		if (m_Points.empty() || !s_Equal(m_Points.back(), point)) {
+			m_Points.push_back(point);
+		}
+		m_Events[event].pointIndex = (int32_t)m_Points.size() - 1;
+
+		if (m_Events[event].left) {
+			Status::iterator position = m_Status.insert(event).first;
+			m_Events[event].position = position;
+			Status::iterator next = std::next(position);
+			if (next != m_Status.end()) {
+				Intersect(event, *next);
+			}
+			if (position != m_Status.begin()) {
+				Intersect(*std::prev(position), event);
+			}
+			continue;
+		}
+		int32_t left = m_Events[event].other;
+		m_Segments.push_back(Edge(m_Events[left].pointIndex, m_Events[event].pointIndex));
+		m_SegmentRegions.push_back(m_Events[event].region);
+		Status::iterator position = m_Events[left].position;
+		Status::iterator next = std::next(position);
+		Status::iterator previous = (position != m_Status.begin()) ? std::prev(position) : m_Status.end();
+		m_Status.erase(position);
+		if (previous != m_Status.end() && next != m_Status.end()) {
+			Intersect(*previous, *next);
+		}
+	}
+}
+
+plg::Mesh plg::PolygonBoolean::BuildMesh(BooleanOperation operation) {
+	m_Triangulator.TriangulateRegions(m_Points, m_Segments, m_SegmentRegions);
+	std::span<const uint32_t> triangles = m_Triangulator.GetTriangles();
+	std::span<const uint8_t> regions = m_Triangulator.GetTriangleRegions();
+	m_Remap.assign(m_Points.size(), -1);
+	std::vector<Vertex> vertices;
+	std::vector<Face> faces;
+	std::vector<Edge> edges;
+	std::unordered_set<uint64_t> edgeKeys;
+	for (size_t triangle = 0; triangle < regions.size(); triangle++) {
+		uint8_t region = regions[triangle];
+		bool keep = (operation == BooleanOperation::UNION) ? region != 0 :
+			(operation == BooleanOperation::DIFFERENCE) ? region == s_SubjectRegion : region == (s_SubjectRegion | s_ClipRegion);
+		if (!keep) {
+			continue;
+		}
+		int32_t corners[3];
+		for (int32_t corner = 0; corner < 3; corner++) {
+			uint32_t point = triangles[triangle * 3 + corner];
+			if (m_Remap[point] == -1) {
+				m_Remap[point] = (int32_t)vertices.size();
+				vertices.push_back(m_Points[point]);
+			}
+			corners[corner] = m_Remap[point];
+		}
+		faces.push_back(Face(corners[0], corners[1], corners[2]));
+		for (int32_t corner = 0; corner < 3; corner++) {
+			int32_t start = corners[corner], end = corners[(corner + 1) % 3];
+			if (edgeKeys.insert(s_EdgeKey(start, end)).second) {
+				edges.push_back(Edge(start, end));
+			}
+		}
+	}
+	return Mesh(vertices, edges, faces, false);
+}
+
+// A wobbly circle with a little noise on every point, about one point spacing high, so
+// outlines of any size cross each other a few times per wobble rather than everywhere.
+static void s_RandomOutline(std::mt19937& random, plg::Vec2 center, float radius, size_t pointCount, std::vector<plg::Vec2>& points) {
+	std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+	float phase = 3.0f * noise(random);
+	float spacing = 6.2831853f / (float)pointCount;
+	points.resize(pointCount);
+	for (size_t point = 0; point < pointCount; point++) {
+		float angle = spacing * (float)point;
+		float distance = radius * (0.8f + 0.15f * std::sin(7.0f * angle + phase) + spacing * noise(random));
+		points[point] = plg::Vec2(center.x + distance * std::cos(angle), center.y + distance * std::sin(angle));
+	}
+}
+
+void plg::BenchmarkPolygonBoolean(size_t repeatCount) {
+	const size_t pointCounts[] = { 1000, 10000, 50000 };
+	const BooleanOperation operations[] = { BooleanOperation::UNION, BooleanOperation::DIFFERENCE, BooleanOperation::INTERSECTION };
+	const char* names[] = { "union ", "difference ", "intersection " };
+	std::mt19937 random(1234);
+	std::vector<Vec2> subject, clip;
+	PolygonBoolean boolean;
+	for (size_t pointCount : pointCounts) {
+		s_RandomOutline(random, Vec2(0.0f, 0.0f), 1000.0f, pointCount, subject);
+		s_RandomOutline(random, Vec2(300.0f, 200.0f), 1000.0f, pointCount, clip);
+		for (size_t operation = 0; operation < 3; operation++) {
+			size_t faceCount = 0;
+			auto start = std::chrono::high_resolution_clock::now();
+			for (size_t repeat = 0; repeat < repeatCount; repeat++) {
+				Mesh result = boolean.Compute(subject, {}, clip, {}, operations[operation]);
+				faceCount = result.GetFaceList()->GetSize();
+			}
+			double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+			Log("Boolean ");
+			Log(names[operation]);
+			Log(pointCount);
+			Log(" + ");
+			Log(pointCount);
+			Log(" edges: ");
+			Log(seconds * 1000.0 / (double)repeatCount);
+			Log(" ms, ");
+			Log(boolean.GetIntersectionCount());
+			Log(" crossings, ");
+			Log(faceCount);
+			Log(" faces", true);
+		}
+	}
+}
\ No newline at end of file
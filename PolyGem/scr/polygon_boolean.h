@@ -0,0 +1,78 @@
+#pragma once
+#include "core_scene.h"
+#include "triangulator.h"
+#include <set>
+#include <span>
+#include <vector>
+
+namespace plg {
+	enum class BooleanOperation {
+		UNION, DIFFERENCE, INTERSECTION
+	};
+
+	// Boolean operations on 2D polygons. A sweep line runs over the outline edges of both
+	// shapes, keeping the edges it crosses ordered from bottom to top, and only neighbours
+	// in that order are tested against each other; every hit splits both edges, so the
+	// sweep is O((n + k) log n) for k crossings instead of testing all pairs. The split
+	// edges are triangulated with the subject and clip as two regions, and the triangles
+	// the operation keeps become the faces of the result.
+	class PolygonBoolean {
+	public:
+		PolygonBoolean() { }
+		// The sweep status refers back to its owner, so instances stay where they are made.
+		PolygonBoolean(const PolygonBoolean& other) = delete;
+		PolygonBoolean& operator=(const PolygonBoolean& other) = delete;
+
+		// Outlines are stored back to back, contourEnds[i] being one past the last point of
+		// contour i as in Triangulator::TriangulatePolygon; inner contours are holes.
+		Mesh Compute(std::span<const Vec2> subject, std::span<const uint32_t> subjectEnds, std::span<const Vec2> clip,
+			std::span<const uint32_t> clipEnds, BooleanOperation operation);
+		// Takes the outline of each mesh's faces, or its edges when it has no faces.
+		Mesh Compute(Mesh& subject, Mesh& clip, BooleanOperation operation);
+
+		// Crossings between outline edges found by the last operation.
+		size_t GetIntersectionCount() const { return m_IntersectionCount; }
+
+	private:
+		struct StatusOrder {
+			const PolygonBoolean* sweep;
+			bool operator()(int32_t first, int32_t second) const;
+		};
+		using Status = std::set<int32_t, StatusOrder>;
+
+		// Each edge has a left event and a right event in sweep order, linked by other.
+		struct SweepEvent {
+			Vec2 point;
+			int32_t other;
+			int32_t pointIndex;
+			uint8_t region;
+			bool left;
+			Status::iterator position;
+		};
+
+		void AddContours(std::span<const Vec2> points, std::span<const uint32_t> contourEnds, uint8_t region);
+		void AddMesh(Mesh& mesh, uint8_t region);
+		void AddSegment(Vec2 start, Vec2 end, uint8_t region);
+		int32_t AddEvent(Vec2 point, int32_t other, uint8_t region, bool left);
+		void PushEvent(int32_t event);
+		bool EventAfter(int32_t first, int32_t second) const;
+		bool SegmentBelow(int32_t first, int32_t second) const;
+		void Intersect(int32_t first, int32_t second);
+		void Split(int32_t event, Vec2 point);
+		void Sweep();
+		Mesh BuildMesh(BooleanOperation operation);
+
+		std::vector<SweepEvent> m_Events;
+		std::vector<int32_t> m_Queue;
+		Status m_Status{ StatusOrder{ this } };
+		std::vector<Vec2> m_Points;
+		std::vector<Edge> m_Segments;
+		std::vector<uint8_t> m_SegmentRegions;
+		std::vector<int32_t> m_Remap;
+		Triangulator m_Triangulator;
+		size_t m_IntersectionCount = 0;
+	};
+
+	// Logs how long each operation takes on pairs of random polygons of a few sizes.
+	void BenchmarkPolygonBoolean(size_t repeatCount = 10);
+}
\ No newline at end of file
@@ -0,0 +1,246 @@
+#include "scene_graph.h"
+#include <algorithm>
+
+template<typename T>
+static void s_EraseRange(std::vector<T>& values, size_t begin, size_t count) {
+	values.erase(values.begin() + begin, values.begin() + begin + count);
+}
+
+plg::SceneNodeID plg::SceneGraph::AddNode(SceneNodeType type, SceneNodeID parent, int32_t payload, const std::string& name) {
+	if (parent != NULL_NODE && !IsValid(parent)) {
+		Log("Warning! Parent node does not exist! ID:", true);
+		Log(parent, true);
+		return NULL_NODE;
+	}
+	SceneNodeID node = (SceneNodeID)m_IndexOfNode.size();
+	m_IndexOfNode.push_back(NULL_NODE);
+	std::vector<NodeRecord> records(1);
+	records[0].node = node;
+	records[0].parentOffset = 0;
+	records[0].subtreeSize = 1;
+	records[0].type = type;
+	records[0].payload = payload;
+	records[0].flags = FLAG_VISIBLE;
+	records[0].name = name;
+
+	int32_t parentIndex = (parent == NULL_NODE) ? NULL_NODE : m_IndexOfNode[parent];
+	size_t position = (parentIndex == NULL_NODE) ? m_Nodes.size() : (size_t)(parentIndex + m_SubtreeSizes[parentIndex]);
+	InsertRange(position, parentIndex, records);
+	MarkDirty(node);
+	return node;
+}
+
+void plg::SceneGraph::RemoveNode(SceneNodeID node) {
+	if (!IsValid(node)) {
+		Log("Warning! Node does not exist! ID:", true);
+		Log(node, true);
+		return;
+	}
+	size_t begin = (size_t)m_IndexOfNode[node];
+	size_t count = (size_t)m_SubtreeSizes[begin];
+	for (size_t index = begin; index < begin + count; index++) {
+		m_IndexOfNode[m_Nodes[index]] = NULL_NODE;
+	}
+	EraseRange(begin, count);
+}
+
+bool plg::SceneGraph::SetParent(SceneNodeID node, SceneNodeID parent) {
+	if (!IsValid(node) || (parent != NULL_NODE && !IsValid(parent))) {
+		return false;
+	}
+	size_t begin = (size_t)m_IndexOfNode[node];
+	size_t count = (size_t)m_SubtreeSizes[begin];
+	if (parent != NULL_NODE) {
+		size_t parentIndex = (size_t)m_IndexOfNode[parent];
+		if (parentIndex >= begin && parentIndex < begin + count) {
+			Log("Warning! A node can not be parented to its own subtree!", true);
+			return false;
+		}
+	}
+	std::vector<NodeRecord> records;
+	ExtractRange(begin, count, records);
+	EraseRange(begin, count);
+
+	int32_t parentIndex = (parent == NULL_NODE) ? NULL_NODE : m_IndexOfNode[parent];
+	size_t position = (parentIndex == NULL_NODE) ? m_Nodes.size() : (size_t)(parentIndex + m_SubtreeSizes[parentIndex]);
+	InsertRange(position, parentIndex, records);
+	MarkDirty(node);
+	return true;
+}
+
+plg::SceneNodeID plg::SceneGraph::GetParent(SceneNodeID node) const {
+	int32_t parentIndex = m_Parents[m_IndexOfNode[node]];
+	return (parentIndex == NULL_NODE) ? NULL_NODE : m_Nodes[parentIndex];
+}
+
+void plg::SceneGraph::SetLocalTransform(SceneNodeID node, const Transform2D& transform) {
+	m_Locals[m_IndexOfNode[node]] = transform;
+	MarkDirty(node);
+}
+
+void plg::SceneGraph::MarkDirty(SceneNodeID node) {
+	uint8_t& flags = m_Flags[m_IndexOfNode[node]];
+	if ((flags & FLAG_DIRTY) == 0) {
+		flags |= FLAG_DIRTY;
+		m_DirtyNodes.push_back(node);
+	}
+}
+
+void plg::SceneGraph::UpdateWorldTransforms() {
+	m_LastUpdateCount = 0;
+	if (m_DirtyNodes.empty()) {
+		return;
+	}
+	m_DirtyIndices.clear();
+	for (SceneNodeID node : m_DirtyNodes) {
+		if (IsValid(node)) {
+			m_DirtyIndices.push_back(m_IndexOfNode[node]);
+		}
+	}
+	m_DirtyNodes.clear();
+	std::sort(m_DirtyIndices.begin(), m_DirtyIndices.end());
+
+	// Subtrees are contiguous, so a dirty node nested in an already updated range is skipped.
+	size_t updatedEnd = 0;
+	for (int32_t dirtyIndex : m_DirtyIndices) {
+		size_t begin = (size_t)dirtyIndex;
+		m_Flags[begin] &= ~FLAG_DIRTY;
+		if (begin < updatedEnd) {
+			continue;
+		}
+		size_t end = begin + (size_t)m_SubtreeSizes[begin];
+		for (size_t index = begin; index < end; index++) {
+			int32_t parentIndex = m_Parents[index];
+			if (parentIndex == NULL_NODE) {
+				m_Worlds[index] = m_Locals[index].ToMatrix();
+			}
+			else {
+				m_Worlds[index] = m_Worlds[parentIndex] * m_Locals[index].ToMatrix();
+			}
+		}
+		m_LastUpdateCount += end - begin;
+		updatedEnd = end;
+	}
+}
+
+void plg::SceneGraph::Render(SDL_Renderer* renderer, container::List<Mesh>* meshes) {
+	size_t index = 0;
+	while (index < m_Nodes.size()) {
+		if ((m_Flags[index] & FLAG_VISIBLE) == 0) {
+			index += (size_t)m_SubtreeSizes[index];
+			continue;
+		}
+		if (m_Types[index] == SceneNodeType::MESH && m_Payloads[index] >= 0) {
+			Mesh& mesh = meshes->operator[](m_Payloads[index]);
+			UpdateLOD(mesh, (size_t)m_Payloads[index]);
+			mesh.Render(renderer, m_Worlds[index]);
+		}
+		index++;
+	}
+}
+
+void plg::SceneGraph::UpdateLOD(Mesh& mesh, size_t meshIndex) {
+	if (mesh.GetFaceList()->GetSize() < LOD_MIN_FACES) {
+		mesh.SetLOD(nullptr);
+		return;
+	}
+	if (meshIndex >= m_MeshLODs.size()) {
+		m_MeshLODs.resize(meshIndex + 1);
+		m_DrawnRevisions.resize(meshIndex + 1, 0);
+	}
+	std::unique_ptr<MeshLOD>& lod = m_MeshLODs[meshIndex];
+	if (lod == nullptr) {
+		lod = std::make_unique<MeshLOD>();
+	}
+	// Rebuilding waits for a frame with no edits, so dragging new vertices in does not pay
+	// for a build every frame.
+	if (lod->GetRevision() != mesh.GetRevision() && m_DrawnRevisions[meshIndex] == mesh.GetRevision()) {
+		lod->Build(mesh);
+	}
+	m_DrawnRevisions[meshIndex] = mesh.GetRevision();
+	mesh.SetLOD(lod.get());
+}
+
+void plg::SceneGraph::SetFlag(SceneNodeID node, uint8_t flag, bool state) {
+	uint8_t& flags = m_Flags[m_IndexOfNode[node]];
+	flags = state ? (flags | flag) : (flags & ~flag);
+}
+
+void plg::SceneGraph::ExtractRange(size_t begin, size_t count, std::vector<NodeRecord>& records) const {
+	records.resize(count);
+	for (size_t offset = 0; offset < count; offset++) {
+		size_t index = begin + offset;
+		NodeRecord& record = records[offset];
+		record.node = m_Nodes[index];
+		record.parentOffset = (offset == 0) ? 0 : m_Parents[index] - (int32_t)begin;
+		record.subtreeSize = m_SubtreeSizes[index];
+		record.type = m_Types[index];
+		record.payload = m_Payloads[index];
+		record.flags = m_Flags[index];
+		record.local = m_Locals[index];
+		record.world = m_Worlds[index];
+		record.name = m_Names[index];
+	}
+}
+
+void plg::SceneGraph::EraseRange(size_t begin, size_t count) {
+	for (int32_t ancestor = m_Parents[begin]; ancestor != NULL_NODE; ancestor = m_Parents[ancestor]) {
+		m_SubtreeSizes[ancestor] -= (int32_t)count;
+	}
+	s_EraseRange(m_Nodes, begin, count);
+	s_EraseRange(m_Parents, begin, count);
+	s_EraseRange(m_SubtreeSizes, begin, count);
+	s_EraseRange(m_Types, begin, count);
+	s_EraseRange(m_Payloads, begin, count);
+	s_EraseRange(m_Flags, begin, count);
+	s_EraseRange(m_Locals, begin, count);
+	s_EraseRange(m_Worlds, begin, count);
+	s_EraseRange(m_Names, begin, count);
+	for (int32_t& parentIndex : m_Parents) {
+		if (parentIndex >= (int32_t)(begin + count)) {
+			parentIndex -= (int32_t)count;
+		}
+	}
+	UpdateIndexMap(begin);
+}
+
+void plg::SceneGraph::InsertRange(size_t position, int32_t parentIndex, std::vector<NodeRecord>& records) {
+	size_t count = records.size();
+	for (int32_t& index : m_Parents) {
+		if (index >= (int32_t)position) {
+			index += (int32_t)count;
+		}
+	}
+	m_Nodes.insert(m_Nodes.begin() + position, count, NULL_NODE);
+	m_Parents.insert(m_Parents.begin() + position, count, NULL_NODE);
+	m_SubtreeSizes.insert(m_SubtreeSizes.begin() + position, count, 1);
+	m_Types.insert(m_Types.begin() + position, count, SceneNodeType::GROUP);
+	m_Payloads.insert(m_Payloads.begin() + position, count, -1);
+	m_Flags.insert(m_Flags.begin() + position, count, 0);
+	m_Locals.insert(m_Locals.begin() + position, count, Transform2D());
+	m_Worlds.insert(m_Worlds.begin() + position, count, Affine2D());
+	m_Names.insert(m_Names.begin() + position, count, std::string());
+	for (size_t offset = 0; offset < count; offset++) {
+		size_t index = position + offset;
+		NodeRecord& record = records[offset];
+		m_Nodes[index] = record.node;
+		m_Parents[index] = (offset == 0) ? parentIndex : (int32_t)position + record.parentOffset;
+		m_SubtreeSizes[index] = record.subtreeSize;
+		m_Types[index] = record.type;
+		m_Payloads[index] = record.payload;
+		m_Flags[index] = record.flags;
+		m_Locals[index] = record.local;
+		m_Worlds[index] = record.world;
+		m_Names[index] = std::move(record.name);
+	}
+	for (int32_t ancestor = parentIndex; ancestor != NULL_NODE; ancestor = m_Parents[ancestor]) {
+		m_SubtreeSizes[ancestor] += (int32_t)count;
+	}
+	UpdateIndexMap(position);
+}
+
+void plg::SceneGraph::UpdateIndexMap(size_t begin) {
+	for (size_t index = begin; index < m_Nodes.size(); index++) {
+		m_IndexOfNode[m_Nodes[index]] = (int32_t)index;
+	}
+}
\ No newline at end of file
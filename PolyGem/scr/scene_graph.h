@@ -0,0 +1,100 @@
+#pragma once
+#include "core_scene.h"
+#include "mesh_lod.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace plg {
+	using SceneNodeID = int32_t;
+
+	enum class SceneNodeType : uint8_t {
+		GROUP, MESH, CAMERA, LIGHT
+	};
+
+	// Scene hierarchy stored as flat arrays in depth-first order, so every subtree is
+	// the contiguous range [index, index + subtree size) and parents always precede
+	// their children. Local transforms are written freely, world matrices are only
+	// recomputed for the subtrees under nodes marked dirty since the last update.
+	class SceneGraph {
+	public:
+		static constexpr SceneNodeID NULL_NODE = -1;
+
+		SceneGraph() { }
+
+		SceneNodeID AddNode(SceneNodeType type, SceneNodeID parent = NULL_NODE, int32_t payload = -1, const std::string& name = "");
+		void RemoveNode(SceneNodeID node);
+		bool SetParent(SceneNodeID node, SceneNodeID parent);
+		bool IsValid(SceneNodeID node) const { return node >= 0 && (size_t)node < m_IndexOfNode.size() && m_IndexOfNode[node] != NULL_NODE; }
+
+		void SetLocalTransform(SceneNodeID node, const Transform2D& transform);
+		const Transform2D& GetLocalTransform(SceneNodeID node) const { return m_Locals[m_IndexOfNode[node]]; }
+		Transform2D* GetLocalTransformPtr(SceneNodeID node) { return &m_Locals[m_IndexOfNode[node]]; }
+		const Affine2D& GetWorldMatrix(SceneNodeID node) const { return m_Worlds[m_IndexOfNode[node]]; }
+		void MarkDirty(SceneNodeID node);
+		void UpdateWorldTransforms();
+		size_t GetLastUpdateCount() const { return m_LastUpdateCount; }
+
+		void SetVisible(SceneNodeID node, bool state) { SetFlag(node, FLAG_VISIBLE, state); }
+		bool IsVisible(SceneNodeID node) const { return (m_Flags[m_IndexOfNode[node]] & FLAG_VISIBLE) != 0; }
+		void SetLocked(SceneNodeID node, bool state) { SetFlag(node, FLAG_LOCKED, state); }
+		bool IsLocked(SceneNodeID node) const { return (m_Flags[m_IndexOfNode[node]] & FLAG_LOCKED) != 0; }
+
+		size_t GetNodeCount() const { return m_Nodes.size(); }
+		SceneNodeID GetNodeAt(size_t index) const { return m_Nodes[index]; }
+		size_t GetIndex(SceneNodeID node) const { return (size_t)m_IndexOfNode[node]; }
+		SceneNodeID GetParent(SceneNodeID node) const;
+		SceneNodeType GetType(SceneNodeID node) const { return m_Types[m_IndexOfNode[node]]; }
+		int32_t GetPayload(SceneNodeID node) const { return m_Payloads[m_IndexOfNode[node]]; }
+		const std::string& GetName(SceneNodeID node) const { return m_Names[m_IndexOfNode[node]]; }
+		size_t GetSubtreeSize(SceneNodeID node) const { return (size_t)m_SubtreeSizes[m_IndexOfNode[node]]; }
+
+		// Draws the visible meshes. Each mesh of at least LOD_MIN_FACES faces is given a chain
+		// of simplified levels, owned here, built once the mesh has gone a frame without
+		// changing; a mesh being edited draws in full until then.
+		void Render(SDL_Renderer* renderer, container::List<Mesh>* meshes);
+
+	private:
+		static constexpr uint8_t FLAG_VISIBLE = 0x01;
+		static constexpr uint8_t FLAG_LOCKED = 0x02;
+		static constexpr uint8_t FLAG_DIRTY = 0x04;
+		static constexpr size_t LOD_MIN_FACES = 2048;
+
+		struct NodeRecord {
+			SceneNodeID node;
+			int32_t parentOffset;
+			int32_t subtreeSize;
+			SceneNodeType type;
+			int32_t payload;
+			uint8_t flags;
+			Transform2D local;
+			Affine2D world;
+			std::string name;
+		};
+
+		void SetFlag(SceneNodeID node, uint8_t flag, bool state);
+		void ExtractRange(size_t begin, size_t count, std::vector<NodeRecord>& records) const;
+		void EraseRange(size_t begin, size_t count);
+		void InsertRange(size_t position, int32_t parentIndex, std::vector<NodeRecord>& records);
+		void UpdateIndexMap(size_t begin);
+		void UpdateLOD(Mesh& mesh, size_t meshIndex);
+
+		std::vector<SceneNodeID> m_Nodes;
+		std::vector<int32_t> m_Parents;
+		std::vector<int32_t> m_SubtreeSizes;
+		std::vector<SceneNodeType> m_Types;
+		std::vector<int32_t> m_Payloads;
+		std::vector<uint8_t> m_Flags;
+		std::vector<Transform2D> m_Locals;
+		std::vector<Affine2D> m_Worlds;
+		std::vector<std::string> m_Names;
+
+		std::vector<int32_t> m_IndexOfNode;
+		std::vector<SceneNodeID> m_DirtyNodes;
+		std::vector<int32_t> m_DirtyIndices;
+		size_t m_LastUpdateCount = 0;
+		// By mesh index: the level chain and the revision the mesh had when last drawn.
+		std::vector<std::unique_ptr<MeshLOD>> m_MeshLODs;
+		std::vector<uint32_t> m_DrawnRevisions;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,181 @@
+#include "skinning.h"
+#include <algorithm>
+
+static constexpr size_t s_DeformGrain = 4096;
+
+int32_t plg::Skin::AddBone(SceneNodeID node, const Affine2D& bindPose) {
+	if (m_BoneNodes.size() > UINT16_MAX) {
+		Log("Warning! Skin bone limit reached!", true);
+		return -1;
+	}
+	m_BoneNodes.push_back(node);
+	m_InverseBindPoses.push_back(bindPose.Inverse());
+	m_SkinMatrices.emplace_back();
+	int32_t bone = (int32_t)(m_BoneNodes.size() - 1);
+	SetBoneMatrix(bone, Affine2D());
+	return bone;
+}
+
+void plg::Skin::SetInfluences(size_t vertex, const uint16_t* bones, const float* weights, size_t count) {
+	uint16_t keptBones[MAX_INFLUENCES] = { };
+	float keptWeights[MAX_INFLUENCES] = { };
+	size_t kept = 0;
+	// Only the strongest influences are kept when a vertex has more than the limit.
+	for (size_t influence = 0; influence < count; influence++) {
+		if (bones[influence] >= m_BoneNodes.size()) {
+			Log("Warning! Skin influence refers to a missing bone!", true);
+			continue;
+		}
+		if (weights[influence] <= 0.0f) {
+			continue;
+		}
+		size_t slot = kept;
+		if (kept == MAX_INFLUENCES) {
+			slot = (size_t)(std::min_element(keptWeights, keptWeights + MAX_INFLUENCES) - keptWeights);
+			if (keptWeights[slot] >= weights[influence]) {
+				continue;
+			}
+		}
+		else {
+			kept++;
+		}
+		keptBones[slot] = bones[influence];
+		keptWeights[slot] = weights[influence];
+	}
+	float total = 0.0f;
+	for (size_t influence = 0; influence < kept; influence++) {
+		total += keptWeights[influence];
+	}
+	if (vertex >= m_Deformed.size()) {
+		Resize(vertex + 1);
+	}
+	for (size_t influence = 0; influence < MAX_INFLUENCES; influence++) {
+		m_BoneIndices[influence][vertex] = keptBones[influence];
+		m_Weights[influence][vertex] = (total > 0.0f) ? keptWeights[influence] / total : 0.0f;
+	}
+}
+
+void plg::Skin::ClearInfluences(size_t vertex) {
+	if (vertex >= m_Deformed.size()) {
+		return;
+	}
+	for (size_t influence = 0; influence < MAX_INFLUENCES; influence++) {
+		m_BoneIndices[influence][vertex] = 0;
+		m_Weights[influence][vertex] = 0.0f;
+	}
+}
+
+void plg::Skin::UpdateBoneMatrices(SceneGraph* graph, SceneNodeID meshNode) {
+	Affine2D meshInverse = graph->IsValid(meshNode) ? graph->GetWorldMatrix(meshNode).Inverse() : Affine2D();
+	for (size_t bone = 0; bone < m_BoneNodes.size(); bone++) {
+		if (!graph->IsValid(m_BoneNodes[bone])) {
+			continue;
+		}
+		SetBoneMatrix((int32_t)bone, meshInverse * graph->GetWorldMatrix(m_BoneNodes[bone]));
+	}
+}
+
+void plg::Skin::SetBoneMatrix(int32_t bone, const Affine2D& pose) {
+	Affine2D skinning = pose * m_InverseBindPoses[bone];
+	SkinMatrix& matrix = m_SkinMatrices[bone];
+	matrix.linear[0] = skinning.a;
+	matrix.linear[1] = skinning.b;
+	matrix.linear[2] = skinning.c;
+	matrix.linear[3] = skinning.d;
+	matrix.translation[0] = skinning.tx;
+	matrix.translation[1] = skinning.ty;
+	matrix.translation[2] = 0.0f;
+	matrix.translation[3] = 0.0f;
+}
+
+void plg::Skin::Deform(Mesh* mesh, bool parallel) {
+	container::List<Vertex>* vertices = mesh->GetVertexList();
+	size_t vertexCount = vertices->GetCapacity();
+	if (m_Deformed.size() != vertexCount) {
+		Resize(vertexCount);
+	}
+	const Vertex* rest = vertices->GetData();
+	if (m_SkinMatrices.empty()) {
+		std::copy(rest, rest + vertexCount, m_Deformed.begin());
+	}
+	else if (parallel) {
+		container::GetThreadPool().ParallelFor(vertexCount, s_DeformGrain, [&](size_t begin, size_t end) {
+			DeformRange(rest, begin, end);
+		});
+	}
+	else {
+		DeformRange(rest, 0, vertexCount);
+	}
+	mesh->SetDeformedVertices(m_Deformed);
+}
+
+void plg::Skin::Resize(size_t vertexCount) {
+	for (size_t influence = 0; influence < MAX_INFLUENCES; influence++) {
+		m_BoneIndices[influence].resize(vertexCount, 0);
+		m_Weights[influence].resize(vertexCount, 0.0f);
+	}
+	m_Deformed.resize(vertexCount);
+}
+
+void plg::Skin::DeformRange(const Vertex* rest, size_t begin, size_t end) {
+	const SkinMatrix* matrices = m_SkinMatrices.data();
+	const uint16_t* bones0 = m_BoneIndices[0].data();
+	const uint16_t* bones1 = m_BoneIndices[1].data();
+	const uint16_t* bones2 = m_BoneIndices[2].data();
+	const uint16_t* bones3 = m_BoneIndices[3].data();
+	const float* weights0 = m_Weights[0].data();
+	const float* weights1 = m_Weights[1].data();
+	const float* weights2 = m_Weights[2].data();
+	const float* weights3 = m_Weights[3].data();
+	Vertex* deformed = m_Deformed.data();
+#ifdef PLG_SSE2
+	// The 2x2 part of a matrix fills one register as (a, b, c, d). Multiplying it by
+	// (x, x, y, y) and folding the high half onto the low one gives (ax + cy, bx + dy).
+	const __m128 identity = _mm_setr_ps(1.0f, 0.0f, 0.0f, 1.0f);
+	for (size_t index = begin; index < end; index++) {
+		const SkinMatrix& matrix0 = matrices[bones0[index]];
+		const SkinMatrix& matrix1 = matrices[bones1[index]];
+		const SkinMatrix& matrix2 = matrices[bones2[index]];
+		const SkinMatrix& matrix3 = matrices[bones3[index]];
+		__m128 weight0 = _mm_set1_ps(weights0[index]);
+		__m128 weight1 = _mm_set1_ps(weights1[index]);
+		__m128 weight2 = _mm_set1_ps(weights2[index]);
+		__m128 weight3 = _mm_set1_ps(weights3[index]);
+		__m128 restWeight = _mm_set1_ps(1.0f - weights0[index] - weights1[index] - weights2[index] - weights3[index]);
+
+		__m128 linear = _mm_mul_ps(restWeight, identity);
+		linear = _mm_add_ps(linear, _mm_mul_ps(weight0, _mm_load_ps(matrix0.linear)));
+		linear = _mm_add_ps(linear, _mm_mul_ps(weight1, _mm_load_ps(matrix1.linear)));
+		linear = _mm_add_ps(linear, _mm_mul_ps(weight2, _mm_load_ps(matrix2.linear)));
+		linear = _mm_add_ps(linear, _mm_mul_ps(weight3, _mm_load_ps(matrix3.linear)));
+		__m128 translation = _mm_mul_ps(weight0, _mm_load_ps(matrix0.translation));
+		translation = _mm_add_ps(translation, _mm_mul_ps(weight1, _mm_load_ps(matrix1.translation)));
+		translation = _mm_add_ps(translation, _mm_mul_ps(weight2, _mm_load_ps(matrix2.translation)));
+		translation = _mm_add_ps(translation, _mm_mul_ps(weight3, _mm_load_ps(matrix3.translation)));
+
+		__m128 position = _mm_setr_ps(rest[index].x, rest[index].x, rest[index].y, rest[index].y);
+		__m128 product = _mm_mul_ps(linear, position);
+		__m128 result = _mm_add_ps(_mm_add_ps(product, _mm_movehl_ps(product, product)), translation);
+		_mm_storel_pi((__m64*)&deformed[index], result);
+	}
+#else
+	for (size_t index = begin; index < end; index++) {
+		const SkinMatrix* influences[MAX_INFLUENCES] = { &matrices[bones0[index]], &matrices[bones1[index]], &matrices[bones2[index]], &matrices[bones3[index]] };
+		float weights[MAX_INFLUENCES] = { weights0[index], weights1[index], weights2[index], weights3[index] };
+		float restWeight = 1.0f - weights[0] - weights[1] - weights[2] - weights[3];
+		float a = restWeight, b = 0.0f, c = 0.0f, d = restWeight, tx = 0.0f, ty = 0.0f;
+		for (size_t influence = 0; influence < MAX_INFLUENCES; influence++) {
+			const SkinMatrix& matrix = *influences[influence];
+			float weight = weights[influence];
+			a += weight * matrix.linear[0];
+			b += weight * matrix.linear[1];
+			c += weight * matrix.linear[2];
+			d += weight * matrix.linear[3];
+			tx += weight * matrix.translation[0];
+			ty += weight * matrix.translation[1];
+		}
+		Vertex vertex = rest[index];
+		deformed[index] = Vertex(a * vertex.x + c * vertex.y + tx, b * vertex.x + d * vertex.y + ty);
+	}
+#endif
+}
\ No newline at end of file
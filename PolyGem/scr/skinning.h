@@ -0,0 +1,47 @@
+#pragma once
+#include "scene_graph.h"
+#include <vector>
+
+namespace plg {
+	// Linear-blend skin of a mesh. Up to four bone influences per vertex slot are kept in
+	// structure-of-arrays form next to the mesh's vertex list. Deform blends the bone
+	// matrices into a separate buffer and hands it to the mesh's render path, leaving the
+	// rest vertices untouched. Vertices with less than full weight keep the remainder at
+	// their rest position.
+	class Skin {
+	public:
+		static constexpr size_t MAX_INFLUENCES = 4;
+
+		Skin() { }
+
+		// bindPose is the bone's matrix in mesh space when the skin was bound.
+		int32_t AddBone(SceneNodeID node, const Affine2D& bindPose);
+		void SetInfluences(size_t vertex, const uint16_t* bones, const float* weights, size_t count);
+		void ClearInfluences(size_t vertex);
+		// Poses every bone from the world matrices of the graph, so it is called after
+		// SceneGraph::UpdateWorldTransforms. meshNode is the node the mesh is drawn with.
+		void UpdateBoneMatrices(SceneGraph* graph, SceneNodeID meshNode);
+		void SetBoneMatrix(int32_t bone, const Affine2D& pose);
+		void Deform(Mesh* mesh, bool parallel = true);
+
+		size_t GetBoneCount() const { return m_BoneNodes.size(); }
+		SceneNodeID GetBoneNode(int32_t bone) const { return m_BoneNodes[bone]; }
+		const Vertex* GetDeformedVertices() const { return m_Deformed.data(); }
+
+	private:
+		struct alignas(16) SkinMatrix {
+			float linear[4];
+			float translation[4];
+		};
+
+		void Resize(size_t vertexCount);
+		void DeformRange(const Vertex* rest, size_t begin, size_t end);
+
+		std::vector<SceneNodeID> m_BoneNodes;
+		std::vector<Affine2D> m_InverseBindPoses;
+		std::vector<SkinMatrix> m_SkinMatrices;
+		std::vector<uint16_t> m_BoneIndices[MAX_INFLUENCES];
+		std::vector<float> m_Weights[MAX_INFLUENCES];
+		std::vector<Vertex> m_Deformed;
+	};
+}
\ No newline at end of file
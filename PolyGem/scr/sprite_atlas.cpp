@@ -0,0 +1,375 @@
+#include "sprite_atlas.h"
+#include "SDL_image.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+static SDL_FRect s_ComputeUV(const SDL_Rect& rect, int pageWidth, int pageHeight) {
+	return { (float)rect.x / (float)pageWidth, (float)rect.y / (float)pageHeight, (float)rect.w / (float)pageWidth, (float)rect.h / (float)pageHeight };
+}
+
+void plg::SkylinePacker::Reset(int width, int height) {
+	m_Width = width;
+	m_Height = height;
+	m_UsedHeight = 0;
+	m_Skyline.clear();
+	m_Skyline.push_back({ 0, 0, width });
+}
+
+bool plg::SkylinePacker::Fits(size_t segment, int width, int height, int* y) const {
+	int x = m_Skyline[segment].x;
+	if (x + width > m_Width) {
+		return false;
+	}
+	int top = 0;
+	int widthLeft = width;
+	for (size_t index = segment; widthLeft > 0; index++) {
+		top = std::max(top, m_Skyline[index].y);
+		if (top + height > m_Height) {
+			return false;
+		}
+		widthLeft -= m_Skyline[index].width;
+	}
+	*y = top;
+	return true;
+}
+
+bool plg::SkylinePacker::Insert(int width, int height, SDL_Rect* rect) {
+	size_t bestSegment = m_Skyline.size();
+	int bestBottom = INT32_MAX, bestWidth = INT32_MAX, bestY = 0;
+	for (size_t segment = 0; segment < m_Skyline.size(); segment++) {
+		int y;
+		if (!Fits(segment, width, height, &y)) {
+			continue;
+		}
+		// Lowest resting place first, then the narrowest segment to leave wide gaps open.
+		if (y + height < bestBottom || (y + height == bestBottom && m_Skyline[segment].width < bestWidth)) {
+			bestSegment = segment;
+			bestBottom = y + height;
+			bestWidth = m_Skyline[segment].width;
+			bestY = y;
+		}
+	}
+	if (bestSegment == m_Skyline.size()) {
+		return false;
+	}
+	*rect = { m_Skyline[bestSegment].x, bestY, width, height };
+	m_Skyline.insert(m_Skyline.begin() + bestSegment, { rect->x, bestY + height, width });
+	for (size_t index = bestSegment + 1; index < m_Skyline.size();) {
+		Segment& previous = m_Skyline[index - 1];
+		Segment& current = m_Skyline[index];
+		int overlap = previous.x + previous.width - current.x;
+		if (overlap <= 0) {
+			break;
+		}
+		current.x += overlap;
+		current.width -= overlap;
+		if (current.width > 0) {
+			break;
+		}
+		m_Skyline.erase(m_Skyline.begin() + index);
+	}
+	for (size_t index = 1; index < m_Skyline.size();) {
+		if (m_Skyline[index - 1].y == m_Skyline[index].y) {
+			m_Skyline[index - 1].width += m_Skyline[index].width;
+			m_Skyline.erase(m_Skyline.begin() + index);
+		}
+		else {
+			index++;
+		}
+	}
+	m_UsedHeight = std::max(m_UsedHeight, bestY + height);
+	return true;
+}
+
+plg::SheetID plg::SpriteAtlas::AddSheet(const std::string& path, int frameWidth, int frameHeight) {
+	Sheet sheet;
+	sheet.path = path;
+	sheet.frameWidth = frameWidth;
+	sheet.frameHeight = frameHeight;
+	m_Sheets.push_back(sheet);
+	return (SheetID)(m_Sheets.size() - 1);
+}
+
+bool plg::SpriteAtlas::Build(SDL_Renderer* renderer, const std::string& cachePath) {
+	ReleasePages();
+	std::string key = MakeCacheKey();
+	if (!cachePath.empty() && LoadCache(renderer, cachePath, key)) {
+		return true;
+	}
+
+	struct Frame {
+		size_t sheet;
+		SDL_Rect source;
+	};
+	std::vector<SDL_Surface*> sources(m_Sheets.size(), nullptr);
+	std::vector<Frame> frames;
+	for (size_t sheetIndex = 0; sheetIndex < m_Sheets.size(); sheetIndex++) {
+		Sheet& sheet = m_Sheets[sheetIndex];
+		sheet.firstSprite = (SpriteID)frames.size();
+		sheet.frameCount = 0;
+		SDL_Surface* loaded = IMG_Load(sheet.path.c_str());
+		if (loaded == NULL) {
+			Log("Unable to load the sprite sheet! ", false);
+			Log(sheet.path, true);
+			continue;
+		}
+		SDL_Surface* surface = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+		SDL_FreeSurface(loaded);
+		if (surface == NULL) {
+			continue;
+		}
+		SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+		sources[sheetIndex] = surface;
+		int frameWidth = (sheet.frameWidth > 0) ? sheet.frameWidth : surface->w;
+		int frameHeight = (sheet.frameHeight > 0) ? sheet.frameHeight : surface->h;
+		for (int y = 0; y + frameHeight <= surface->h; y += frameHeight) {
+			for (int x = 0; x + frameWidth <= surface->w; x += frameWidth) {
+				frames.push_back({ sheetIndex, { x, y, frameWidth, frameHeight } });
+				sheet.frameCount++;
+			}
+		}
+	}
+	m_Sprites.assign(frames.size(), Sprite());
+
+	// Tall frames first keeps the skyline flat.
+	std::vector<uint32_t> order(frames.size());
+	for (size_t frame = 0; frame < frames.size(); frame++) {
+		order[frame] = (uint32_t)frame;
+	}
+	std::sort(order.begin(), order.end(), [&](uint32_t left, uint32_t right) {
+		if (frames[left].source.h != frames[right].source.h) {
+			return frames[left].source.h > frames[right].source.h;
+		}
+		return frames[left].source.w > frames[right].source.w;
+	});
+	std::vector<SkylinePacker> packers;
+	for (uint32_t frame : order) {
+		int width = frames[frame].source.w + m_Padding;
+		int height = frames[frame].source.h + m_Padding;
+		if (width > m_PageSize || height > m_PageSize) {
+			Log("Warning! Sprite frame does not fit in an atlas page! ", false);
+			Log(m_Sheets[frames[frame].sheet].path, true);
+			continue;
+		}
+		SDL_Rect rect;
+		size_t page = 0;
+		while (page < packers.size() && !packers[page].Insert(width, height, &rect)) {
+			page++;
+		}
+		if (page == packers.size()) {
+			packers.emplace_back(m_PageSize, m_PageSize);
+			packers.back().Insert(width, height, &rect);
+		}
+		m_Sprites[frame].page = (int32_t)page;
+		m_Sprites[frame].rect = { rect.x, rect.y, frames[frame].source.w, frames[frame].source.h };
+	}
+
+	std::vector<SDL_Surface*> pages(packers.size(), nullptr);
+	for (size_t page = 0; page < packers.size(); page++) {
+		pages[page] = SDL_CreateRGBSurfaceWithFormat(0, m_PageSize, std::max(1, packers[page].GetUsedHeight()), 32, SDL_PIXELFORMAT_RGBA32);
+	}
+	for (size_t frame = 0; frame < frames.size(); frame++) {
+		Sprite& sprite = m_Sprites[frame];
+		if (sprite.page < 0 || pages[sprite.page] == NULL) {
+			continue;
+		}
+		SDL_Surface* page = pages[sprite.page];
+		SDL_BlitSurface(sources[frames[frame].sheet], &frames[frame].source, page, &sprite.rect);
+		sprite.uv = s_ComputeUV(sprite.rect, page->w, page->h);
+	}
+	for (SDL_Surface* page : pages) {
+		SDL_Texture* texture = (page != NULL) ? SDL_CreateTextureFromSurface(renderer, page) : NULL;
+		if (texture != NULL) {
+			SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+		}
+		m_Pages.push_back(texture);
+	}
+	if (!cachePath.empty()) {
+		SaveCache(cachePath, key, pages);
+	}
+	for (SDL_Surface* page : pages) {
+		SDL_FreeSurface(page);
+	}
+	for (SDL_Surface* source : sources) {
+		SDL_FreeSurface(source);
+	}
+	return true;
+}
+
+void plg::SpriteAtlas::Clear() {
+	ReleasePages();
+	m_Sprites.clear();
+	m_Sheets.clear();
+}
+
+plg::SpriteID plg::SpriteAtlas::GetSheetFrame(SheetID sheet, size_t frame) const {
+	const Sheet& target = m_Sheets[sheet];
+	if (target.frameCount == 0) {
+		return -1;
+	}
+	return target.firstSprite + (SpriteID)(frame % target.frameCount);
+}
+
+void plg::SpriteAtlas::ReleasePages() {
+	for (SDL_Texture* page : m_Pages) {
+		if (page != NULL) {
+			SDL_DestroyTexture(page);
+		}
+	}
+	m_Pages.clear();
+}
+
+std::string plg::SpriteAtlas::MakeCacheKey() const {
+	std::string key = "atlas1 " + std::to_string(m_PageSize) + " " + std::to_string(m_Padding);
+	for (const Sheet& sheet : m_Sheets) {
+		std::error_code error;
+		uintmax_t size = std::filesystem::file_size(sheet.path, error);
+		auto time = std::filesystem::last_write_time(sheet.path, error);
+		key += "|" + sheet.path + ":" + std::to_string(sheet.frameWidth) + "x" + std::to_string(sheet.frameHeight);
+		key += error ? std::string(":missing") : ":" + std::to_string(size) + ":" + std::to_string(time.time_since_epoch().count());
+	}
+	return key;
+}
+
+bool plg::SpriteAtlas::LoadCache(SDL_Renderer* renderer, const std::string& cachePath, const std::string& key) {
+	std::ifstream layout(cachePath + ".atlas");
+	std::string storedKey;
+	if (!layout || !std::getline(layout, storedKey) || storedKey != key) {
+		return false;
+	}
+	size_t pageCount = 0, spriteCount = 0;
+	layout >> pageCount >> spriteCount;
+	std::vector<Sprite> sprites(spriteCount);
+	for (Sheet& sheet : m_Sheets) {
+		layout >> sheet.firstSprite >> sheet.frameCount;
+	}
+	for (Sprite& sprite : sprites) {
+		layout >> sprite.page >> sprite.rect.x >> sprite.rect.y >> sprite.rect.w >> sprite.rect.h;
+	}
+	if (!layout) {
+		return false;
+	}
+	std::vector<SDL_Point> pageSizes(pageCount);
+	for (size_t page = 0; page < pageCount; page++) {
+		SDL_Surface* surface = IMG_Load((cachePath + "_" + std::to_string(page) + ".png").c_str());
+		SDL_Texture* texture = (surface != NULL) ? SDL_CreateTextureFromSurface(renderer, surface) : NULL;
+		if (texture == NULL) {
+			SDL_FreeSurface(surface);
+			ReleasePages();
+			return false;
+		}
+		pageSizes[page] = { surface->w, surface->h };
+		SDL_FreeSurface(surface);
+		SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+		m_Pages.push_back(texture);
+	}
+	for (Sprite& sprite : sprites) {
+		if (sprite.page >= 0 && (size_t)sprite.page < pageCount) {
+			sprite.uv = s_ComputeUV(sprite.rect, pageSizes[sprite.page].x, pageSizes[sprite.page].y);
+		}
+	}
+	m_Sprites = std::move(sprites);
+	return true;
+}
+
+void plg::SpriteAtlas::SaveCache(const std::string& cachePath, const std::string& key, const std::vector<SDL_Surface*>& pages) const {
+	for (size_t page = 0; page < pages.size(); page++) {
+		if (pages[page] == NULL || IMG_SavePNG(pages[page], (cachePath + "_" + std::to_string(page) + ".png").c_str()) != 0) {
+			Log("Unable to save the atlas page! ", false);
+			Log(SDL_GetError(), true);
+			return;
+		}
+	}
+	std::ofstream layout(cachePath + ".atlas", std::ios::trunc);
+	layout << key << "\n" << pages.size() << " " << m_Sprites.size() << "\n";
+	for (const Sheet& sheet : m_Sheets) {
+		layout << sheet.firstSprite << " " << sheet.frameCount << "\n";
+	}
+	for (const Sprite& sprite : m_Sprites) {
+		layout << sprite.page << " " << sprite.rect.x << " " << sprite.rect.y << " " << sprite.rect.w << " " << sprite.rect.h << "\n";
+	}
+}
+
+void plg::SpriteBatch::Draw(SpriteID sprite, const SDL_FRect& destination, SDL_Color color) {
+	Command command;
+	command.sprite = sprite;
+	command.corners[0] = { destination.x, destination.y };
+	command.corners[1] = { destination.x + destination.w, destination.y };
+	command.corners[2] = { destination.x + destination.w, destination.y + destination.h };
+	command.corners[3] = { destination.x, destination.y + destination.h };
+	command.color = color;
+	m_Commands.push_back(command);
+}
+
+void plg::SpriteBatch::Draw(SpriteID sprite, const Affine2D& transform, SDL_Color color) {
+	const SDL_Rect& rect = m_Atlas->GetSprite(sprite).rect;
+	float halfWidth = (float)rect.w * 0.5f, halfHeight = (float)rect.h * 0.5f;
+	const Vec2 corners[4] = { Vec2(-halfWidth, -halfHeight), Vec2(halfWidth, -halfHeight), Vec2(halfWidth, halfHeight), Vec2(-halfWidth, halfHeight) };
+	Command command;
+	command.sprite = sprite;
+	for (size_t corner = 0; corner < 4; corner++) {
+		Vec2 point = transform.Apply(corners[corner]);
+		command.corners[corner] = { point.x, point.y };
+	}
+	command.color = color;
+	m_Commands.push_back(command);
+}
+
+void plg::SpriteBatch::Flush(SDL_Renderer* renderer) {
+	m_LastDrawCallCount = 0;
+	if (m_Commands.empty()) {
+		return;
+	}
+	// Counting sort of the commands by page, stable within each page.
+	size_t pageCount = m_Atlas->GetPageCount();
+	m_PageOffsets.assign(pageCount + 1, 0);
+	for (const Command& command : m_Commands) {
+		int32_t page = (command.sprite >= 0) ? m_Atlas->GetSprite(command.sprite).page : -1;
+		if (page >= 0) {
+			m_PageOffsets[page + 1]++;
+		}
+	}
+	for (size_t page = 0; page < pageCount; page++) {
+		m_PageOffsets[page + 1] += m_PageOffsets[page];
+	}
+	m_PageCursors.assign(m_PageOffsets.begin(), m_PageOffsets.end() - 1);
+	size_t quadCount = m_PageOffsets[pageCount];
+	SDL_Vertex* vertices = container::frameArena.AllocateArray<SDL_Vertex>(quadCount * 4);
+	int* indices = container::frameArena.AllocateArray<int>(quadCount * 6);
+	for (const Command& command : m_Commands) {
+		if (command.sprite < 0) {
+			continue;
+		}
+		const Sprite& sprite = m_Atlas->GetSprite(command.sprite);
+		if (sprite.page < 0) {
+			continue;
+		}
+		size_t slot = m_PageCursors[sprite.page]++;
+		const SDL_FPoint uvs[4] = { { sprite.uv.x, sprite.uv.y }, { sprite.uv.x + sprite.uv.w, sprite.uv.y },
+			{ sprite.uv.x + sprite.uv.w, sprite.uv.y + sprite.uv.h }, { sprite.uv.x, sprite.uv.y + sprite.uv.h } };
+		SDL_Vertex* quad = vertices + slot * 4;
+		for (size_t corner = 0; corner < 4; corner++) {
+			quad[corner].position = command.corners[corner];
+			quad[corner].color = command.color;
+			quad[corner].tex_coord = uvs[corner];
+		}
+		int first = (int)((slot - m_PageOffsets[sprite.page]) * 4);
+		int* quadIndices = indices + slot * 6;
+		quadIndices[0] = first;
+		quadIndices[1] = first + 1;
+		quadIndices[2] = first + 2;
+		quadIndices[3] = first;
+		quadIndices[4] = first + 2;
+		quadIndices[5] = first + 3;
+	}
+	for (size_t page = 0; page < pageCount; page++) {
+		size_t begin = m_PageOffsets[page], count = m_PageOffsets[page + 1] - begin;
+		if (count == 0) {
+			continue;
+		}
+		SDL_RenderGeometry(renderer, m_Atlas->GetPageTexture((int32_t)page), vertices + begin * 4, (int)(count * 4), indices + begin * 6, (int)(count * 6));
+		m_LastDrawCallCount++;
+	}
+	m_Commands.clear();
+}
\ No newline at end of file
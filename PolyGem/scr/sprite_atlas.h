@@ -0,0 +1,108 @@
+#pragma once
+#include "core.h"
+#include "SDL.h"
+#include <string>
+#include <vector>
+
+namespace plg {
+	using SpriteID = int32_t;
+	using SheetID = int32_t;
+
+	struct Sprite {
+		int32_t page = -1;
+		SDL_Rect rect = { 0, 0, 0, 0 };
+		SDL_FRect uv = { 0.0f, 0.0f, 0.0f, 0.0f };
+	};
+
+	// Bottom-left skyline packer. The free space is tracked as the top edge of the placed
+	// rectangles, which keeps inserts cheap and packs sprite frames of similar height tightly.
+	class SkylinePacker {
+	public:
+		SkylinePacker(int width = 0, int height = 0) { Reset(width, height); }
+
+		void Reset(int width, int height);
+		bool Insert(int width, int height, SDL_Rect* rect);
+		int GetUsedHeight() const { return m_UsedHeight; }
+
+	private:
+		struct Segment {
+			int x, y, width;
+		};
+
+		bool Fits(size_t segment, int width, int height, int* y) const;
+
+		std::vector<Segment> m_Skyline;
+		int m_Width = 0;
+		int m_Height = 0;
+		int m_UsedHeight = 0;
+	};
+
+	// Packs images and sliced sprite sheets into a few large page textures. The layout and
+	// the page images can be cached on disk; when none of the sources changed since, Build
+	// loads the cached pages instead of every source and skips packing.
+	class SpriteAtlas {
+	public:
+		SpriteAtlas(int pageSize = 2048, int padding = 1) : m_PageSize(pageSize), m_Padding(padding) { }
+		SpriteAtlas(const SpriteAtlas&) = delete;
+		SpriteAtlas& operator=(const SpriteAtlas&) = delete;
+		~SpriteAtlas() { Clear(); }
+
+		// A frame size of 0 takes the whole image as a single frame.
+		SheetID AddSheet(const std::string& path, int frameWidth = 0, int frameHeight = 0);
+		bool Build(SDL_Renderer* renderer, const std::string& cachePath = "");
+		void Clear();
+
+		SpriteID GetSheetFrame(SheetID sheet, size_t frame) const;
+		size_t GetSheetFrameCount(SheetID sheet) const { return m_Sheets[sheet].frameCount; }
+		const Sprite& GetSprite(SpriteID sprite) const { return m_Sprites[sprite]; }
+		size_t GetSpriteCount() const { return m_Sprites.size(); }
+		SDL_Texture* GetPageTexture(int32_t page) const { return m_Pages[page]; }
+		size_t GetPageCount() const { return m_Pages.size(); }
+
+	private:
+		struct Sheet {
+			std::string path;
+			int frameWidth;
+			int frameHeight;
+			SpriteID firstSprite = 0;
+			size_t frameCount = 0;
+		};
+
+		void ReleasePages();
+		std::string MakeCacheKey() const;
+		bool LoadCache(SDL_Renderer* renderer, const std::string& cachePath, const std::string& key);
+		void SaveCache(const std::string& cachePath, const std::string& key, const std::vector<SDL_Surface*>& pages) const;
+
+		std::vector<Sheet> m_Sheets;
+		std::vector<Sprite> m_Sprites;
+		std::vector<SDL_Texture*> m_Pages;
+		int m_PageSize;
+		int m_Padding;
+	};
+
+	// Collects sprite draws for a frame and submits them with one SDL_RenderGeometry call
+	// per atlas page. Sprites keep their order within a page, not across pages.
+	class SpriteBatch {
+	public:
+		SpriteBatch(const SpriteAtlas* atlas) : m_Atlas(atlas) { }
+
+		void Draw(SpriteID sprite, const SDL_FRect& destination, SDL_Color color = { 255, 255, 255, 255 });
+		// Draws the sprite at its pixel size, centred on the transform's origin.
+		void Draw(SpriteID sprite, const Affine2D& transform, SDL_Color color = { 255, 255, 255, 255 });
+		void Flush(SDL_Renderer* renderer);
+		size_t GetLastDrawCallCount() const { return m_LastDrawCallCount; }
+
+	private:
+		struct Command {
+			SpriteID sprite;
+			SDL_FPoint corners[4];
+			SDL_Color color;
+		};
+
+		const SpriteAtlas* m_Atlas;
+		std::vector<Command> m_Commands;
+		std::vector<size_t> m_PageOffsets;
+		std::vector<size_t> m_PageCursors;
+		size_t m_LastDrawCallCount = 0;
+	};
+}
\ No newline at end of file
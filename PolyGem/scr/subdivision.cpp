@@ -0,0 +1,508 @@
+#include "subdivision.h"
+#include "material.h"
+#include <algorithm>
+#include <unordered_set>
+
+static constexpr size_t s_VertexGrain = 4096;
+static constexpr size_t s_EdgeGrain = 4096;
+static constexpr size_t s_FaceGrain = 2048;
+
+static int32_t s_NextSide(size_t side) {
+	return (int32_t)(side - side % 3 + (side % 3 + 1) % 3);
+}
+
+static uint64_t s_EdgeKey(int32_t start, int32_t end) {
+	return (start < end) ? ((uint64_t)(uint32_t)start << 32) | (uint32_t)end : ((uint64_t)(uint32_t)end << 32) | (uint32_t)start;
+}
+
+static float s_SquareDistance(const plg::Vec2& a, const plg::Vec2& b) {
+	return (a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y);
+}
+
+size_t plg::Subdivider::Subdivide(Mesh& mesh, uint32_t levels, SubdivisionScheme scheme) {
+	if (levels == 0 || !Load(mesh, {}, true)) {
+		return mesh.GetFaceList()->GetSize();
+	}
+	// Only the first level needs the edge table; when every face splits, the children's
+	// edges are numbered straight from their parents' for the levels after it.
+	BuildEdges();
+	Reserve(levels);
+	for (uint32_t level = 0; level < levels; level++) {
+		SplitLevel(scheme, level + 1 == levels, level + 1 < levels);
+	}
+	Store(mesh);
+	return m_Faces.size() / 3;
+}
+
+size_t plg::Subdivider::Subdivide(Mesh& mesh, std::span<const int32_t> faces, uint32_t levels, SubdivisionScheme scheme) {
+	if (levels == 0 || faces.empty() || !Load(mesh, faces, false)) {
+		return mesh.GetFaceList()->GetSize();
+	}
+	for (uint32_t level = 0; level < levels; level++) {
+		BuildEdges();
+		SplitLevel(scheme, level + 1 == levels, false);
+	}
+	Store(mesh);
+	return m_Faces.size() / 3;
+}
+
+bool plg::Subdivider::Load(Mesh& mesh, std::span<const int32_t> faces, bool all) {
+	container::List<Vertex>* vertices = mesh.GetVertexList();
+	container::List<Face>* faceList = mesh.GetFaceList();
+	if (faceList->GetSize() == 0) {
+		return false;
+	}
+	// Slots are packed so the levels work on dense arrays.
+	m_VertexRemap.assign(vertices->GetCapacity(), -1);
+	m_Positions.clear();
+	m_UVs.clear();
+	std::span<const Vec2> uvs = mesh.GetUVs();
+	bool hasUVs = uvs.size() >= vertices->GetCapacity();
+	for (auto vertex = mesh.GetVertexIter(); vertex < vertex.end_ptr; vertex++) {
+		m_VertexRemap[vertex.GetIndex()] = (int32_t)m_Positions.size();
+		m_Positions.push_back(*vertex);
+		if (hasUVs) {
+			m_UVs.push_back(uvs[vertex.GetIndex()]);
+		}
+	}
+	auto remap = [&](int32_t vertex) {
+		return (vertex >= 0 && (size_t)vertex < m_VertexRemap.size()) ? m_VertexRemap[vertex] : -1;
+	};
+	m_FaceRemap.assign(faceList->GetCapacity(), -1);
+	m_Faces.clear();
+	m_Materials.clear();
+	std::unordered_set<uint64_t> sides(faceList->GetSize() * 3);
+	for (auto face = mesh.GetFaceIter(); face < face.end_ptr; face++) {
+		int32_t corners[3] = { remap(face->m_Vert1), remap(face->m_Vert2), remap(face->m_Vert3) };
+		if (corners[0] == -1 || corners[1] == -1 || corners[2] == -1) {
+			continue;
+		}
+		m_FaceRemap[face.GetIndex()] = (int32_t)(m_Faces.size() / 3);
+		m_Faces.insert(m_Faces.end(), corners, corners + 3);
+		if (mesh.HasFaceMaterials()) {
+			m_Materials.push_back(mesh.GetFaceMaterial((int32_t)face.GetIndex()));
+		}
+		for (int32_t corner = 0; corner < 3; corner++) {
+			sides.insert(s_EdgeKey(corners[corner], corners[(corner + 1) % 3]));
+		}
+	}
+	m_Selected.assign(m_Faces.size() / 3, all ? 1 : 0);
+	for (int32_t face : faces) {
+		if (face >= 0 && (size_t)face < m_FaceRemap.size() && m_FaceRemap[face] != -1) {
+			m_Selected[m_FaceRemap[face]] = 1;
+		}
+	}
+	// Edges that are not a side of any face are carried over untouched.
+	m_LooseEdges.clear();
+	for (auto edge = mesh.GetEdgeIter(); edge < edge.end_ptr; edge++) {
+		int32_t start = remap(edge->m_Start), end = remap(edge->m_End);
+		if (start != -1 && end != -1 && start != end && !sides.count(s_EdgeKey(start, end))) {
+			m_LooseEdges.push_back(Edge(start, end));
+		}
+	}
+	return !m_Faces.empty();
+}
+
+void plg::Subdivider::Reserve(uint32_t levels) {
+	// Every level adds a vertex per edge, two edges per edge plus three per face, and four
+	// faces per face, so the final sizes follow from the first level's edge count.
+	size_t vertexCount = m_Positions.size(), edgeCount = m_EdgeSides.size() / 2, faceCount = m_Faces.size() / 3;
+	for (uint32_t level = 0; level < levels; level++) {
+		vertexCount += edgeCount;
+		edgeCount = edgeCount * 2 + faceCount * 3;
+		faceCount *= 4;
+	}
+	m_Positions.reserve(vertexCount);
+	m_NextPositions.reserve(vertexCount);
+	m_Faces.reserve(faceCount * 3);
+	m_NextFaces.reserve(faceCount * 3);
+	m_Selected.reserve(faceCount);
+	m_NextSelected.reserve(faceCount);
+	if (!m_Materials.empty()) {
+		m_Materials.reserve(faceCount);
+		m_NextMaterials.reserve(faceCount);
+	}
+	if (!m_UVs.empty()) {
+		m_UVs.reserve(vertexCount);
+		m_NextUVs.reserve(vertexCount);
+	}
+	m_SideEdges.reserve(faceCount * 3);
+	m_NextSideEdges.reserve(faceCount * 3);
+	m_EdgeSides.reserve(edgeCount * 2);
+	m_NextEdgeSides.reserve(edgeCount * 2);
+	m_OutputEdges.reserve(edgeCount + m_LooseEdges.size());
+}
+
+void plg::Subdivider::BuildEdges() {
+	size_t vertexCount = m_Positions.size(), sideCount = m_Faces.size();
+	// Both sides of an edge share its lower vertex, so they meet in one short bucket, and
+	// numbering the edges bucket by bucket keeps each vertex's edges next to each other.
+	m_BucketStarts.assign(vertexCount + 1, 0);
+	for (size_t side = 0; side < sideCount; side++) {
+		m_BucketStarts[std::min(m_Faces[side], m_Faces[s_NextSide(side)]) + 1]++;
+	}
+	for (size_t vertex = 0; vertex < vertexCount; vertex++) {
+		m_BucketStarts[vertex + 1] += m_BucketStarts[vertex];
+	}
+	m_BucketFill.assign(m_BucketStarts.begin(), m_BucketStarts.end() - 1);
+	m_BucketSides.resize(sideCount);
+	for (size_t side = 0; side < sideCount; side++) {
+		m_BucketSides[m_BucketFill[std::min(m_Faces[side], m_Faces[s_NextSide(side)])]++] = (int32_t)side;
+	}
+
+	// First count each bucket's distinct edges, then number them from the running total.
+	auto upper = [this](int32_t side) { return std::max(m_Faces[side], m_Faces[s_NextSide(side)]); };
+	auto firstMatch = [&](int32_t begin, int32_t entry) {
+		int32_t other = upper(m_BucketSides[entry]);
+		while (upper(m_BucketSides[begin]) != other) {
+			begin++;
+		}
+		return begin;
+	};
+	m_EdgeStarts.resize(vertexCount + 1);
+	m_EdgeStarts[0] = 0;
+	container::GetThreadPool().ParallelFor(vertexCount, s_VertexGrain, [&](size_t begin, size_t end) {
+		for (size_t vertex = begin; vertex < end; vertex++) {
+			int32_t count = 0;
+			for (int32_t entry = m_BucketStarts[vertex]; entry < m_BucketStarts[vertex + 1]; entry++) {
+				count += (firstMatch(m_BucketStarts[vertex], entry) == entry) ? 1 : 0;
+			}
+			m_EdgeStarts[vertex + 1] = count;
+		}
+	});
+	for (size_t vertex = 0; vertex < vertexCount; vertex++) {
+		m_EdgeStarts[vertex + 1] += m_EdgeStarts[vertex];
+	}
+	m_SideEdges.resize(sideCount);
+	m_EdgeSides.assign((size_t)m_EdgeStarts[vertexCount] * 2, -1);
+	container::GetThreadPool().ParallelFor(vertexCount, s_VertexGrain, [&](size_t begin, size_t end) {
+		for (size_t vertex = begin; vertex < end; vertex++) {
+			int32_t nextEdge = m_EdgeStarts[vertex];
+			for (int32_t entry = m_BucketStarts[vertex]; entry < m_BucketStarts[vertex + 1]; entry++) {
+				int32_t side = m_BucketSides[entry], match = firstMatch(m_BucketStarts[vertex], entry);
+				if (match == entry) {
+					m_SideEdges[side] = nextEdge;
+					m_EdgeSides[nextEdge * 2] = side;
+					nextEdge++;
+					continue;
+				}
+				// A third face on one edge is split with it but not counted as its neighbour.
+				int32_t edge = m_SideEdges[m_BucketSides[match]];
+				m_SideEdges[side] = edge;
+				if (m_EdgeSides[edge * 2 + 1] == -1) {
+					m_EdgeSides[edge * 2 + 1] = side;
+				}
+			}
+		}
+	});
+}
+
+void plg::Subdivider::SplitLevel(SubdivisionScheme scheme, bool last, bool numberChildren) {
+	size_t vertexCount = m_Positions.size(), faceCount = m_Faces.size() / 3, edgeCount = m_EdgeSides.size() / 2;
+	bool loop = (scheme == SubdivisionScheme::LOOP);
+	m_EdgeVertices.resize(edgeCount);
+	int32_t nextVertex = (int32_t)vertexCount;
+	for (size_t edge = 0; edge < edgeCount; edge++) {
+		int32_t side = m_EdgeSides[edge * 2], twin = m_EdgeSides[edge * 2 + 1];
+		bool split = m_Selected[side / 3] || (twin != -1 && m_Selected[twin / 3]);
+		m_EdgeVertices[edge] = split ? nextVertex++ : -1;
+	}
+	m_NextPositions.resize(nextVertex);
+	bool hasUVs = !m_UVs.empty();
+	if (hasUVs) {
+		m_NextUVs.resize(nextVertex);
+		std::copy(m_UVs.begin(), m_UVs.end(), m_NextUVs.begin());
+	}
+
+	if (loop) {
+		// Loop's vertex mask needs every vertex's neighbours, and its outline neighbours
+		// apart; vertices touching a face that is not being split stay where they are.
+		m_NeighbourSums.assign(vertexCount, Vec2());
+		m_BoundarySums.assign(vertexCount, Vec2());
+		m_Valences.assign(vertexCount, 0);
+		m_BoundaryCounts.assign(vertexCount, 0);
+		m_Pinned.assign(vertexCount, 0);
+		for (size_t edge = 0; edge < edgeCount; edge++) {
+			int32_t side = m_EdgeSides[edge * 2];
+			int32_t start = m_Faces[side], end = m_Faces[s_NextSide(side)];
+			std::vector<Vec2>& sums = (m_EdgeSides[edge * 2 + 1] == -1) ? m_BoundarySums : m_NeighbourSums;
+			sums[start].x += m_Positions[end].x;
+			sums[start].y += m_Positions[end].y;
+			sums[end].x += m_Positions[start].x;
+			sums[end].y += m_Positions[start].y;
+			std::vector<int32_t>& counts = (m_EdgeSides[edge * 2 + 1] == -1) ? m_BoundaryCounts : m_Valences;
+			counts[start]++;
+			counts[end]++;
+		}
+		for (size_t face = 0; face < faceCount; face++) {
+			if (!m_Selected[face]) {
+				m_Pinned[m_Faces[face * 3]] = m_Pinned[m_Faces[face * 3 + 1]] = m_Pinned[m_Faces[face * 3 + 2]] = 1;
+			}
+		}
+	}
+	container::GetThreadPool().ParallelFor(vertexCount, s_VertexGrain, [&](size_t begin, size_t end) {
+		for (size_t vertex = begin; vertex < end; vertex++) {
+			Vec2 position = m_Positions[vertex];
+			int32_t boundaryCount = loop ? m_BoundaryCounts[vertex] : 0;
+			int32_t valence = loop ? m_Valences[vertex] + boundaryCount : 0;
+			if (!loop || m_Pinned[vertex] || valence == 0 || (boundaryCount != 0 && boundaryCount != 2)) {
+				// Corners where the outline branches are kept sharp.
+				m_NextPositions[vertex] = position;
+			}
+			else if (boundaryCount == 2) {
+				const Vec2& sum = m_BoundarySums[vertex];
+				m_NextPositions[vertex] = Vec2(0.75f * position.x + 0.125f * sum.x, 0.75f * position.y + 0.125f * sum.y);
+			}
+			else {
+				float beta = (valence == 3) ? 0.1875f : 0.375f / (float)valence;
+				float keep = 1.0f - beta * (float)valence;
+				const Vec2& sum = m_NeighbourSums[vertex];
+				m_NextPositions[vertex] = Vec2(keep * position.x + beta * sum.x, keep * position.y + beta * sum.y);
+			}
+		}
+	});
+	container::GetThreadPool().ParallelFor(edgeCount, s_EdgeGrain, [&](size_t begin, size_t end) {
+		for (size_t edge = begin; edge < end; edge++) {
+			if (m_EdgeVertices[edge] == -1) {
+				continue;
+			}
+			int32_t side = m_EdgeSides[edge * 2], twin = m_EdgeSides[edge * 2 + 1];
+			if (hasUVs) {
+				const Vec2& first = m_UVs[m_Faces[side]];
+				const Vec2& second = m_UVs[m_Faces[s_NextSide(side)]];
+				m_NextUVs[m_EdgeVertices[edge]] = Vec2(0.5f * (first.x + second.x), 0.5f * (first.y + second.y));
+			}
+			const Vec2& start = m_Positions[m_Faces[side]];
+			const Vec2& finish = m_Positions[m_Faces[s_NextSide(side)]];
+			Vec2& midpoint = m_NextPositions[m_EdgeVertices[edge]];
+			if (loop && twin != -1 && m_Selected[side / 3] && m_Selected[twin / 3]) {
+				const Vec2& left = m_Positions[m_Faces[s_NextSide(s_NextSide(side))]];
+				const Vec2& right = m_Positions[m_Faces[s_NextSide(s_NextSide(twin))]];
+				midpoint = Vec2(0.375f * (start.x + finish.x) + 0.125f * (left.x + right.x), 0.375f * (start.y + finish.y) + 0.125f * (left.y + right.y));
+			}
+			else {
+				midpoint = Vec2(0.5f * (start.x + finish.x), 0.5f * (start.y + finish.y));
+			}
+		}
+	});
+
+	// A face with s split sides becomes s + 1 faces and gains s inner edges.
+	m_ChildStarts.resize(faceCount + 1);
+	m_ChildStarts[0] = 0;
+	for (size_t face = 0; face < faceCount; face++) {
+		int32_t splits = 1;
+		for (size_t corner = 0; corner < 3; corner++) {
+			splits += (m_EdgeVertices[m_SideEdges[face * 3 + corner]] != -1) ? 1 : 0;
+		}
+		m_ChildStarts[face + 1] = m_ChildStarts[face] + splits;
+	}
+	size_t childCount = m_ChildStarts[faceCount];
+	m_NextFaces.resize(childCount * 3);
+	m_NextSelected.resize(childCount);
+	bool hasMaterials = !m_Materials.empty();
+	if (hasMaterials) {
+		m_NextMaterials.resize(childCount);
+	}
+	if (numberChildren) {
+		m_NextSideEdges.resize(childCount * 3);
+		m_NextEdgeSides.resize((edgeCount * 2 + faceCount * 3) * 2);
+	}
+	size_t halfCount = 0;
+	if (last) {
+		// The outline edges come first, split edges as two halves, then the inner ones.
+		m_OutputStarts.resize(edgeCount + 1);
+		m_OutputStarts[0] = 0;
+		for (size_t edge = 0; edge < edgeCount; edge++) {
+			m_OutputStarts[edge + 1] = m_OutputStarts[edge] + ((m_EdgeVertices[edge] != -1) ? 2 : 1);
+		}
+		halfCount = m_OutputStarts[edgeCount];
+		m_OutputEdges.resize(halfCount + (childCount - faceCount) + m_LooseEdges.size());
+		std::copy(m_LooseEdges.begin(), m_LooseEdges.end(), m_OutputEdges.end() - m_LooseEdges.size());
+		container::GetThreadPool().ParallelFor(edgeCount, s_EdgeGrain, [&](size_t begin, size_t end) {
+			for (size_t edge = begin; edge < end; edge++) {
+				int32_t side = m_EdgeSides[edge * 2], midpoint = m_EdgeVertices[edge];
+				int32_t start = m_Faces[side], finish = m_Faces[s_NextSide(side)];
+				Edge* output = &m_OutputEdges[m_OutputStarts[edge]];
+				if (midpoint == -1) {
+					output[0] = Edge(start, finish);
+				}
+				else {
+					output[0] = Edge(start, midpoint);
+					output[1] = Edge(midpoint, finish);
+				}
+			}
+		});
+	}
+
+	container::GetThreadPool().ParallelFor(faceCount, s_FaceGrain, [&](size_t begin, size_t end) {
+		for (size_t face = begin; face < end; face++) {
+			const int32_t* corners = &m_Faces[face * 3];
+			int32_t midpoints[3], splitCount = 0, splitSide = 0, wholeSide = 0;
+			for (int32_t corner = 0; corner < 3; corner++) {
+				midpoints[corner] = m_EdgeVertices[m_SideEdges[face * 3 + corner]];
+				if (midpoints[corner] != -1) {
+					splitCount++;
+					splitSide = corner;
+				}
+				else {
+					wholeSide = corner;
+				}
+			}
+			int32_t child = m_ChildStarts[face];
+			int32_t* output = &m_NextFaces[(size_t)child * 3];
+			std::fill(m_NextSelected.begin() + child, m_NextSelected.begin() + child + splitCount + 1, m_Selected[face]);
+			if (hasMaterials) {
+				std::fill(m_NextMaterials.begin() + child, m_NextMaterials.begin() + child + splitCount + 1, m_Materials[face]);
+			}
+			int32_t inner[6];
+			if (splitCount == 0) {
+				std::copy(corners, corners + 3, output);
+			}
+			else if (splitCount == 3) {
+				const int32_t children[12] = { corners[0], midpoints[0], midpoints[2], midpoints[0], corners[1], midpoints[1],
+					midpoints[2], midpoints[1], corners[2], midpoints[0], midpoints[1], midpoints[2] };
+				std::copy(children, children + 12, output);
+				const int32_t edges[6] = { midpoints[0], midpoints[1], midpoints[1], midpoints[2], midpoints[2], midpoints[0] };
+				std::copy(edges, edges + 6, inner);
+			}
+			else if (splitCount == 1) {
+				int32_t start = corners[splitSide], finish = corners[(splitSide + 1) % 3], apex = corners[(splitSide + 2) % 3];
+				int32_t midpoint = midpoints[splitSide];
+				const int32_t children[6] = { start, midpoint, apex, midpoint, finish, apex };
+				std::copy(children, children + 6, output);
+				inner[0] = midpoint;
+				inner[1] = apex;
+			}
+			else {
+				// The corner across the whole side is cut off and the quad left over is split
+				// along its shorter diagonal.
+				int32_t start = corners[wholeSide], finish = corners[(wholeSide + 1) % 3], apex = corners[(wholeSide + 2) % 3];
+				int32_t nearFinish = midpoints[(wholeSide + 1) % 3], nearStart = midpoints[(wholeSide + 2) % 3];
+				bool fromStart = s_SquareDistance(m_NextPositions[start], m_NextPositions[nearFinish]) <=
+					s_SquareDistance(m_NextPositions[finish], m_NextPositions[nearStart]);
+				const int32_t children[9] = { nearStart, nearFinish, apex, start, finish, fromStart ? nearFinish : nearStart,
+					fromStart ? start : finish, nearFinish, nearStart };
+				std::copy(children, children + 9, output);
+				inner[0] = nearStart;
+				inner[1] = nearFinish;
+				inner[2] = fromStart ? start : finish;
+				inner[3] = fromStart ? nearFinish : nearStart;
+			}
+			if (numberChildren) {
+				NumberChildren(face);
+			}
+			if (last) {
+				Edge* edges = &m_OutputEdges[halfCount + child - face];
+				for (int32_t edge = 0; edge < splitCount; edge++) {
+					edges[edge] = Edge(inner[edge * 2], inner[edge * 2 + 1]);
+				}
+			}
+		}
+	});
+	m_Positions.swap(m_NextPositions);
+	m_Faces.swap(m_NextFaces);
+	m_Selected.swap(m_NextSelected);
+	if (hasMaterials) {
+		m_Materials.swap(m_NextMaterials);
+	}
+	if (hasUVs) {
+		m_UVs.swap(m_NextUVs);
+	}
+	if (numberChildren) {
+		m_SideEdges.swap(m_NextSideEdges);
+		m_EdgeSides.swap(m_NextEdgeSides);
+	}
+}
+
+void plg::Subdivider::NumberChildren(size_t face) {
+	// Edge e splits into halves 2e, at the end its first side starts from, and 2e + 1; the
+	// three inner edges of face f follow all halves at 2E + 3f. Each child side is given
+	// its edge, and each edge its sides in the slots their parents held.
+	static constexpr int32_t s_HalfSides[3][2] = { { 0, 3 }, { 4, 7 }, { 8, 2 } };
+	static constexpr int32_t s_InnerSides[3][2] = { { 1, 11 }, { 9, 5 }, { 10, 6 } };
+	size_t edgeCount = m_EdgeSides.size() / 2;
+	int32_t firstSide = (int32_t)face * 12;
+	for (int32_t corner = 0; corner < 3; corner++) {
+		int32_t side = (int32_t)face * 3 + corner, edge = m_SideEdges[side];
+		int32_t slot = (m_EdgeSides[edge * 2] == side) ? 0 : (m_EdgeSides[edge * 2 + 1] == side) ? 1 : -1;
+		int32_t towardStart = (m_Faces[side] == m_Faces[m_EdgeSides[edge * 2]]) ? 0 : 1;
+		for (int32_t half = 0; half < 2; half++) {
+			int32_t child = edge * 2 + (half ^ towardStart), childSide = firstSide + s_HalfSides[corner][half];
+			m_NextSideEdges[childSide] = child;
+			if (slot != -1) {
+				m_NextEdgeSides[child * 2 + slot] = childSide;
+			}
+			if (slot == 0 && m_EdgeSides[edge * 2 + 1] == -1) {
+				m_NextEdgeSides[child * 2 + 1] = -1;
+			}
+		}
+	}
+	for (int32_t inner = 0; inner < 3; inner++) {
+		int32_t child = (int32_t)(edgeCount * 2 + face * 3) + inner;
+		m_NextSideEdges[firstSide + s_InnerSides[inner][0]] = child;
+		m_NextSideEdges[firstSide + s_InnerSides[inner][1]] = child;
+		m_NextEdgeSides[child * 2] = firstSide + s_InnerSides[inner][0];
+		m_NextEdgeSides[child * 2 + 1] = firstSide + s_InnerSides[inner][1];
+	}
+}
+
+void plg::Subdivider::Store(Mesh& mesh) {
+	size_t faceCount = m_Faces.size() / 3;
+	m_OutputFaces.resize(faceCount);
+	container::GetThreadPool().ParallelFor(faceCount, s_FaceGrain * 4, [&](size_t begin, size_t end) {
+		for (size_t face = begin; face < end; face++) {
+			m_OutputFaces[face] = Face(m_Faces[face * 3], m_Faces[face * 3 + 1], m_Faces[face * 3 + 2]);
+		}
+	});
+	mesh = Mesh(m_Positions, m_OutputEdges, m_OutputFaces, false);
+	// The new mesh holds the faces and vertices in order, so slots match the dense indices.
+	if (!m_UVs.empty()) {
+		mesh.SetUVs(m_UVs);
+	}
+	for (size_t face = 0; face < m_Materials.size(); face++) {
+		if (m_Materials[face] != MaterialLibrary::DEFAULT_MATERIAL) {
+			mesh.SetFaceMaterial((int32_t)face, m_Materials[face]);
+		}
+	}
+}
+
+void plg::BenchmarkSubdivision(size_t repeatCount) {
+	// A 100 x 100 grid of quads split in two gives 19602 faces.
+	const size_t side = 100;
+	std::vector<Vertex> vertices;
+	std::vector<Face> faces;
+	for (size_t row = 0; row < side; row++) {
+		for (size_t column = 0; column < side; column++) {
+			vertices.push_back(Vertex(8.0f * (float)column, 8.0f * (float)row));
+		}
+	}
+	for (size_t row = 0; row + 1 < side; row++) {
+		for (size_t column = 0; column + 1 < side; column++) {
+			int32_t corner = (int32_t)(row * side + column);
+			faces.push_back(Face(corner, corner + 1, corner + (int32_t)side + 1));
+			faces.push_back(Face(corner, corner + (int32_t)side + 1, corner + (int32_t)side));
+		}
+	}
+	Mesh grid(vertices, {}, faces, false);
+	Subdivider subdivider;
+	const SubdivisionScheme schemes[] = { SubdivisionScheme::MIDPOINT, SubdivisionScheme::LOOP };
+	for (SubdivisionScheme scheme : schemes) {
+		for (uint32_t levels = 1; levels <= 3; levels++) {
+			size_t faceCount = 0;
+			double seconds = 0.0;
+			for (size_t repeat = 0; repeat < repeatCount; repeat++) {
+				Mesh mesh = grid;
+				auto start = std::chrono::high_resolution_clock::now();
+				faceCount = subdivider.Subdivide(mesh, levels, scheme);
+				seconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+			}
+			Log((scheme == SubdivisionScheme::LOOP) ? "Subdivision loop " : "Subdivision midpoint ");
+			Log(levels);
+			Log(" levels: ");
+			Log(seconds * 1000.0 / (double)repeatCount);
+			Log(" ms, ");
+			Log(faceCount);
+			Log(" faces", true);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+#include "core_scene.h"
+#include <span>
+#include <vector>
+
+namespace plg {
+	enum class SubdivisionScheme {
+		MIDPOINT, LOOP
+	};
+
+	// Splits triangles into four through their edge midpoints, with Loop's masks moving the
+	// new and old vertices towards a smooth surface when asked. Each level numbers the edges
+	// once through a table bucketed by their lower vertex, so a shared edge gets a single
+	// midpoint, then writes every face's children next to each other from the thread pool.
+	// Buffers are kept between calls and the whole subdivision is sized up front.
+	class Subdivider {
+	public:
+		// Subdivides every face the given number of times; returns the new face count.
+		size_t Subdivide(Mesh& mesh, uint32_t levels, SubdivisionScheme scheme = SubdivisionScheme::MIDPOINT);
+		// Subdivides only the given face slots, and again the faces grown from them on every
+		// further level. Neighbours sharing a split edge are cut in two or three so the mesh
+		// stays connected, and under Loop only vertices away from them are smoothed.
+		size_t Subdivide(Mesh& mesh, std::span<const int32_t> faces, uint32_t levels, SubdivisionScheme scheme = SubdivisionScheme::MIDPOINT);
+
+	private:
+		bool Load(Mesh& mesh, std::span<const int32_t> faces, bool all);
+		void Reserve(uint32_t levels);
+		void BuildEdges();
+		void SplitLevel(SubdivisionScheme scheme, bool last, bool numberChildren);
+		void NumberChildren(size_t face);
+		void Store(Mesh& mesh);
+
+		// Faces are three corners each; side face * 3 + corner runs to the next corner.
+		std::vector<Vec2> m_Positions;
+		std::vector<Vec2> m_NextPositions;
+		std::vector<int32_t> m_Faces;
+		std::vector<int32_t> m_NextFaces;
+		std::vector<uint8_t> m_Selected;
+		std::vector<uint8_t> m_NextSelected;
+		// Carried along only when the mesh has them: children keep their parent's material
+		// and midpoints take the mean of their edge's uvs.
+		std::vector<MaterialID> m_Materials;
+		std::vector<MaterialID> m_NextMaterials;
+		std::vector<Vec2> m_UVs;
+		std::vector<Vec2> m_NextUVs;
+		std::vector<int32_t> m_VertexRemap;
+		std::vector<int32_t> m_FaceRemap;
+		// Sides grouped by lower vertex, the edge of each side and up to two sides per edge.
+		std::vector<int32_t> m_BucketStarts;
+		std::vector<int32_t> m_BucketFill;
+		std::vector<int32_t> m_BucketSides;
+		std::vector<int32_t> m_SideEdges;
+		std::vector<int32_t> m_NextSideEdges;
+		std::vector<int32_t> m_EdgeStarts;
+		std::vector<int32_t> m_EdgeSides;
+		std::vector<int32_t> m_NextEdgeSides;
+		// The midpoint vertex of every edge, -1 for edges left whole.
+		std::vector<int32_t> m_EdgeVertices;
+		std::vector<int32_t> m_ChildStarts;
+		std::vector<int32_t> m_OutputStarts;
+		std::vector<Vec2> m_NeighbourSums;
+		std::vector<Vec2> m_BoundarySums;
+		std::vector<int32_t> m_Valences;
+		std::vector<int32_t> m_BoundaryCounts;
+		std::vector<uint8_t> m_Pinned;
+		std::vector<Edge> m_OutputEdges;
+		std::vector<Edge> m_LooseEdges;
+		std::vector<Face> m_OutputFaces;
+	};
+
+	// Logs the time of one to three levels over a grid of about 20k faces, both schemes.
+	void BenchmarkSubdivision(size_t repeatCount = 10);
+}
\ No newline at end of file
@@ -0,0 +1,134 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace container {
+	// Fixed set of worker threads shared by every parallel loop in the program. The
+	// calling thread always takes part in its own loop, so ParallelFor may be nested
+	// and still completes when no worker is free.
+	class ThreadPool {
+	public:
+		ThreadPool(size_t workerCount = s_DefaultWorkerCount()) {
+			for (size_t i = 0; i < workerCount; i++) {
+				m_Workers.emplace_back([this]() { WorkerLoop(); });
+			}
+		}
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		~ThreadPool() {
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_Stop = true;
+			}
+			m_Wake.notify_all();
+			for (auto& worker : m_Workers) {
+				worker.join();
+			}
+		}
+
+		size_t GetWorkerCount() const { return m_Workers.size(); }
+		size_t GetThreadCount() const { return m_Workers.size() + 1; }
+
+		// Splits [0, count) into chunks of grain and calls func(begin, end) for each,
+		// returning once every chunk has finished.
+		template<typename T_func>
+		void ParallelFor(size_t count, size_t grain, T_func&& func) {
+			if (count == 0) {
+				return;
+			}
+			grain = (grain > 0) ? grain : 1;
+			if (m_Workers.empty() || count <= grain) {
+				func((size_t)0, count);
+				return;
+			}
+			Job job;
+			job.invoke = [](void* context, size_t begin, size_t end) { (*(std::remove_reference_t<T_func>*)context)(begin, end); };
+			job.context = (void*)&func;
+			job.count = count;
+			job.grain = grain;
+			job.chunkCount = (count + grain - 1) / grain;
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_Jobs.push_back(&job);
+			}
+			m_Wake.notify_all();
+			while (RunChunk(&job)) { }
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				RemoveJob(&job);
+			}
+			while (job.activeWorkers.load(std::memory_order_acquire) != 0) {
+				std::this_thread::yield();
+			}
+		}
+
+	private:
+		struct Job {
+			void (*invoke)(void*, size_t, size_t) = nullptr;
+			void* context = nullptr;
+			size_t count = 0;
+			size_t grain = 1;
+			size_t chunkCount = 0;
+			std::atomic<size_t> nextChunk = 0;
+			std::atomic<size_t> activeWorkers = 0;
+		};
+
+		static size_t s_DefaultWorkerCount() {
+			size_t hardwareThreads = std::thread::hardware_concurrency();
+			return (hardwareThreads > 1) ? hardwareThreads - 1 : 0;
+		}
+
+		bool RunChunk(Job* job) {
+			size_t chunk = job->nextChunk.fetch_add(1, std::memory_order_relaxed);
+			if (chunk >= job->chunkCount) {
+				return false;
+			}
+			size_t begin = chunk * job->grain;
+			size_t end = std::min(begin + job->grain, job->count);
+			job->invoke(job->context, begin, end);
+			return true;
+		}
+
+		void RemoveJob(Job* job) {
+			auto it = std::find(m_Jobs.begin(), m_Jobs.end(), job);
+			if (it != m_Jobs.end()) {
+				m_Jobs.erase(it);
+			}
+		}
+
+		void WorkerLoop() {
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			while (true) {
+				m_Wake.wait(lock, [this]() { return m_Stop || !m_Jobs.empty(); });
+				if (m_Stop) {
+					return;
+				}
+				Job* job = m_Jobs.back();
+				job->activeWorkers.fetch_add(1, std::memory_order_relaxed);
+				lock.unlock();
+				while (RunChunk(job)) { }
+				lock.lock();
+				RemoveJob(job);
+				job->activeWorkers.fetch_sub(1, std::memory_order_release);
+			}
+		}
+
+		std::vector<std::thread> m_Workers;
+		std::vector<Job*> m_Jobs;
+		std::mutex m_Mutex;
+		std::condition_variable m_Wake;
+		bool m_Stop = false;
+	};
+
+	inline ThreadPool& GetThreadPool() {
+		static ThreadPool threadPool;
+		return threadPool;
+	}
+}
\ No newline at end of file
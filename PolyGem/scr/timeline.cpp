@@ -0,0 +1,159 @@
+#include "timeline.h"
+
+const float* plg::TimelineCache::FindPose(AnimationClip* clip, int32_t frame, float time) {
+	auto entry = m_Entries.find(frame);
+	if (entry == m_Entries.end()) {
+		return nullptr;
+	}
+	Refresh(clip, entry->second, time);
+	Touch(entry->second);
+	return entry->second.pose.data();
+}
+
+const float* plg::TimelineCache::StorePose(AnimationClip* clip, int32_t frame, float time) {
+	auto found = m_Entries.find(frame);
+	if (found != m_Entries.end()) {
+		Refresh(clip, found->second, time);
+		Touch(found->second);
+		return found->second.pose.data();
+	}
+	Entry& entry = m_Entries[frame];
+	m_Order.push_front(frame);
+	entry.order = m_Order.begin();
+	Refresh(clip, entry, time);
+	Evict();
+	return m_Entries[frame].pose.data();
+}
+
+SDL_Texture* plg::TimelineCache::FindTexture(AnimationClip* clip, int32_t frame) {
+	auto entry = m_Entries.find(frame);
+	if (entry == m_Entries.end() || entry->second.texture == nullptr) {
+		return nullptr;
+	}
+	if (entry->second.clipRevision != clip->GetRevision()) {
+		return nullptr;
+	}
+	Touch(entry->second);
+	return entry->second.texture;
+}
+
+void plg::TimelineCache::StoreTexture(int32_t frame, SDL_Texture* texture, size_t textureBytes) {
+	auto found = m_Entries.find(frame);
+	if (found == m_Entries.end()) {
+		Log("Warning! A frame texture can only be cached for a frame with a cached pose!", true);
+		SDL_DestroyTexture(texture);
+		return;
+	}
+	Entry& entry = found->second;
+	DropTexture(entry);
+	entry.texture = texture;
+	entry.textureBytes = textureBytes;
+	m_MemoryUsage += textureBytes;
+	Touch(entry);
+	Evict();
+}
+
+void plg::TimelineCache::InvalidateTextures() {
+	for (auto& entry : m_Entries) {
+		DropTexture(entry.second);
+	}
+}
+
+void plg::TimelineCache::Clear() {
+	InvalidateTextures();
+	m_Entries.clear();
+	m_Order.clear();
+	m_MemoryUsage = 0;
+}
+
+void plg::TimelineCache::SetMemoryBudget(size_t memoryBudget) {
+	m_MemoryBudget = memoryBudget;
+	Evict();
+}
+
+bool plg::TimelineCache::Refresh(AnimationClip* clip, Entry& entry, float time) {
+	if (entry.clipRevision == clip->GetRevision() && entry.pose.size() == clip->GetTrackCount()) {
+		return false;
+	}
+	m_MemoryUsage -= GetPoseBytes(entry);
+	size_t trackCount = clip->GetTrackCount();
+	size_t cachedCount = entry.pose.size();
+	entry.pose.resize(trackCount);
+	entry.trackRevisions.resize(trackCount);
+	bool changed = false;
+	for (size_t track = 0; track < trackCount; track++) {
+		uint32_t revision = clip->GetTrackRevision((TrackID)track);
+		if (track >= cachedCount || entry.trackRevisions[track] != revision) {
+			entry.pose[track] = clip->Evaluate((TrackID)track, time);
+			entry.trackRevisions[track] = revision;
+			changed = true;
+		}
+	}
+	entry.clipRevision = clip->GetRevision();
+	m_MemoryUsage += GetPoseBytes(entry);
+	if (changed) {
+		DropTexture(entry);
+	}
+	return changed;
+}
+
+void plg::TimelineCache::Touch(Entry& entry) {
+	m_Order.splice(m_Order.begin(), m_Order, entry.order);
+}
+
+void plg::TimelineCache::DropTexture(Entry& entry) {
+	if (entry.texture != nullptr) {
+		SDL_DestroyTexture(entry.texture);
+		m_MemoryUsage -= entry.textureBytes;
+		entry.texture = nullptr;
+		entry.textureBytes = 0;
+	}
+}
+
+void plg::TimelineCache::Evict() {
+	// The most recently used entry always survives, even when it alone exceeds the budget.
+	while (m_MemoryUsage > m_MemoryBudget && m_Order.size() > 1) {
+		int32_t frame = m_Order.back();
+		Entry& entry = m_Entries[frame];
+		DropTexture(entry);
+		m_MemoryUsage -= GetPoseBytes(entry);
+		m_Order.pop_back();
+		m_Entries.erase(frame);
+	}
+}
+
+void plg::Timeline::SetPlayhead(int32_t frame) {
+	m_Playhead = frame;
+	float time = GetFrameTime(frame);
+	const float* pose = m_Cache.FindPose(m_Clip, frame, time);
+	if (pose == nullptr) {
+		pose = m_Cache.StorePose(m_Clip, frame, time);
+	}
+	m_Clip->Apply(pose, m_Graph);
+}
+
+bool plg::Timeline::RenderCachedFrame(SDL_Renderer* renderer, const SDL_Rect* destination) {
+	SDL_Texture* texture = m_Cache.FindTexture(m_Clip, m_Playhead);
+	if (texture == nullptr) {
+		return false;
+	}
+	SDL_RenderCopy(renderer, texture, NULL, destination);
+	return true;
+}
+
+void plg::Timeline::StoreRenderedFrame(SDL_Renderer* renderer, SDL_Texture* source) {
+	uint32_t format;
+	int width, height;
+	SDL_QueryTexture(source, &format, NULL, &width, &height);
+	SDL_Texture* texture = SDL_CreateTexture(renderer, format, SDL_TEXTUREACCESS_TARGET, width, height);
+	if (texture == NULL) {
+		Log("Unable to create the frame cache texture! ", false);
+		Log(SDL_GetError(), true);
+		return;
+	}
+	SDL_Texture* target = SDL_GetRenderTarget(renderer);
+	SDL_SetRenderTarget(renderer, texture);
+	SDL_RenderCopy(renderer, source, NULL, NULL);
+	SDL_SetRenderTarget(renderer, target);
+	m_Cache.StoreTexture(m_Playhead, texture, (size_t)width * (size_t)height * SDL_BYTESPERPIXEL(format));
+}
\ No newline at end of file
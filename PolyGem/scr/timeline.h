@@ -0,0 +1,73 @@
+#pragma once
+#include "animation.h"
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace plg {
+	// Evaluated poses, and optionally rendered frames, of recently visited timeline
+	// frames. Entries are evicted least recently used first once the memory budget is
+	// exceeded. Every entry remembers the track revisions it was evaluated with, so a
+	// key edit only re-evaluates the tracks that changed and drops the cached texture.
+	class TimelineCache {
+	public:
+		TimelineCache(size_t memoryBudget = 256u << 20) : m_MemoryBudget(memoryBudget) { }
+		TimelineCache(const TimelineCache&) = delete;
+		TimelineCache& operator=(const TimelineCache&) = delete;
+		~TimelineCache() { Clear(); }
+
+		const float* FindPose(AnimationClip* clip, int32_t frame, float time);
+		const float* StorePose(AnimationClip* clip, int32_t frame, float time);
+		SDL_Texture* FindTexture(AnimationClip* clip, int32_t frame);
+		void StoreTexture(int32_t frame, SDL_Texture* texture, size_t textureBytes);
+		void InvalidateTextures();
+		void Clear();
+
+		void SetMemoryBudget(size_t memoryBudget);
+		size_t GetMemoryUsage() const { return m_MemoryUsage; }
+		size_t GetEntryCount() const { return m_Entries.size(); }
+
+	private:
+		struct Entry {
+			std::vector<float> pose;
+			std::vector<uint32_t> trackRevisions;
+			uint32_t clipRevision = 0;
+			SDL_Texture* texture = nullptr;
+			size_t textureBytes = 0;
+			std::list<int32_t>::iterator order;
+		};
+
+		bool Refresh(AnimationClip* clip, Entry& entry, float time);
+		void Touch(Entry& entry);
+		void DropTexture(Entry& entry);
+		void Evict();
+		size_t GetPoseBytes(const Entry& entry) const { return entry.pose.size() * sizeof(float) + entry.trackRevisions.size() * sizeof(uint32_t); }
+
+		std::unordered_map<int32_t, Entry> m_Entries;
+		std::list<int32_t> m_Order;
+		size_t m_MemoryBudget;
+		size_t m_MemoryUsage = 0;
+	};
+
+	class Timeline {
+	public:
+		Timeline(AnimationClip* clip, SceneGraph* graph, float frameRate = 24.0f) : m_Clip(clip), m_Graph(graph), m_FrameRate(frameRate) { }
+
+		void SetPlayhead(int32_t frame);
+		int32_t GetPlayhead() const { return m_Playhead; }
+		float GetFrameTime(int32_t frame) const { return (float)frame / m_FrameRate; }
+		float GetFrameRate() const { return m_FrameRate; }
+		bool RenderCachedFrame(SDL_Renderer* renderer, const SDL_Rect* destination);
+		void StoreRenderedFrame(SDL_Renderer* renderer, SDL_Texture* source);
+		AnimationClip* GetClip() { return m_Clip; }
+		SceneGraph* GetGraph() { return m_Graph; }
+		TimelineCache* GetCache() { return &m_Cache; }
+
+	private:
+		AnimationClip* m_Clip;
+		SceneGraph* m_Graph;
+		float m_FrameRate;
+		int32_t m_Playhead = 0;
+		TimelineCache m_Cache;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,597 @@
+#include "triangulator.h"
+#include <algorithm>
+#include <cmath>
+
+// Set on every segment side; the low bits carry the regions the segment bounds.
+static constexpr uint8_t s_SegmentFlag = 0x80;
+
+static double s_Orient(const plg::Vec2& a, const plg::Vec2& b, const plg::Vec2& c) {
+	return ((double)b.x - a.x) * ((double)c.y - a.y) - ((double)b.y - a.y) * ((double)c.x - a.x);
+}
+
+static double s_InCircle(const plg::Vec2& a, const plg::Vec2& b, const plg::Vec2& c, const plg::Vec2& d) {
+	double adx = (double)a.x - d.x, ady = (double)a.y - d.y;
+	double bdx = (double)b.x - d.x, bdy = (double)b.y - d.y;
+	double cdx = (double)c.x - d.x, cdy = (double)c.y - d.y;
+	double ad = adx * adx + ady * ady, bd = bdx * bdx + bdy * bdy, cd = cdx * cdx + cdy * cdy;
+	return adx * (bdy * cd - bd * cdy) - ady * (bdx * cd - bd * cdx) + ad * (bdx * cdy - bdy * cdx);
+}
+
+// Pseudo-angle of the point around the centre in [0, 1): monotonic in the real angle and
+// cheaper to get.
+static double s_PseudoAngle(const plg::Vec2& center, const plg::Vec2& point) {
+	double dx = (double)point.x - center.x, dy = (double)point.y - center.y;
+	double sum = std::abs(dx) + std::abs(dy);
+	double ratio = (sum > 0.0) ? dx / sum : 0.0;
+	return ((dy > 0.0) ? 3.0 - ratio : 1.0 + ratio) * 0.25;
+}
+
+// Positive when c lies ahead of a in the direction of b.
+static double s_Ahead(const plg::Vec2& a, const plg::Vec2& b, const plg::Vec2& c) {
+	return ((double)b.x - a.x) * ((double)c.x - a.x) + ((double)b.y - a.y) * ((double)c.y - a.y);
+}
+
+size_t plg::Triangulator::Triangulate(std::span<const Vec2> points, std::span<const Edge> segments) {
+	Sweep(points);
+	if (m_Corners.empty()) {
+		return 0;
+	}
+	for (const Edge& segment : segments) {
+		if ((size_t)segment.m_Start >= points.size() || (size_t)segment.m_End >= points.size()) {
+			Log("Warning! Triangulation segment is out of range!", true);
+			continue;
+		}
+		int32_t start = m_Remap[segment.m_Start], end = m_Remap[segment.m_End];
+		if (start != end) {
+			InsertSegment(start, end, 0);
+		}
+	}
+	m_Output.assign(m_Corners.begin(), m_Corners.end());
+	return GetTriangleCount();
+}
+
+size_t plg::Triangulator::TriangulateRegions(std::span<const Vec2> points, std::span<const Edge> segments, std::span<const uint8_t> segmentRegions) {
+	Sweep(points);
+	if (m_Corners.empty()) {
+		m_Regions.clear();
+		return 0;
+	}
+	for (size_t segment = 0; segment < segments.size(); segment++) {
+		if ((size_t)segments[segment].m_Start >= points.size() || (size_t)segments[segment].m_End >= points.size()) {
+			Log("Warning! Triangulation segment is out of range!", true);
+			continue;
+		}
+		int32_t start = m_Remap[segments[segment].m_Start], end = m_Remap[segments[segment].m_End];
+		uint8_t regions = (segment < segmentRegions.size()) ? (uint8_t)(segmentRegions[segment] & ~s_SegmentFlag) : 0;
+		if (start != end) {
+			InsertSegment(start, end, regions);
+		}
+	}
+	FloodRegions();
+	m_Output.assign(m_Corners.begin(), m_Corners.end());
+	m_Regions.resize(m_Depth.size());
+	for (size_t triangle = 0; triangle < m_Depth.size(); triangle++) {
+		m_Regions[triangle] = (uint8_t)m_Depth[triangle];
+	}
+	return GetTriangleCount();
+}
+
+size_t plg::Triangulator::TriangulatePolygon(std::span<const Vec2> points, std::span<const uint32_t> contourEnds) {
+	Sweep(points);
+	if (m_Corners.empty()) {
+		return 0;
+	}
+	size_t contourCount = contourEnds.empty() ? 1 : contourEnds.size();
+	uint32_t first = 0;
+	for (size_t contour = 0; contour < contourCount; contour++) {
+		uint32_t last = contourEnds.empty() ? (uint32_t)points.size() : std::min(contourEnds[contour], (uint32_t)points.size());
+		for (uint32_t point = first; point < last; point++) {
+			int32_t start = m_Remap[point], end = m_Remap[(point + 1 == last) ? first : point + 1];
+			if (start != end) {
+				InsertSegment(start, end, 1);
+			}
+		}
+		first = last;
+	}
+	FloodRegions();
+	m_Output.clear();
+	for (size_t triangle = 0; triangle < m_Depth.size(); triangle++) {
+		if (m_Depth[triangle] & 1) {
+			m_Output.insert(m_Output.end(), m_Corners.begin() + triangle * 3, m_Corners.begin() + triangle * 3 + 3);
+		}
+	}
+	return GetTriangleCount();
+}
+
+void plg::Triangulator::FloodRegions() {
+	// Floods inwards from the hull; crossing a segment toggles the regions it bounds.
+	size_t triangleCount = m_Corners.size() / 3;
+	m_Depth.assign(triangleCount, -1);
+	m_Stack.clear();
+	for (size_t triangle = 0; triangle < triangleCount; triangle++) {
+		for (size_t corner = 0; corner < 3 && m_Depth[triangle] == -1; corner++) {
+			if (m_Twins[triangle * 3 + corner] == -1) {
+				m_Depth[triangle] = m_Locked[triangle * 3 + corner] & ~s_SegmentFlag;
+				m_Stack.push_back((int32_t)triangle);
+			}
+		}
+	}
+	while (!m_Stack.empty()) {
+		int32_t triangle = m_Stack.back();
+		m_Stack.pop_back();
+		for (int32_t corner = 0; corner < 3; corner++) {
+			int32_t twin = m_Twins[triangle * 3 + corner];
+			if (twin != -1 && m_Depth[twin / 3] == -1) {
+				m_Depth[twin / 3] = m_Depth[triangle] ^ (m_Locked[triangle * 3 + corner] & ~s_SegmentFlag);
+				m_Stack.push_back(twin / 3);
+			}
+		}
+	}
+}
+
+void plg::Triangulator::Sweep(std::span<const Vec2> points) {
+	m_Points = points.data();
+	m_Corners.clear();
+	m_Twins.clear();
+	m_Locked.clear();
+	m_Stack.clear();
+	m_Output.clear();
+	m_SkippedSegments = 0;
+	size_t count = points.size();
+	m_PointTriangles.assign(count, -1);
+	m_HullNext.assign(count, -1);
+	m_HullPrevious.assign(count, -1);
+	m_HullSides.assign(count, -1);
+	m_Remap.resize(count);
+	m_Order.resize(count);
+	m_Distances.resize(count);
+	if (count == 0) {
+		return;
+	}
+	// The seed is the point nearest the centre of the bounds, its nearest neighbour, and the
+	// point closing the Delaunay triangle on that edge, so no other point lies inside the
+	// seed's circumcircle. Sorted outwards from the circumcentre every point then lies
+	// outside the hull of the ones before it.
+	Vec2 topLeft = points[0], bottomRight = points[0];
+	for (const Vec2& point : points) {
+		topLeft = Vec2(std::min(topLeft.x, point.x), std::min(topLeft.y, point.y));
+		bottomRight = Vec2(std::max(bottomRight.x, point.x), std::max(bottomRight.y, point.y));
+	}
+	Vec2 middle = (topLeft + bottomRight) * 0.5f;
+	auto squareDistance = [](const Vec2& a, const Vec2& b) {
+		double dx = (double)a.x - b.x, dy = (double)a.y - b.y;
+		return dx * dx + dy * dy;
+	};
+	int32_t seed[3] = { 0, -1, -1 };
+	double best = squareDistance(points[0], middle);
+	for (size_t point = 1; point < count; point++) {
+		double distance = squareDistance(points[point], middle);
+		if (distance < best) {
+			best = distance;
+			seed[0] = (int32_t)point;
+		}
+	}
+	best = INFINITY;
+	for (size_t point = 0; point < count; point++) {
+		double distance = squareDistance(points[point], points[seed[0]]);
+		if (distance > 0.0 && distance < best) {
+			best = distance;
+			seed[1] = (int32_t)point;
+		}
+	}
+	if (seed[1] == -1) {
+		return;
+	}
+	// The circumcentre of a, b and p sits at chord middle + t * normal; on either side of
+	// the chord the Delaunay point is the one whose circle bulges least to that side.
+	Vec2 a = points[seed[0]], b = points[seed[1]];
+	double chordX = ((double)a.x + b.x) * 0.5, chordY = ((double)a.y + b.y) * 0.5;
+	double normalX = -((double)b.y - a.y), normalY = (double)b.x - a.x;
+	double halfChord = squareDistance(a, b) * 0.25, bestOffset = INFINITY;
+	bool left = false;
+	for (size_t point = 0; point < count; point++) {
+		double dx = (double)points[point].x - chordX, dy = (double)points[point].y - chordY;
+		double height = dx * normalX + dy * normalY;
+		if (s_Orient(a, b, points[point]) == 0.0 || height == 0.0 || (left && height < 0.0)) {
+			continue;
+		}
+		double offset = (dx * dx + dy * dy - halfChord) / (2.0 * std::abs(height));
+		if (!left && height > 0.0) {
+			// Any point to the left wins over the right side.
+			left = true;
+			bestOffset = INFINITY;
+		}
+		if (offset < bestOffset) {
+			bestOffset = offset;
+			seed[2] = (int32_t)point;
+		}
+	}
+	if (seed[2] == -1) {
+		return;
+	}
+	double offset = left ? bestOffset : -bestOffset;
+	m_Center = Vec2((float)(chordX + offset * normalX), (float)(chordY + offset * normalY));
+	for (size_t point = 0; point < count; point++) {
+		m_Distances[point] = squareDistance(points[point], m_Center);
+		m_Order[point] = (uint32_t)point;
+	}
+	// Ties are broken by the angle around the centre, so points on one circle go in order
+	// round it and each lands next to the last on the hull; coincident points end up next
+	// to each other.
+	std::sort(m_Order.begin(), m_Order.end(), [&](uint32_t first, uint32_t second) {
+		if (m_Distances[first] != m_Distances[second]) {
+			return m_Distances[first] < m_Distances[second];
+		}
+		double firstAngle = s_PseudoAngle(m_Center, points[first]), secondAngle = s_PseudoAngle(m_Center, points[second]);
+		if (firstAngle != secondAngle) {
+			return firstAngle < secondAngle;
+		}
+		return (points[first].x < points[second].x) || (points[first].x == points[second].x && points[first].y < points[second].y);
+	});
+	size_t unique = 0;
+	for (size_t index = 0; index < count; index++) {
+		uint32_t point = m_Order[index];
+		if (unique > 0 && points[m_Order[unique - 1]].x == points[point].x && points[m_Order[unique - 1]].y == points[point].y) {
+			m_Remap[point] = (int32_t)m_Order[unique - 1];
+			continue;
+		}
+		m_Remap[point] = (int32_t)point;
+		m_Order[unique++] = point;
+	}
+	for (int32_t& corner : seed) {
+		corner = m_Remap[corner];
+	}
+
+	int32_t triangle = (s_Orient(points[seed[0]], points[seed[1]], points[seed[2]]) > 0.0) ?
+		AddTriangle(seed[0], seed[1], seed[2]) : AddTriangle(seed[1], seed[0], seed[2]);
+	m_HullHash.assign((size_t)std::ceil(std::sqrt((double)unique)), -1);
+	for (int32_t corner = 0; corner < 3; corner++) {
+		int32_t start = m_Corners[triangle * 3 + corner], end = m_Corners[triangle * 3 + (corner + 1) % 3];
+		m_HullNext[start] = end;
+		m_HullPrevious[end] = start;
+		m_HullSides[start] = triangle * 3 + corner;
+		m_HullHash[HashKey(points[start])] = start;
+	}
+	for (size_t index = 0; index < unique; index++) {
+		int32_t point = (int32_t)m_Order[index];
+		if (point != seed[0] && point != seed[1] && point != seed[2]) {
+			InsertOutside(point);
+		}
+	}
+}
+
+size_t plg::Triangulator::HashKey(const Vec2& point) const {
+	return (size_t)(s_PseudoAngle(m_Center, point) * (double)m_HullHash.size()) % m_HullHash.size();
+}
+
+int32_t plg::Triangulator::AddTriangle(int32_t vert1, int32_t vert2, int32_t vert3) {
+	int32_t triangle = (int32_t)(m_Corners.size() / 3);
+	m_Corners.insert(m_Corners.end(), { vert1, vert2, vert3 });
+	m_Twins.insert(m_Twins.end(), { -1, -1, -1 });
+	m_Locked.insert(m_Locked.end(), { 0, 0, 0 });
+	m_PointTriangles[vert1] = triangle;
+	m_PointTriangles[vert2] = triangle;
+	m_PointTriangles[vert3] = triangle;
+	return triangle;
+}
+
+void plg::Triangulator::SetSide(int32_t triangle, int32_t corner, int32_t twin, uint8_t locked) {
+	m_Twins[triangle * 3 + corner] = twin;
+	m_Locked[triangle * 3 + corner] = locked;
+	if (twin != -1) {
+		m_Twins[twin] = triangle * 3 + corner;
+		m_Locked[twin] = locked;
+	}
+}
+
+plg::Triangulator::TriangleSides plg::Triangulator::ReadTriangle(int32_t triangle, int32_t side) const {
+	TriangleSides sides;
+	for (int32_t offset = 0; offset < 3; offset++) {
+		int32_t corner = triangle * 3 + (side + offset) % 3;
+		sides.vertex[offset] = m_Corners[corner];
+		sides.twin[offset] = m_Twins[corner];
+		sides.locked[offset] = m_Locked[corner];
+	}
+	return sides;
+}
+
+template<typename T_func>
+bool plg::Triangulator::VisitFan(int32_t vertex, T_func&& func) const {
+	int32_t start = m_PointTriangles[vertex];
+	if (start == -1) {
+		return false;
+	}
+	int32_t startCorner = (m_Corners[start * 3] == vertex) ? 0 : (m_Corners[start * 3 + 1] == vertex) ? 1 : 2;
+	int32_t triangle = start, corner = startCorner;
+	for (;;) {
+		if (func(triangle, corner)) {
+			return true;
+		}
+		int32_t twin = m_Twins[triangle * 3 + (corner + 2) % 3];
+		if (twin == -1) {
+			break;
+		}
+		triangle = twin / 3;
+		corner = twin % 3;
+		if (triangle == start) {
+			return false;
+		}
+	}
+	// The fan opens onto the hull, so the triangles on the other side of the start remain.
+	triangle = start;
+	corner = startCorner;
+	for (;;) {
+		int32_t twin = m_Twins[triangle * 3 + corner];
+		if (twin == -1) {
+			return false;
+		}
+		triangle = twin / 3;
+		corner = (twin % 3 + 1) % 3;
+		if (func(triangle, corner)) {
+			return true;
+		}
+	}
+}
+
+void plg::Triangulator::InsertOutside(int32_t vertex) {
+	const Vec2* points = m_Points;
+	Vec2 point = points[vertex];
+	auto facesPoint = [&](int32_t start) {
+		return s_Orient(points[start], points[m_HullNext[start]], point) < 0.0;
+	};
+	// The hash gives a hull vertex near the point's direction. The hull is walked both
+	// ways from it at once, so a side facing the point is found in as many steps as it
+	// lies away from the hash vertex rather than after a lap of the hull.
+	size_t key = HashKey(point);
+	int32_t start = -1;
+	for (size_t offset = 0; offset < m_HullHash.size(); offset++) {
+		start = m_HullHash[(key + offset) % m_HullHash.size()];
+		if (start != -1 && m_HullNext[start] != -1) {
+			break;
+		}
+	}
+	int32_t first = start, backward = m_HullPrevious[start];
+	for (;;) {
+		if (facesPoint(first)) {
+			break;
+		}
+		if (first == backward) {
+			// Only a point tied with the hull within rounding lands here; it is left out.
+			return;
+		}
+		if (facesPoint(backward)) {
+			first = backward;
+			break;
+		}
+		first = m_HullNext[first];
+		backward = m_HullPrevious[backward];
+		if (m_HullNext[backward] == first) {
+			return;
+		}
+	}
+
+	int32_t next = m_HullNext[first];
+	int32_t added = AddTriangle(next, first, vertex);
+	SetSide(added, 0, m_HullSides[first], m_Locked[m_HullSides[first]]);
+	m_HullSides[first] = added * 3 + 1;
+	m_HullSides[vertex] = added * 3 + 2;
+	m_Stack.push_back(added * 3);
+	Legalize(true);
+	while (facesPoint(next)) {
+		int32_t after = m_HullNext[next];
+		added = AddTriangle(after, next, vertex);
+		SetSide(added, 0, m_HullSides[next], 0);
+		SetSide(added, 1, m_HullSides[vertex], 0);
+		m_HullSides[vertex] = added * 3 + 2;
+		m_HullNext[next] = -1;
+		m_Stack.push_back(added * 3);
+		Legalize(true);
+		next = after;
+	}
+	while (facesPoint(m_HullPrevious[first])) {
+		int32_t before = m_HullPrevious[first];
+		added = AddTriangle(first, before, vertex);
+		SetSide(added, 0, m_HullSides[before], 0);
+		SetSide(added, 2, m_HullSides[first], 0);
+		m_HullSides[before] = added * 3 + 1;
+		m_HullNext[first] = -1;
+		m_Stack.push_back(added * 3);
+		Legalize(true);
+		first = before;
+	}
+	m_HullNext[first] = vertex;
+	m_HullPrevious[vertex] = first;
+	m_HullNext[vertex] = next;
+	m_HullPrevious[next] = vertex;
+	m_HullHash[HashKey(point)] = vertex;
+	m_HullHash[HashKey(points[first])] = first;
+}
+
+void plg::Triangulator::Flip(int32_t side) {
+	int32_t triangle = side / 3, twin = m_Twins[side], other = twin / 3;
+	TriangleSides near = ReadTriangle(triangle, side % 3), far = ReadTriangle(other, twin % 3);
+	int32_t vertA = near.vertex[0], vertB = near.vertex[1], vertC = near.vertex[2], vertD = far.vertex[2];
+	m_Corners[triangle * 3] = vertC;
+	m_Corners[triangle * 3 + 1] = vertA;
+	m_Corners[triangle * 3 + 2] = vertD;
+	m_Corners[other * 3] = vertD;
+	m_Corners[other * 3 + 1] = vertB;
+	m_Corners[other * 3 + 2] = vertC;
+	SetSide(triangle, 0, near.twin[2], near.locked[2]);
+	SetSide(triangle, 1, far.twin[1], far.locked[1]);
+	SetSide(other, 0, far.twin[2], far.locked[2]);
+	SetSide(other, 1, near.twin[1], near.locked[1]);
+	SetSide(triangle, 2, other * 3 + 2, 0);
+	m_PointTriangles[vertA] = triangle;
+	m_PointTriangles[vertC] = triangle;
+	m_PointTriangles[vertD] = triangle;
+	m_PointTriangles[vertB] = other;
+	// Hull sides may have moved to the other triangle of the pair.
+	for (int32_t side : { triangle * 3, triangle * 3 + 1, other * 3, other * 3 + 1 }) {
+		if (m_Twins[side] == -1) {
+			m_HullSides[m_Corners[side]] = side;
+		}
+	}
+}
+
+void plg::Triangulator::Legalize(bool fromApex) {
+	while (!m_Stack.empty()) {
+		int32_t side = m_Stack.back();
+		m_Stack.pop_back();
+		int32_t twin = m_Twins[side];
+		if (twin == -1 || m_Locked[side]) {
+			continue;
+		}
+		int32_t triangle = side / 3, corner = side % 3, other = twin / 3;
+		int32_t vertA = m_Corners[side], vertB = m_Corners[triangle * 3 + (corner + 1) % 3], vertC = m_Corners[triangle * 3 + (corner + 2) % 3];
+		int32_t vertD = m_Corners[other * 3 + (twin % 3 + 2) % 3];
+		if (s_InCircle(m_Points[vertA], m_Points[vertB], m_Points[vertC], m_Points[vertD]) > 0.0) {
+			Flip(side);
+			// Sides touching a new apex are legal already; only the far ones need a look.
+			if (!fromApex) {
+				m_Stack.push_back(triangle * 3);
+				m_Stack.push_back(other * 3 + 1);
+			}
+			m_Stack.push_back(triangle * 3 + 1);
+			m_Stack.push_back(other * 3);
+		}
+	}
+}
+
+int32_t plg::Triangulator::FindSide(int32_t start, int32_t end) const {
+	int32_t found = -1;
+	VisitFan(start, [&](int32_t triangle, int32_t corner) {
+		if (m_Corners[triangle * 3 + (corner + 1) % 3] == end) {
+			found = triangle * 3 + corner;
+		}
+		else if (m_Corners[triangle * 3 + (corner + 2) % 3] == end) {
+			found = triangle * 3 + (corner + 2) % 3;
+		}
+		return found != -1;
+	});
+	return found;
+}
+
+void plg::Triangulator::LockSide(int32_t side, uint8_t regions) {
+	// A side given twice toggles its regions back off but stays a segment.
+	m_Locked[side] = (m_Locked[side] ^ regions) | s_SegmentFlag;
+	if (m_Twins[side] != -1) {
+		m_Locked[m_Twins[side]] = m_Locked[side];
+	}
+}
+
+bool plg::Triangulator::InsertSegment(int32_t start, int32_t end, uint8_t regions) {
+	const Vec2* points = m_Points;
+	while (start != end) {
+		int32_t existing = FindSide(start, end);
+		if (existing != -1) {
+			LockSide(existing, regions);
+			return true;
+		}
+		// Walks across the triangles the segment passes through, recording each crossed
+		// side as right point then left point, and stops early at a point lying on it.
+		Vec2 from = points[start], to = points[end];
+		int32_t stop = end, side = -1;
+		VisitFan(start, [&](int32_t triangle, int32_t corner) {
+			int32_t right = m_Corners[triangle * 3 + (corner + 1) % 3], left = m_Corners[triangle * 3 + (corner + 2) % 3];
+			double orientRight = s_Orient(from, to, points[right]), orientLeft = s_Orient(from, to, points[left]);
+			if (orientRight == 0.0 && s_Ahead(from, to, points[right]) > 0.0) {
+				stop = right;
+				return true;
+			}
+			if (orientLeft == 0.0 && s_Ahead(from, to, points[left]) > 0.0) {
+				stop = left;
+				return true;
+			}
+			if (orientRight < 0.0 && orientLeft > 0.0) {
+				side = triangle * 3 + (corner + 1) % 3;
+				return true;
+			}
+			return false;
+		});
+		if (side == -1) {
+			if (stop == end) {
+				m_SkippedSegments++;
+				return false;
+			}
+			LockSide(FindSide(start, stop), regions);
+			start = stop;
+			continue;
+		}
+		m_Crossings.clear();
+		for (;;) {
+			int32_t twin = m_Twins[side];
+			if (m_Locked[side] || twin == -1) {
+				m_SkippedSegments++;
+				return false;
+			}
+			m_Crossings.push_back(m_Corners[side]);
+			m_Crossings.push_back(m_Corners[side - side % 3 + (side % 3 + 1) % 3]);
+			int32_t triangle = twin / 3, corner = twin % 3;
+			int32_t opposite = m_Corners[triangle * 3 + (corner + 2) % 3];
+			if (opposite == end) {
+				break;
+			}
+			double orient = s_Orient(from, to, points[opposite]);
+			if (orient == 0.0) {
+				stop = opposite;
+				break;
+			}
+			side = triangle * 3 + ((orient < 0.0) ? (corner + 2) % 3 : (corner + 1) % 3);
+		}
+		if (!ForceSegment(start, stop, regions)) {
+			m_SkippedSegments++;
+			return false;
+		}
+		start = stop;
+	}
+	return true;
+}
+
+bool plg::Triangulator::ForceSegment(int32_t start, int32_t end, uint8_t regions) {
+	const Vec2* points = m_Points;
+	Vec2 from = points[start], to = points[end];
+	// Flips crossed edges whose quad is convex until none cross, queueing the rest again.
+	m_NewEdges.clear();
+	size_t crossingCount = m_Crossings.size() / 2;
+	size_t budget = crossingCount * crossingCount * 8 + 64;
+	for (size_t head = 0; head < m_Crossings.size(); head += 2) {
+		if (budget-- == 0) {
+			return false;
+		}
+		int32_t side = FindSide(m_Crossings[head], m_Crossings[head + 1]);
+		if (side == -1) {
+			continue;
+		}
+		int32_t triangle = side / 3, corner = side % 3, twin = m_Twins[side];
+		int32_t vertA = m_Corners[side], vertB = m_Corners[triangle * 3 + (corner + 1) % 3], vertC = m_Corners[triangle * 3 + (corner + 2) % 3];
+		int32_t vertD = m_Corners[(twin / 3) * 3 + (twin % 3 + 2) % 3];
+		if (s_Orient(points[vertC], points[vertA], points[vertD]) <= 0.0 || s_Orient(points[vertD], points[vertB], points[vertC]) <= 0.0) {
+			m_Crossings.push_back(vertA);
+			m_Crossings.push_back(vertB);
+			continue;
+		}
+		Flip(side);
+		bool crosses = vertC != start && vertC != end && vertD != start && vertD != end &&
+			s_Orient(from, to, points[vertC]) * s_Orient(from, to, points[vertD]) < 0.0 &&
+			s_Orient(points[vertC], points[vertD], from) * s_Orient(points[vertC], points[vertD], to) < 0.0;
+		// A diagonal that still crosses goes round again; the rest are re-checked at the end.
+		std::vector<int32_t>& queue = crosses ? m_Crossings : m_NewEdges;
+		queue.push_back(vertC);
+		queue.push_back(vertD);
+	}
+	int32_t segment = FindSide(start, end);
+	if (segment == -1) {
+		return false;
+	}
+	LockSide(segment, regions);
+	// Restores the Delaunay property around the new edges, leaving locked sides alone.
+	for (size_t edge = 0; edge < m_NewEdges.size(); edge += 2) {
+		int32_t side = FindSide(m_NewEdges[edge], m_NewEdges[edge + 1]);
+		if (side != -1) {
+			m_Stack.push_back(side);
+		}
+	}
+	Legalize();
+	return true;
+}
\ No newline at end of file
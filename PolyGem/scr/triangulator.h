@@ -0,0 +1,84 @@
+#pragma once
+#include "core_scene.h"
+#include <span>
+#include <vector>
+
+namespace plg {
+	// Constrained Delaunay triangulation. Points are swept outwards from the circumcentre of
+	// a seed triangle, ties going round by angle, so each one lies outside the hull built so
+	// far; it is joined to the hull sides it can see, found through a hash on the angle and
+	// a walk both ways along the hull, and legalised with flips. The sweep is O(n log n) for
+	// the sort and close to linear after it, points on one circle included. Segments are
+	// forced in afterwards by flipping away the edges they cross.
+	// Scratch buffers are kept between calls, so a shape retriangulated every frame does
+	// not allocate once the buffers have grown to fit it.
+	class Triangulator {
+	public:
+		// Triangulates the convex hull of the points with every segment as an edge and
+		// returns the number of triangles. Segments index into points.
+		size_t Triangulate(std::span<const Vec2> points, std::span<const Edge> segments = {});
+		// Fills closed outlines stored back to back in points; contourEnds[i] is one past
+		// the last point of contour i, and no ends means one contour. Contours inside
+		// other contours cut holes by the even-odd rule.
+		size_t TriangulatePolygon(std::span<const Vec2> points, std::span<const uint32_t> contourEnds = {});
+		// Like Triangulate, but each segment also carries a set of region bits, one bit per
+		// outline, and every triangle gets the bits it lies inside by the even-odd rule.
+		// Triangles outside every outline are kept with no bits set. Up to seven regions.
+		size_t TriangulateRegions(std::span<const Vec2> points, std::span<const Edge> segments, std::span<const uint8_t> segmentRegions);
+
+		// Three point indices per triangle, wound the same way as mesh faces.
+		std::span<const uint32_t> GetTriangles() const { return m_Output; }
+		size_t GetTriangleCount() const { return m_Output.size() / 3; }
+		// Region bits of each triangle after TriangulateRegions.
+		std::span<const uint8_t> GetTriangleRegions() const { return m_Regions; }
+		// Segments that were left out because they cross a segment already in place.
+		size_t GetSkippedSegmentCount() const { return m_SkippedSegments; }
+
+	private:
+		struct TriangleSides {
+			int32_t vertex[3];
+			int32_t twin[3];
+			uint8_t locked[3];
+		};
+
+		void Sweep(std::span<const Vec2> points);
+		int32_t AddTriangle(int32_t vert1, int32_t vert2, int32_t vert3);
+		void SetSide(int32_t triangle, int32_t corner, int32_t twin, uint8_t locked);
+		TriangleSides ReadTriangle(int32_t triangle, int32_t side) const;
+		size_t HashKey(const Vec2& point) const;
+		void InsertOutside(int32_t vertex);
+		void Flip(int32_t side);
+		// Flips stacked sides until they are locally Delaunay. fromApex is for sides pushed
+		// opposite a newly added point, where only the two far sides of a flip can go bad.
+		void Legalize(bool fromApex = false);
+		int32_t FindSide(int32_t start, int32_t end) const;
+		bool InsertSegment(int32_t start, int32_t end, uint8_t regions);
+		bool ForceSegment(int32_t start, int32_t end, uint8_t regions);
+		void LockSide(int32_t side, uint8_t regions);
+		void FloodRegions();
+		template<typename T_func>
+		bool VisitFan(int32_t vertex, T_func&& func) const;
+
+		const Vec2* m_Points = nullptr;
+		std::vector<uint32_t> m_Order;
+		std::vector<int32_t> m_Remap;
+		std::vector<int32_t> m_Corners;
+		std::vector<int32_t> m_Twins;
+		std::vector<uint8_t> m_Locked;
+		std::vector<double> m_Distances;
+		std::vector<int32_t> m_PointTriangles;
+		// The hull as a ring of points, each with the side leaving it; -1 once inside.
+		std::vector<int32_t> m_HullNext;
+		std::vector<int32_t> m_HullPrevious;
+		std::vector<int32_t> m_HullSides;
+		std::vector<int32_t> m_HullHash;
+		std::vector<int32_t> m_Stack;
+		std::vector<int32_t> m_Crossings;
+		std::vector<int32_t> m_NewEdges;
+		std::vector<int32_t> m_Depth;
+		std::vector<uint32_t> m_Output;
+		std::vector<uint8_t> m_Regions;
+		Vec2 m_Center;
+		size_t m_SkippedSegments = 0;
+	};
+}
\ No newline at end of file
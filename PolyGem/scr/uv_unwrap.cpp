@@ -0,0 +1,506 @@
+#include "uv_unwrap.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cmath>
+
+// Cotangent weights turn negative across obtuse corners; they are kept above this so the
+// system stays positive definite.
+static constexpr double s_MinWeight = 1e-3;
+// Pin responses cost a vector of the free vertex count each, so only this many are kept.
+static constexpr size_t s_MaxResponses = 32;
+
+static double s_Dot(std::span<const double> first, std::span<const double> second) {
+	double sum = 0.0;
+	for (size_t index = 0; index < first.size(); index++) {
+		sum += first[index] * second[index];
+	}
+	return sum;
+}
+
+void plg::SparseMatrix::Build(size_t rowCount, std::vector<Entry>& entries) {
+	std::sort(entries.begin(), entries.end(), [](const Entry& first, const Entry& second) {
+		return (first.row != second.row) ? first.row < second.row : first.column < second.column;
+	});
+	m_RowStart.assign(rowCount + 1, 0);
+	m_Columns.clear();
+	m_Columns.reserve(entries.size());
+	m_Values.clear();
+	m_Values.reserve(entries.size());
+	m_Diagonal.assign(rowCount, 0.0);
+	for (size_t index = 0; index < entries.size(); index++) {
+		const Entry& entry = entries[index];
+		if (index > 0 && entries[index - 1].row == entry.row && entries[index - 1].column == entry.column) {
+			m_Values.back() += entry.value;
+		}
+		else {
+			m_Columns.push_back(entry.column);
+			m_Values.push_back(entry.value);
+			m_RowStart[entry.row + 1]++;
+		}
+		if (entry.row == entry.column) {
+			m_Diagonal[entry.row] += entry.value;
+		}
+	}
+	for (size_t row = 0; row < rowCount; row++) {
+		m_RowStart[row + 1] += m_RowStart[row];
+	}
+}
+
+void plg::SparseMatrix::Multiply(std::span<const double> x, std::span<double> result) const {
+	for (size_t row = 0; row < m_Diagonal.size(); row++) {
+		double sum = 0.0;
+		for (int32_t entry = m_RowStart[row]; entry < m_RowStart[row + 1]; entry++) {
+			sum += m_Values[entry] * x[m_Columns[entry]];
+		}
+		result[row] = sum;
+	}
+}
+
+size_t plg::ConjugateGradient::Solve(const SparseMatrix& matrix, std::span<const double> b, std::span<double> x, double tolerance, size_t maxIterations) {
+	size_t size = matrix.GetRowCount();
+	m_R.resize(size);
+	m_Z.resize(size);
+	m_P.resize(size);
+	m_AP.resize(size);
+	m_InverseDiagonal.resize(size);
+	std::span<const double> diagonal = matrix.GetDiagonal();
+	for (size_t row = 0; row < size; row++) {
+		m_InverseDiagonal[row] = (diagonal[row] != 0.0) ? 1.0 / diagonal[row] : 1.0;
+	}
+	double bNorm = sqrt(s_Dot(b, b));
+	if (bNorm == 0.0) {
+		std::fill(x.begin(), x.end(), 0.0);
+		m_Residual = 0.0;
+		return 0;
+	}
+	matrix.Multiply(x, m_AP);
+	for (size_t row = 0; row < size; row++) {
+		m_R[row] = b[row] - m_AP[row];
+		m_Z[row] = m_R[row] * m_InverseDiagonal[row];
+	}
+	m_P = m_Z;
+	double rz = s_Dot(m_R, m_Z);
+	double limit = tolerance * bNorm;
+	size_t iteration = 0;
+	for (; iteration < maxIterations; iteration++) {
+		if (sqrt(s_Dot(m_R, m_R)) <= limit) {
+			break;
+		}
+		matrix.Multiply(m_P, m_AP);
+		double curvature = s_Dot(m_P, m_AP);
+		if (curvature <= 0.0) {
+			break;
+		}
+		double alpha = rz / curvature;
+		for (size_t row = 0; row < size; row++) {
+			x[row] += alpha * m_P[row];
+			m_R[row] -= alpha * m_AP[row];
+			m_Z[row] = m_R[row] * m_InverseDiagonal[row];
+		}
+		double nextRz = s_Dot(m_R, m_Z);
+		double beta = nextRz / rz;
+		rz = nextRz;
+		for (size_t row = 0; row < size; row++) {
+			m_P[row] = m_Z[row] + beta * m_P[row];
+		}
+	}
+	m_Residual = sqrt(s_Dot(m_R, m_R)) / bNorm;
+	return iteration;
+}
+
+plg::UVUnwrapper::UVUnwrapper() {
+	m_Worker = std::thread([this]() { WorkerLoop(); });
+}
+
+plg::UVUnwrapper::~UVUnwrapper() {
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stop = true;
+	}
+	m_Wake.notify_all();
+	m_Worker.join();
+}
+
+void plg::UVUnwrapper::SetMesh(Mesh& mesh) {
+	size_t capacity = mesh.GetVertexList()->GetCapacity();
+	m_Positions.assign(capacity, Vec2());
+	m_Used.assign(capacity, 0);
+	for (auto vertex_it = mesh.GetVertexIter(); vertex_it < vertex_it.end_ptr; vertex_it++) {
+		m_Positions[vertex_it.GetIndex()] = *vertex_it;
+		m_Used[vertex_it.GetIndex()] = 1;
+	}
+	auto valid = [&](int32_t vertex) { return vertex >= 0 && (size_t)vertex < capacity && m_Used[vertex]; };
+	m_Faces.clear();
+	m_Faces.reserve(mesh.GetFaceList()->GetSize());
+	for (auto face_it = mesh.GetFaceIter(); face_it < face_it.end_ptr; face_it++) {
+		if (valid(face_it->m_Vert1) && valid(face_it->m_Vert2) && valid(face_it->m_Vert3)) {
+			m_Faces.push_back(*face_it);
+		}
+	}
+	m_Pins.clear();
+	m_MeshChanged = true;
+}
+
+void plg::UVUnwrapper::SetPin(int32_t vertex, Vec2 uv) {
+	for (UVPin& pin : m_Pins) {
+		if (pin.vertex == vertex) {
+			pin.uv = uv;
+			return;
+		}
+	}
+	m_Pins.push_back({ vertex, uv });
+}
+
+void plg::UVUnwrapper::RemovePin(int32_t vertex) {
+	m_Pins.erase(std::remove_if(m_Pins.begin(), m_Pins.end(), [vertex](const UVPin& pin) { return pin.vertex == vertex; }), m_Pins.end());
+}
+
+void plg::UVUnwrapper::Submit() {
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if (m_MeshChanged) {
+			m_Pending.positions.swap(m_Positions);
+			m_Pending.used.swap(m_Used);
+			m_Pending.faces.swap(m_Faces);
+			m_Pending.hasMesh = true;
+			m_MeshChanged = false;
+		}
+		m_Pending.pins = m_Pins;
+		m_Pending.revision = ++m_Revision;
+		m_HasPending = true;
+		m_Busy.store(true, std::memory_order_release);
+	}
+	m_Wake.notify_one();
+}
+
+bool plg::UVUnwrapper::FetchResult(std::vector<Vec2>& uvs) {
+	// The worker only holds the lock to swap buffers, but the frame still never waits on it.
+	std::unique_lock<std::mutex> lock(m_Mutex, std::try_to_lock);
+	if (!lock.owns_lock() || m_PublishedRevision == m_FetchedRevision) {
+		return false;
+	}
+	uvs.swap(m_Published);
+	m_FetchedRevision = m_PublishedRevision;
+	return true;
+}
+
+bool plg::UVUnwrapper::FetchResult(Mesh& mesh) {
+	if (!FetchResult(m_Fetched) || m_Fetched.size() != mesh.GetVertexList()->GetCapacity()) {
+		return false;
+	}
+	mesh.SetUVs(m_Fetched);
+	return true;
+}
+
+void plg::UVUnwrapper::Wait() {
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_Idle.wait(lock, [this]() { return !m_HasPending && !m_Busy.load(std::memory_order_acquire); });
+}
+
+void plg::UVUnwrapper::WorkerLoop() {
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	while (true) {
+		m_Wake.wait(lock, [this]() { return m_Stop || m_HasPending; });
+		if (m_Stop) {
+			return;
+		}
+		std::swap(m_Active, m_Pending);
+		m_Pending.hasMesh = false;
+		m_HasPending = false;
+		lock.unlock();
+
+		if (m_Active.hasMesh) {
+			LoadMesh(m_Active);
+		}
+		Solve(m_Active.pins);
+		m_Output.assign(m_Solution.begin(), m_Solution.end());
+
+		lock.lock();
+		m_Published.swap(m_Output);
+		m_PublishedRevision = m_Active.revision;
+		if (!m_HasPending) {
+			m_Busy.store(false, std::memory_order_release);
+			m_Idle.notify_all();
+		}
+	}
+}
+
+void plg::UVUnwrapper::LoadMesh(Request& request) {
+	size_t capacity = request.positions.size();
+	Vec2 low(INFINITY, INFINITY), high(-INFINITY, -INFINITY);
+	for (size_t vertex = 0; vertex < capacity; vertex++) {
+		if (request.used[vertex]) {
+			low = Vec2(std::min(low.x, request.positions[vertex].x), std::min(low.y, request.positions[vertex].y));
+			high = Vec2(std::max(high.x, request.positions[vertex].x), std::max(high.y, request.positions[vertex].y));
+		}
+	}
+	// The layout the solve keeps to is the mesh scaled into the unit square.
+	float extent = std::max(high.x - low.x, high.y - low.y);
+	float scale = (extent > 0.0f) ? 1.0f / extent : 1.0f;
+	m_Layout.assign(capacity, Vec2());
+	for (size_t vertex = 0; vertex < capacity; vertex++) {
+		if (request.used[vertex]) {
+			m_Layout[vertex] = Vec2((request.positions[vertex].x - low.x) * scale, (request.positions[vertex].y - low.y) * scale);
+		}
+	}
+	m_LayoutFaces.swap(request.faces);
+	m_InFace.assign(capacity, 0);
+	m_Parents.resize(capacity);
+	for (size_t vertex = 0; vertex < capacity; vertex++) {
+		m_Parents[vertex] = (int32_t)vertex;
+	}
+
+	// Half the cotangent of the corner across from each side, summed over both faces of an edge.
+	m_EdgeWeights.clear();
+	m_EdgeWeights.reserve(m_LayoutFaces.size() * 3);
+	for (const Face& face : m_LayoutFaces) {
+		int32_t corners[3] = { face.m_Vert1, face.m_Vert2, face.m_Vert3 };
+		const Vec2& first = m_Layout[corners[0]];
+		const Vec2& second = m_Layout[corners[1]];
+		const Vec2& third = m_Layout[corners[2]];
+		double area = fabs((double)(second.x - first.x) * (third.y - first.y) - (double)(second.y - first.y) * (third.x - first.x));
+		if (area == 0.0) {
+			continue;
+		}
+		for (int32_t corner = 0; corner < 3; corner++) {
+			int32_t apex = corners[corner], start = corners[(corner + 1) % 3], end = corners[(corner + 2) % 3];
+			double ux = m_Layout[start].x - m_Layout[apex].x, uy = m_Layout[start].y - m_Layout[apex].y;
+			double vx = m_Layout[end].x - m_Layout[apex].x, vy = m_Layout[end].y - m_Layout[apex].y;
+			m_EdgeWeights.push_back({ std::min(start, end), std::max(start, end), 0.5 * (ux * vx + uy * vy) / area });
+			m_InFace[apex] = 1;
+			int32_t apexRoot = FindRoot(apex), startRoot = FindRoot(start);
+			m_Parents[std::max(apexRoot, startRoot)] = std::min(apexRoot, startRoot);
+		}
+	}
+	std::sort(m_EdgeWeights.begin(), m_EdgeWeights.end(), [](const SparseMatrix::Entry& first, const SparseMatrix::Entry& second) {
+		return (first.row != second.row) ? first.row < second.row : first.column < second.column;
+	});
+	size_t kept = 0;
+	for (size_t index = 0; index < m_EdgeWeights.size(); index++) {
+		if (kept > 0 && m_EdgeWeights[kept - 1].row == m_EdgeWeights[index].row && m_EdgeWeights[kept - 1].column == m_EdgeWeights[index].column) {
+			m_EdgeWeights[kept - 1].value += m_EdgeWeights[index].value;
+		}
+		else {
+			m_EdgeWeights[kept++] = m_EdgeWeights[index];
+		}
+	}
+	m_EdgeWeights.resize(kept);
+	for (SparseMatrix::Entry& edge : m_EdgeWeights) {
+		edge.value = std::max(edge.value, s_MinWeight);
+	}
+	m_Solution = m_Layout;
+	m_PinUVs.assign(capacity, Vec2());
+	m_SystemPins.clear();
+	m_SystemDirty = true;
+}
+
+void plg::UVUnwrapper::Solve(std::vector<UVPin>& pins) {
+	size_t capacity = m_Layout.size();
+	pins.erase(std::remove_if(pins.begin(), pins.end(), [&](const UVPin& pin) {
+		return pin.vertex < 0 || (size_t)pin.vertex >= capacity || !m_InFace[pin.vertex];
+	}), pins.end());
+	// Every piece of the mesh needs a pin to sit still; those without one keep their first
+	// vertex where the layout puts it.
+	m_RootPinned.assign(capacity, 0);
+	for (const UVPin& pin : pins) {
+		m_RootPinned[FindRoot(pin.vertex)] = 1;
+	}
+	for (size_t vertex = 0; vertex < capacity; vertex++) {
+		if (m_InFace[vertex] && FindRoot((int32_t)vertex) == (int32_t)vertex && !m_RootPinned[vertex]) {
+			pins.push_back({ (int32_t)vertex, m_Layout[vertex] });
+		}
+	}
+	std::sort(pins.begin(), pins.end(), [](const UVPin& first, const UVPin& second) { return first.vertex < second.vertex; });
+	bool samePins = !m_SystemDirty && pins.size() == m_SystemPins.size();
+	for (size_t index = 0; samePins && index < pins.size(); index++) {
+		samePins = pins[index].vertex == m_SystemPins[index];
+	}
+	if (!samePins) {
+		m_SystemPins.clear();
+		for (const UVPin& pin : pins) {
+			m_SystemPins.push_back(pin.vertex);
+		}
+		BuildSystem();
+	}
+	for (const UVPin& pin : pins) {
+		m_PinUVs[pin.vertex] = pin.uv;
+	}
+
+	// Each free vertex is pulled toward its neighbours by the offsets the layout has to
+	// them; pinned neighbours move to the known side.
+	size_t rowCount = m_RowVertices.size();
+	for (int32_t axis = 0; axis < 2; axis++) {
+		m_B[axis].assign(rowCount, 0.0);
+	}
+	for (const SparseMatrix::Entry& edge : m_EdgeWeights) {
+		int32_t start = edge.row, end = edge.column;
+		int32_t startRow = m_Rows[start], endRow = m_Rows[end];
+		double dx = edge.value * (m_Layout[start].x - m_Layout[end].x);
+		double dy = edge.value * (m_Layout[start].y - m_Layout[end].y);
+		if (startRow != -1) {
+			m_B[0][startRow] += dx + ((endRow == -1) ? edge.value * m_PinUVs[end].x : 0.0);
+			m_B[1][startRow] += dy + ((endRow == -1) ? edge.value * m_PinUVs[end].y : 0.0);
+		}
+		if (endRow != -1) {
+			m_B[0][endRow] += -dx + ((startRow == -1) ? edge.value * m_PinUVs[start].x : 0.0);
+			m_B[1][endRow] += -dy + ((startRow == -1) ? edge.value * m_PinUVs[start].y : 0.0);
+		}
+	}
+	// The system is linear, so the last solution moved by each pin's response is already
+	// the new one; the solve only has to clean up what the responses left.
+	if (m_SolvedPinUVs.size() == pins.size() && pins.size() <= s_MaxResponses) {
+		for (size_t pin = 0; pin < pins.size(); pin++) {
+			double moveX = (double)pins[pin].uv.x - m_SolvedPinUVs[pin].x;
+			double moveY = (double)pins[pin].uv.y - m_SolvedPinUVs[pin].y;
+			if (moveX == 0.0 && moveY == 0.0) {
+				continue;
+			}
+			if (m_Responses[pin].empty()) {
+				SolveResponse(pin);
+			}
+			const std::vector<double>& response = m_Responses[pin];
+			for (size_t row = 0; row < rowCount; row++) {
+				m_X[0][row] += moveX * response[row];
+				m_X[1][row] += moveY * response[row];
+			}
+		}
+	}
+	m_SolvedPinUVs.resize(pins.size());
+	for (size_t pin = 0; pin < pins.size(); pin++) {
+		m_SolvedPinUVs[pin] = pins[pin].uv;
+	}
+	size_t iterations[2] = { 0, 0 };
+	container::GetThreadPool().ParallelFor(2, 1, [&](size_t begin, size_t end) {
+		for (size_t axis = begin; axis < end; axis++) {
+			iterations[axis] = m_Solvers[axis].Solve(m_Matrix, m_B[axis], m_X[axis]);
+		}
+	});
+	for (size_t row = 0; row < rowCount; row++) {
+		m_Solution[m_RowVertices[row]] = Vec2((float)m_X[0][row], (float)m_X[1][row]);
+	}
+	for (const UVPin& pin : pins) {
+		m_Solution[pin.vertex] = pin.uv;
+	}
+	m_LastIterations.store(iterations[0] + iterations[1], std::memory_order_relaxed);
+}
+
+void plg::UVUnwrapper::BuildSystem() {
+	size_t capacity = m_Layout.size();
+	m_Rows.assign(capacity, -1);
+	m_RowVertices.clear();
+	size_t pin = 0;
+	for (size_t vertex = 0; vertex < capacity; vertex++) {
+		while (pin < m_SystemPins.size() && m_SystemPins[pin] < (int32_t)vertex) {
+			pin++;
+		}
+		if (m_InFace[vertex] && (pin == m_SystemPins.size() || m_SystemPins[pin] != (int32_t)vertex)) {
+			m_Rows[vertex] = (int32_t)m_RowVertices.size();
+			m_RowVertices.push_back((int32_t)vertex);
+		}
+	}
+	m_Entries.clear();
+	m_Entries.reserve(m_EdgeWeights.size() * 4);
+	for (const SparseMatrix::Entry& edge : m_EdgeWeights) {
+		int32_t startRow = m_Rows[edge.row], endRow = m_Rows[edge.column];
+		if (startRow != -1) {
+			m_Entries.push_back({ startRow, startRow, edge.value });
+		}
+		if (endRow != -1) {
+			m_Entries.push_back({ endRow, endRow, edge.value });
+		}
+		if (startRow != -1 && endRow != -1) {
+			m_Entries.push_back({ startRow, endRow, -edge.value });
+			m_Entries.push_back({ endRow, startRow, -edge.value });
+		}
+	}
+	m_Matrix.Build(m_RowVertices.size(), m_Entries);
+	for (int32_t axis = 0; axis < 2; axis++) {
+		m_X[axis].resize(m_RowVertices.size());
+	}
+	for (size_t row = 0; row < m_RowVertices.size(); row++) {
+		m_X[0][row] = m_Solution[m_RowVertices[row]].x;
+		m_X[1][row] = m_Solution[m_RowVertices[row]].y;
+	}
+	m_SolvedPinUVs.clear();
+	m_Responses.assign(m_SystemPins.size(), {});
+	m_SystemDirty = false;
+}
+
+void plg::UVUnwrapper::SolveResponse(size_t pin) {
+	// A unit move of the pin pulls each free neighbour by the weight of the edge to it.
+	int32_t vertex = m_SystemPins[pin];
+	m_ResponseB.assign(m_RowVertices.size(), 0.0);
+	for (const SparseMatrix::Entry& edge : m_EdgeWeights) {
+		if (edge.row == vertex && m_Rows[edge.column] != -1) {
+			m_ResponseB[m_Rows[edge.column]] += edge.value;
+		}
+		else if (edge.column == vertex && m_Rows[edge.row] != -1) {
+			m_ResponseB[m_Rows[edge.row]] += edge.value;
+		}
+	}
+	m_Responses[pin].assign(m_RowVertices.size(), 0.0);
+	m_Solvers[0].Solve(m_Matrix, m_ResponseB, m_Responses[pin]);
+}
+
+int32_t plg::UVUnwrapper::FindRoot(int32_t vertex) {
+	while (m_Parents[vertex] != vertex) {
+		m_Parents[vertex] = m_Parents[m_Parents[vertex]];
+		vertex = m_Parents[vertex];
+	}
+	return vertex;
+}
+
+void plg::BenchmarkUVUnwrap(size_t repeatCount) {
+	// A 150 x 150 grid with a wave through it, pinned at two corners, one of which is then
+	// dragged a little at a time.
+	const size_t side = 150;
+	std::vector<Vertex> vertices;
+	std::vector<Face> faces;
+	for (size_t row = 0; row < side; row++) {
+		for (size_t column = 0; column < side; column++) {
+			vertices.push_back(Vertex(4.0f * (float)column, 4.0f * (float)row + 8.0f * sinf(0.05f * (float)column)));
+		}
+	}
+	for (size_t row = 0; row + 1 < side; row++) {
+		for (size_t column = 0; column + 1 < side; column++) {
+			int32_t corner = (int32_t)(row * side + column);
+			faces.push_back(Face(corner, corner + 1, corner + (int32_t)side + 1));
+			faces.push_back(Face(corner, corner + (int32_t)side + 1, corner + (int32_t)side));
+		}
+	}
+	Mesh mesh(vertices, {}, faces, false);
+	int32_t dragged = (int32_t)(side * side - 1);
+	UVUnwrapper unwrapper;
+	double coldSeconds = 0.0, warmSeconds = 0.0;
+	size_t coldIterations = 0, warmIterations = 0;
+	for (size_t repeat = 0; repeat < repeatCount; repeat++) {
+		auto start = std::chrono::high_resolution_clock::now();
+		unwrapper.SetMesh(mesh);
+		unwrapper.SetPin(0, Vec2(0.0f, 0.0f));
+		unwrapper.SetPin(dragged, Vec2(1.1f, 1.0f));
+		unwrapper.Submit();
+		unwrapper.Wait();
+		coldSeconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+		coldIterations += unwrapper.GetLastIterations();
+	}
+	// The first step of the drag also solves the pin's response.
+	for (size_t repeat = 0; repeat < repeatCount; repeat++) {
+		auto start = std::chrono::high_resolution_clock::now();
+		unwrapper.SetPin(dragged, Vec2(1.1f + 0.01f * (float)(repeat + 1), 1.0f - 0.005f * (float)(repeat + 1)));
+		unwrapper.Submit();
+		unwrapper.Wait();
+		warmSeconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+		warmIterations += unwrapper.GetLastIterations();
+	}
+	Log("UV unwrap of ");
+	Log(mesh.GetVertexList()->GetSize());
+	Log(" vertices: cold ");
+	Log(coldSeconds * 1000.0 / (double)repeatCount);
+	Log(" ms in ");
+	Log(coldIterations / repeatCount);
+	Log(" iterations, pin drag ");
+	Log(warmSeconds * 1000.0 / (double)repeatCount);
+	Log(" ms in ");
+	Log(warmIterations / repeatCount);
+	Log(" iterations", true);
+}
\ No newline at end of file
@@ -0,0 +1,174 @@
+#pragma once
+#include "core_scene.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace plg {
+	// Square sparse matrix in compressed rows: the entries of row r are the columns and
+	// values from m_RowStart[r] up to m_RowStart[r + 1], sorted by column.
+	class SparseMatrix {
+	public:
+		struct Entry {
+			int32_t row;
+			int32_t column;
+			double value;
+		};
+
+		SparseMatrix() { }
+
+		// Entries landing on the same cell are summed. The entries are sorted in place.
+		void Build(size_t rowCount, std::vector<Entry>& entries);
+		void Multiply(std::span<const double> x, std::span<double> result) const;
+
+		size_t GetRowCount() const { return m_Diagonal.size(); }
+		size_t GetNonZeroCount() const { return m_Values.size(); }
+		std::span<const double> GetDiagonal() const { return m_Diagonal; }
+
+	private:
+		std::vector<int32_t> m_RowStart;
+		std::vector<int32_t> m_Columns;
+		std::vector<double> m_Values;
+		std::vector<double> m_Diagonal;
+	};
+
+	// Jacobi preconditioned conjugate gradient for symmetric positive definite systems. The
+	// solve starts from whatever x holds, so a solution close to the last one takes only
+	// the few iterations needed to cover the difference.
+	class ConjugateGradient {
+	public:
+		ConjugateGradient() { }
+
+		// Stops once the residual is under tolerance times the norm of b and returns the
+		// number of iterations taken.
+		size_t Solve(const SparseMatrix& matrix, std::span<const double> b, std::span<double> x, double tolerance = 1e-6, size_t maxIterations = 2000);
+		// Residual norm over the norm of b after the last solve.
+		double GetResidual() const { return m_Residual; }
+
+	private:
+		std::vector<double> m_R;
+		std::vector<double> m_Z;
+		std::vector<double> m_P;
+		std::vector<double> m_AP;
+		std::vector<double> m_InverseDiagonal;
+		double m_Residual = 0.0;
+	};
+
+	struct UVPin {
+		int32_t vertex;
+		Vec2 uv;
+	};
+
+	// Texture coordinates for a mesh, solved on a worker thread. Every free vertex sits at
+	// the cotangent weighted mean of its neighbours shifted by how the mesh lays them out,
+	// so with a single pin the result is the mesh scaled into the unit square, and moving
+	// pins bends the layout smoothly around them. A component with no pin is held by its
+	// first vertex. The matrix is only rebuilt when the mesh or the set of pinned vertices
+	// changes; moving pins only changes the right-hand side. The solve starts from the last
+	// solution plus, for every pin that moved, its move times the layout's response to that
+	// pin, solved once the first time the pin moves, so dragging a pin re-solves in a few
+	// iterations. Requests replace any the worker has not started, and finished layouts are
+	// picked up without waiting on a solve in progress.
+	class UVUnwrapper {
+	public:
+		UVUnwrapper();
+		UVUnwrapper(const UVUnwrapper&) = delete;
+		UVUnwrapper& operator=(const UVUnwrapper&) = delete;
+		~UVUnwrapper();
+
+		// Copies the mesh's vertices and faces for the next request and drops the pins.
+		void SetMesh(Mesh& mesh);
+		void SetPin(int32_t vertex, Vec2 uv);
+		void RemovePin(int32_t vertex);
+		void ClearPins() { m_Pins.clear(); }
+		std::span<const UVPin> GetPins() const { return m_Pins; }
+		// Hands the mesh, when it changed, and the pins to the worker.
+		void Submit();
+		// Moves the newest finished layout into uvs, one per vertex slot, and returns true.
+		// Returns false when there is nothing new or the worker is publishing right now.
+		bool FetchResult(std::vector<Vec2>& uvs);
+		// Same, handing the layout to the mesh when it still has the slots it was solved for.
+		bool FetchResult(Mesh& mesh);
+		// Blocks until every submitted request is solved.
+		void Wait();
+
+		bool IsBusy() const { return m_Busy.load(std::memory_order_acquire); }
+		// Iterations the last solve took, summed over both coordinates.
+		size_t GetLastIterations() const { return m_LastIterations.load(std::memory_order_relaxed); }
+
+	private:
+		struct Request {
+			std::vector<Vec2> positions;
+			std::vector<uint8_t> used;
+			std::vector<Face> faces;
+			std::vector<UVPin> pins;
+			uint32_t revision = 0;
+			bool hasMesh = false;
+		};
+
+		void WorkerLoop();
+		// Worker side; everything below m_Active is only touched by the worker.
+		void LoadMesh(Request& request);
+		void Solve(std::vector<UVPin>& pins);
+		void BuildSystem();
+		void SolveResponse(size_t pin);
+		int32_t FindRoot(int32_t vertex);
+
+		// Built by the caller between submits.
+		std::vector<UVPin> m_Pins;
+		std::vector<Vec2> m_Positions;
+		std::vector<uint8_t> m_Used;
+		std::vector<Face> m_Faces;
+		bool m_MeshChanged = false;
+		uint32_t m_Revision = 0;
+		uint32_t m_FetchedRevision = 0;
+		std::vector<Vec2> m_Fetched;
+
+		// Shared with the worker under the mutex.
+		std::mutex m_Mutex;
+		std::condition_variable m_Wake;
+		std::condition_variable m_Idle;
+		Request m_Pending;
+		bool m_HasPending = false;
+		bool m_Stop = false;
+		std::vector<Vec2> m_Published;
+		uint32_t m_PublishedRevision = 0;
+		std::atomic<bool> m_Busy = false;
+		std::atomic<size_t> m_LastIterations = 0;
+
+		Request m_Active;
+		std::vector<Vec2> m_Layout;
+		std::vector<uint8_t> m_InFace;
+		std::vector<Face> m_LayoutFaces;
+		// Cotangent weight of every edge between face vertices, start below end.
+		std::vector<SparseMatrix::Entry> m_EdgeWeights;
+		std::vector<int32_t> m_Parents;
+		std::vector<int32_t> m_SystemPins;
+		// Row of each free vertex, -1 for pinned vertices and those outside the faces.
+		std::vector<int32_t> m_Rows;
+		std::vector<int32_t> m_RowVertices;
+		std::vector<SparseMatrix::Entry> m_Entries;
+		SparseMatrix m_Matrix;
+		ConjugateGradient m_Solvers[2];
+		std::vector<double> m_B[2];
+		std::vector<double> m_X[2];
+		std::vector<Vec2> m_Solution;
+		std::vector<Vec2> m_PinUVs;
+		// Per system pin, the uv it was last solved with and how the free vertices follow
+		// a unit move of it, empty until it first moves.
+		std::vector<Vec2> m_SolvedPinUVs;
+		std::vector<std::vector<double>> m_Responses;
+		std::vector<double> m_ResponseB;
+		std::vector<uint8_t> m_RootPinned;
+		std::vector<Vec2> m_Output;
+		bool m_SystemDirty = true;
+		std::thread m_Worker;
+	};
+
+	// Logs the time and iterations of a cold unwrap of a grid and of re-solving it from
+	// the last layout after a pin moved.
+	void BenchmarkUVUnwrap(size_t repeatCount = 10);
+}
\ No newline at end of file